@@ -4,33 +4,40 @@
 
 namespace WSICS::BLOB_Operations
 {
-	BLOB::BLOB(void)
+	BLOB::BLOB(void) : m_offset_(0), m_size_(0)
 	{
 	}
 
-	BLOB::BLOB(const cv::Point2f& top_left, const cv::Point2f& bottom_right) : m_top_left_(top_left), m_bottom_right_(bottom_right)
+	BLOB::BLOB(const cv::Point2f& top_left, const cv::Point2f& bottom_right) : m_top_left_(top_left), m_bottom_right_(bottom_right), m_offset_(0), m_size_(0)
 	{
 	}
 
-	BLOB::BLOB(const std::vector<cv::Point2f>& blob_points) : m_points_(blob_points)
+	BLOB::BLOB(const std::vector<cv::Point2f>& blob_points)
+		: m_point_buffer_(std::make_shared<std::vector<cv::Point2f>>(blob_points)), m_offset_(0), m_size_(blob_points.size())
 	{
 	}
 
 	BLOB::BLOB(const std::vector<cv::Point2f>& blob_points, const cv::Point2f& top_left, const cv::Point2f& bottom_right) 
-		: m_points_(blob_points), m_top_left_(top_left), m_bottom_right_(bottom_right)
+		: m_top_left_(top_left), m_bottom_right_(bottom_right), m_point_buffer_(std::make_shared<std::vector<cv::Point2f>>(blob_points)), m_offset_(0), m_size_(blob_points.size())
 	{
 	}
 
 	BLOB::BLOB(std::vector<cv::Point2f>&& blob_points, const cv::Point2f& top_left, const cv::Point2f& bottom_right)
-		: m_points_(std::move(blob_points)), m_top_left_(top_left), m_bottom_right_(bottom_right)
+		: m_top_left_(top_left), m_bottom_right_(bottom_right), m_offset_(0), m_size_(blob_points.size())
+	{
+		m_point_buffer_ = std::make_shared<std::vector<cv::Point2f>>(std::move(blob_points));
+	}
+
+	BLOB::BLOB(const std::shared_ptr<std::vector<cv::Point2f>>& point_buffer, const size_t offset, const size_t size, const cv::Point2f& top_left, const cv::Point2f& bottom_right)
+		: m_top_left_(top_left), m_bottom_right_(bottom_right), m_point_buffer_(point_buffer), m_offset_(offset), m_size_(size)
 	{
 	}
 
     bool BLOB::Add(const cv::Point2f& point)
     {
-		// Checks whether or not this point already exists within the vector.
+		// Checks whether or not this point already exists within the BLOB.
 		size_t occurances = 0;
-		for (const cv::Point2f& inserted_point : m_points_)
+		for (const cv::Point2f& inserted_point : GetPoints())
 		{
 			occurances += point == inserted_point;
 		}
@@ -39,7 +46,7 @@ namespace WSICS::BLOB_Operations
 			return false;
 		}
 
-		if (m_points_.empty())
+		if (m_size_ == 0)
 		{
 			m_top_left_		= point;
 			m_bottom_right_ = point;
@@ -52,14 +59,14 @@ namespace WSICS::BLOB_Operations
 			m_bottom_right_.y	= std::max<float>(m_bottom_right_.y, point.y);
 		}
 
-        m_points_.push_back(point);
+		UnsafeAdd(point);
 		return true;
     }
 
 	bool BLOB::Add(const std::vector<cv::Point2f>& points)
 	{
 		bool inserted_all = true;
-		m_points_.reserve(m_points_.size() + points.size());
+		PrepareForInsertion_(points.size());
 		for (const cv::Point2f& point : points)
 		{
 			if (!Add(point))
@@ -73,21 +80,25 @@ namespace WSICS::BLOB_Operations
 
 	void BLOB::UnsafeAdd(const cv::Point2f& point)
 	{
-		m_points_.push_back(point);
+		PrepareForInsertion_(1);
+		m_point_buffer_->push_back(point);
+		++m_size_;
 	}
 	void BLOB::UnsafeAdd(const std::vector<cv::Point2f>& points)
 	{
-		m_points_.insert(m_points_.end(), points.begin(), points.end());
+		PrepareForInsertion_(points.size());
+		m_point_buffer_->insert(m_point_buffer_->end(), points.begin(), points.end());
+		m_size_ += points.size();
 	}
 
-	std::vector<cv::Point2f>& BLOB::GetPoints(void)
+	PointSpan<cv::Point2f> BLOB::GetPoints(void)
 	{
-		return m_points_;
+		return PointSpan<cv::Point2f>(m_point_buffer_ ? m_point_buffer_->data() + m_offset_ : nullptr, m_size_);
 	}
 
-	const std::vector<cv::Point2f>& BLOB::GetPoints(void) const
+	PointSpan<const cv::Point2f> BLOB::GetPoints(void) const
 	{
-		return m_points_;
+		return PointSpan<const cv::Point2f>(m_point_buffer_ ? m_point_buffer_->data() + m_offset_ : nullptr, m_size_);
 	}
 
 	const cv::Point2f& BLOB::GetTopLeftPoint(void) const
@@ -112,7 +123,7 @@ namespace WSICS::BLOB_Operations
 
 	size_t BLOB::Size(void) const
 	{
-		return m_points_.size();
+		return m_size_;
 	}
 
 	bool BLOB::BoxIntersectsWith(const BLOB& other) const
@@ -130,4 +141,19 @@ namespace WSICS::BLOB_Operations
 				m_bottom_right_.x	>= top_left.x &&
 				m_top_left_.x		<= bottom_right.x;
 	}
+
+	void BLOB::PrepareForInsertion_(const size_t additional_points)
+	{
+		// A shared buffer or a range within a larger buffer is copied, leaving the other BLOBs unaffected.
+		if (!m_point_buffer_ || m_point_buffer_.use_count() > 1 || m_offset_ != 0 || m_point_buffer_->size() != m_size_)
+		{
+			std::shared_ptr<std::vector<cv::Point2f>> point_buffer(std::make_shared<std::vector<cv::Point2f>>());
+			point_buffer->reserve(m_size_ + additional_points);
+			PointSpan<const cv::Point2f> points(GetPoints());
+			point_buffer->insert(point_buffer->end(), points.begin(), points.end());
+
+			m_point_buffer_	= std::move(point_buffer);
+			m_offset_		= 0;
+		}
+	}
 }
\ No newline at end of file
@@ -1,13 +1,54 @@
 #ifndef __WSICS_BLOBOPERATIONS_BLOB__
 #define __WSICS_BLOBOPERATIONS_BLOB__
 
+#include <memory>
 #include <vector>
 #include <opencv2/core/types.hpp>
 
 namespace WSICS::BLOB_Operations
 {
+	/// <summary>
+	/// A non owning view of consecutive points, such as the points of a BLOB within a shared point buffer.
+	/// </summary>
+	template <typename PointType>
+	class PointSpan
+	{
+		public:
+			/// <summary>
+			/// Constructs an empty view.
+			/// </summary>
+			PointSpan(void);
+			/// <summary>
+			/// Constructs a view over the passed points.
+			/// </summary>
+			/// <param name="first_point">A pointer towards the first point.</param>
+			/// <param name="size">The amount of points.</param>
+			PointSpan(PointType* first_point, const size_t size);
+			/// <summary>
+			/// Converts a view over mutable points into a view over constant points.
+			/// </summary>
+			/// <param name="other">The view to convert.</param>
+			template <typename OtherPointType>
+			PointSpan(const PointSpan<OtherPointType>& other);
+
+			PointType* begin(void) const;
+			PointType* end(void) const;
+			PointType* data(void) const;
+			size_t size(void) const;
+			bool empty(void) const;
+			PointType& operator[](const size_t index) const;
+
+		private:
+			PointType*	m_first_point_;
+			size_t		m_size_;
+	};
+
 	/// <summary>
 	///	Represents a BLOB, with several features that aid in image processing.
+	///
+	/// The points are held within a buffer that can be shared with other BLOBs, each referencing its own
+	/// consecutive range. Copies of a BLOB share its buffer, while adding points first moves the BLOB
+	/// towards a buffer of its own.
 	///	</summary>
     class BLOB
     {
@@ -41,6 +82,15 @@ namespace WSICS::BLOB_Operations
 			/// <param name="top_left">The top left corner of the BLOB.</param>
 			/// <param name="bottom_right">The bottom right corner of the BLOB.</param>
 			BLOB(std::vector<cv::Point2f>&& blob_points, const cv::Point2f& top_left, const cv::Point2f& bottom_right);
+			/// <summary>
+			/// Initializes the BLOB as a range of a point buffer that is shared with other BLOBs.
+			/// </summary>
+			/// <param name="point_buffer">The buffer holding the points of this and other BLOBs.</param>
+			/// <param name="offset">The index of the first point of this BLOB within the buffer.</param>
+			/// <param name="size">The amount of points that belong to this BLOB.</param>
+			/// <param name="top_left">The top left corner of the BLOB.</param>
+			/// <param name="bottom_right">The bottom right corner of the BLOB.</param>
+			BLOB(const std::shared_ptr<std::vector<cv::Point2f>>& point_buffer, const size_t offset, const size_t size, const cv::Point2f& top_left, const cv::Point2f& bottom_right);
 
 			/// <summary>
 			/// Adds a point to the BLOB, increasing its bounding box if required.
@@ -66,15 +116,15 @@ namespace WSICS::BLOB_Operations
 			void UnsafeAdd(const std::vector<cv::Point2f>& points);
 
 			/// <summary>
-			/// Returns a reference to the list of points within the BLOB.
+			/// Returns a view of the points within the BLOB, which remains valid until points are added.
 			/// </summary>
-			/// <returns>a reference to the list of points.</returns>
-			std::vector<cv::Point2f>& GetPoints(void);
+			/// <returns>A view of the points.</returns>
+			PointSpan<cv::Point2f> GetPoints(void);
 			/// <summary>
-			/// Returns a constant reference to the list of points within the BLOB.
+			/// Returns a constant view of the points within the BLOB, which remains valid until points are added.
 			/// </summary>
-			/// <returns>A constant reference to the list of points.</returns>
-			const std::vector<cv::Point2f>& GetPoints(void) const;
+			/// <returns>A constant view of the points.</returns>
+			PointSpan<const cv::Point2f> GetPoints(void) const;
 
 			/// <summary>
 			/// Returns the upper left point of the BLOB bounding box.
@@ -117,9 +167,70 @@ namespace WSICS::BLOB_Operations
 			bool BoxIntersectsWith(const cv::Point2f& top_left, const cv::Point2f& bottom_right) const;
 
 		private:
-			cv::Point2f					m_top_left_;
-			cv::Point2f					m_bottom_right_;
-			std::vector<cv::Point2f>	m_points_;
+			cv::Point2f									m_top_left_;
+			cv::Point2f									m_bottom_right_;
+			std::shared_ptr<std::vector<cv::Point2f>>	m_point_buffer_;
+			size_t										m_offset_;
+			size_t										m_size_;
+
+			/// <summary>
+			/// Ensures the BLOB holds the only reference to a buffer that contains nothing but its own points,
+			/// which allows points to be appended. A copied buffer is sized to fit the additional points.
+			/// </summary>
+			/// <param name="additional_points">The amount of points that are about to be added.</param>
+			void PrepareForInsertion_(const size_t additional_points);
     };
+
+	template <typename PointType>
+	PointSpan<PointType>::PointSpan(void) : m_first_point_(nullptr), m_size_(0)
+	{
+	}
+
+	template <typename PointType>
+	PointSpan<PointType>::PointSpan(PointType* first_point, const size_t size) : m_first_point_(first_point), m_size_(size)
+	{
+	}
+
+	template <typename PointType>
+	template <typename OtherPointType>
+	PointSpan<PointType>::PointSpan(const PointSpan<OtherPointType>& other) : m_first_point_(other.data()), m_size_(other.size())
+	{
+	}
+
+	template <typename PointType>
+	PointType* PointSpan<PointType>::begin(void) const
+	{
+		return m_first_point_;
+	}
+
+	template <typename PointType>
+	PointType* PointSpan<PointType>::end(void) const
+	{
+		return m_first_point_ + m_size_;
+	}
+
+	template <typename PointType>
+	PointType* PointSpan<PointType>::data(void) const
+	{
+		return m_first_point_;
+	}
+
+	template <typename PointType>
+	size_t PointSpan<PointType>::size(void) const
+	{
+		return m_size_;
+	}
+
+	template <typename PointType>
+	bool PointSpan<PointType>::empty(void) const
+	{
+		return m_size_ == 0;
+	}
+
+	template <typename PointType>
+	PointType& PointSpan<PointType>::operator[](const size_t index) const
+	{
+		return m_first_point_[index];
+	}
 }
 #endif // __WSICS_BLOBOPERATIONS_BLOB__
\ No newline at end of file
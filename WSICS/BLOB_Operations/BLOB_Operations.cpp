@@ -1,5 +1,7 @@
 #include "BLOB_Operations.h"
 
+#include <algorithm>
+
 #include <opencv2/opencv.hpp>
 
 #include "../Misc/MatrixOperations.h"
@@ -64,25 +66,50 @@ namespace WSICS::BLOB_Operations
 
 	std::unordered_map<size_t, BLOB> GroupLabeledPixels(const cv::Mat& matrix, const cv::Mat& stats_array)
 	{
-		// Reserves enough space for the labels.
-		std::unordered_map<size_t, BLOB> labeled_blobs;
-		labeled_blobs.reserve((stats_array.rows));
+		// The points of all BLOBs are stored in a single buffer, in which each label occupies a consecutive range. The
+		// first pass derives the offset of each range from the area statistics, as a prefix sum over the labels.
+		int label_count = std::max(stats_array.rows, 1);
+		std::vector<size_t> label_offsets(label_count + 1, 0);
+		for (int label = 1; label < label_count; ++label)
+		{
+			label_offsets[label + 1] = label_offsets[label] + static_cast<size_t>(stats_array.at<int32_t>(label, cv::CC_STAT_AREA));
+		}
 
-		for (int label = 0; label < stats_array.rows; ++label)
+		// The second pass scans the label matrix row by row, which places the points of each label in the same order
+		// as findNonZero would. The write positions are bounded by the next range, in case the statistics fall short.
+		std::shared_ptr<std::vector<cv::Point2f>> point_buffer(std::make_shared<std::vector<cv::Point2f>>(label_offsets.back()));
+		std::vector<size_t> write_positions(label_offsets.begin(), label_offsets.end() - 1);
+		for (int row = 0; row < matrix.rows; ++row)
 		{
-			labeled_blobs.insert({ label + 1, BLOB() });
+			const int32_t* labels = matrix.ptr<int32_t>(row);
+			for (int column = 0; column < matrix.cols; ++column)
+			{
+				int32_t label = labels[column];
+				if (label > 0 && label < label_count && write_positions[label] < label_offsets[label + 1])
+				{
+					(*point_buffer)[write_positions[label]++] = cv::Point2f(column, row);
+				}
+			}
 		}
 
-		// Acquires all non-zero pixels and loops through them, adding them to the correct label in the map.
-		cv::Mat converted_matrix;
-		matrix.convertTo(converted_matrix, CV_8UC1);
+		// Creates the BLOBs as views into the buffer, with their bounding boxes taken from the statistics.
+		std::unordered_map<size_t, BLOB> labeled_blobs;
+		labeled_blobs.reserve(label_count);
+		for (int label = 1; label < label_count; ++label)
+		{
+			int32_t left	= stats_array.at<int32_t>(label, cv::CC_STAT_LEFT);
+			int32_t top		= stats_array.at<int32_t>(label, cv::CC_STAT_TOP);
+			int32_t width	= stats_array.at<int32_t>(label, cv::CC_STAT_WIDTH);
+			int32_t height	= stats_array.at<int32_t>(label, cv::CC_STAT_HEIGHT);
 
-		std::vector<cv::Point> non_zero_pixels;
-		cv::findNonZero(converted_matrix, non_zero_pixels);
+			labeled_blobs.insert({ label, BLOB(point_buffer, label_offsets[label], write_positions[label] - label_offsets[label],
+				cv::Point2f(left, top), cv::Point2f(left + width - 1, top + height - 1)) });
+		}
 
-		for (const cv::Point& point : non_zero_pixels)
+		// Retains the empty BLOB listed beyond the last label.
+		if (stats_array.rows > 0)
 		{
-			auto iterator = labeled_blobs.find(matrix.at<int32_t>(point))->second.Add(point);
+			labeled_blobs.insert({ label_count, BLOB() });
 		}
 
 		return labeled_blobs;
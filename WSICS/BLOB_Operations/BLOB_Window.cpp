@@ -1,12 +1,18 @@
 #include "BLOB_Window.h"
 
+#include <algorithm>
 #include <cmath>
 #include <stdexcept>
 
 namespace WSICS::BLOB_Operations
 {
 	BLOB_Window::BLOB_Window(const uint32_t window_size) :
-		m_window_size_(window_size), m_window_step_size_(CalculateWindowStepSize_(window_size))
+		m_window_size_(window_size),
+		m_window_step_size_(CalculateWindowStepSize_(window_size)),
+		m_labeled_blobs_(std::make_shared<std::unordered_map<size_t, BLOB>>()),
+		m_blob_grid_(std::make_shared<std::vector<std::vector<size_t>>>()),
+		m_grid_columns_(0),
+		m_grid_rows_(0)
 	{
 	}
 
@@ -16,8 +22,9 @@ namespace WSICS::BLOB_Operations
 		m_window_top_left_(0, 0),
 		m_window_bottom_right_(m_window_size_, m_window_size_),
 		m_matrix_bottom_right_(blob_matrix.rows - 1, blob_matrix.cols - 1),
-		m_labeled_blobs_(BLOB_Operations::GroupLabeledPixels(blob_matrix))
+		m_labeled_blobs_(std::make_shared<std::unordered_map<size_t, BLOB>>(BLOB_Operations::GroupLabeledPixels(blob_matrix)))
 	{
+		BuildBLOBGrid_();
 	}
 
 	BLOB_Window::BLOB_Window(const uint32_t window_size, const cv::Mat& labeled_blob_matrix, const cv::Mat& stats_array) :
@@ -26,8 +33,9 @@ namespace WSICS::BLOB_Operations
 		m_window_top_left_(0, 0),
 		m_window_bottom_right_(m_window_size_, m_window_size_),
 		m_matrix_bottom_right_(labeled_blob_matrix.rows - 1, labeled_blob_matrix.cols - 1),
-		m_labeled_blobs_(BLOB_Operations::GroupLabeledPixels(labeled_blob_matrix, stats_array))
+		m_labeled_blobs_(std::make_shared<std::unordered_map<size_t, BLOB>>(BLOB_Operations::GroupLabeledPixels(labeled_blob_matrix, stats_array)))
 	{
+		BuildBLOBGrid_();
 	}
 
 	BLOB_Window::BLOB_Window(const uint32_t window_size, const cv::Mat& binary_matrix, cv::Mat& output_matrix, const MaskType mask_type) : 
@@ -36,8 +44,9 @@ namespace WSICS::BLOB_Operations
 		m_window_top_left_(0, 0), 
 		m_window_bottom_right_(m_window_size_, m_window_size_), 
 		m_matrix_bottom_right_(binary_matrix.rows - 1, binary_matrix.cols - 1),
-		m_labeled_blobs_(BLOB_Operations::LabelAndGroup(binary_matrix, output_matrix, mask_type))
+		m_labeled_blobs_(std::make_shared<std::unordered_map<size_t, BLOB>>(BLOB_Operations::LabelAndGroup(binary_matrix, output_matrix, mask_type)))
 	{
+		BuildBLOBGrid_();
 	}
 
 	void BLOB_Window::Clear(void)
@@ -45,30 +54,72 @@ namespace WSICS::BLOB_Operations
 		m_window_top_left_		= cv::Point2f();
 		m_window_bottom_right_	= cv::Point2f();
 		m_matrix_bottom_right_	= cv::Point2f();
-		m_labeled_blobs_.clear();
+		m_labeled_blobs_	= std::make_shared<std::unordered_map<size_t, BLOB>>();
+		m_blob_grid_		= std::make_shared<std::vector<std::vector<size_t>>>();
+		m_grid_columns_		= 0;
+		m_grid_rows_		= 0;
 	}
 
 	const std::unordered_map<size_t, BLOB>& BLOB_Window::GetAllMatrixBLOBs(void) const
 	{
-		return m_labeled_blobs_;
+		return *m_labeled_blobs_;
 	}
 
-	std::unordered_map<size_t, BLOB*> BLOB_Window::GetWindowBLOBs(void)
+	const BLOB& BLOB_Window::GetBLOB(const size_t label) const
 	{
-		if (m_labeled_blobs_.empty())
+		return m_labeled_blobs_->at(label);
+	}
+
+	std::unordered_map<size_t, const BLOB*> BLOB_Window::GetWindowBLOBs(void) const
+	{
+		std::unordered_map<size_t, const BLOB*> blobs_within_window;
+		for (size_t label : GetWindowLabels())
+		{
+			blobs_within_window.insert({ label, &m_labeled_blobs_->at(label) });
+		}
+		return blobs_within_window;
+	}
+
+	std::vector<size_t> BLOB_Window::GetWindowLabels(void) const
+	{
+		if (m_labeled_blobs_->empty())
 		{
 			throw std::out_of_range("This BLOB Window hasn't been initialized with any available BLOBs.");
 		}
 
-		std::unordered_map<size_t, BLOB*> blobs_within_window;
-		for (std::pair<const size_t, BLOB>& labeled_blob : m_labeled_blobs_)
+		// Collects the labels from the covered grid cells, which lists BLOBs spanning multiple cells more than once.
+		std::vector<size_t> labels;
+		for (size_t row = GetGridCell_(m_window_top_left_.y, m_grid_rows_); row <= GetGridCell_(m_window_bottom_right_.y, m_grid_rows_); ++row)
 		{
-			if (labeled_blob.second.BoxIntersectsWith(m_window_top_left_, m_window_bottom_right_))
+			for (size_t column = GetGridCell_(m_window_top_left_.x, m_grid_columns_); column <= GetGridCell_(m_window_bottom_right_.x, m_grid_columns_); ++column)
 			{
-				blobs_within_window.insert({ labeled_blob.first, &labeled_blob.second });
+				const std::vector<size_t>& cell((*m_blob_grid_)[row * m_grid_columns_ + column]);
+				labels.insert(labels.end(), cell.begin(), cell.end());
 			}
 		}
-		return blobs_within_window;
+
+		std::sort(labels.begin(), labels.end());
+		labels.erase(std::unique(labels.begin(), labels.end()), labels.end());
+		labels.erase(std::remove_if(labels.begin(), labels.end(), [this](const size_t label)
+		{
+			return !m_labeled_blobs_->at(label).BoxIntersectsWith(m_window_top_left_, m_window_bottom_right_);
+		}),
+		labels.end());
+
+		return labels;
+	}
+
+	size_t BLOB_Window::GetWindowIndex(void) const
+	{
+		size_t windows_per_row = static_cast<size_t>(std::floor(m_matrix_bottom_right_.x / m_window_step_size_)) + 1;
+		return static_cast<size_t>(m_window_top_left_.y / m_window_step_size_) * windows_per_row + static_cast<size_t>(m_window_top_left_.x / m_window_step_size_);
+	}
+
+	size_t BLOB_Window::GetWindowCount(void) const
+	{
+		size_t windows_per_row		= static_cast<size_t>(std::floor(m_matrix_bottom_right_.x / m_window_step_size_)) + 1;
+		size_t windows_per_column	= static_cast<size_t>(std::floor(m_matrix_bottom_right_.y / m_window_step_size_)) + 1;
+		return windows_per_row * windows_per_column;
 	}
 
 	uint32_t BLOB_Window::GetWindowSize(void) const
@@ -80,6 +131,7 @@ namespace WSICS::BLOB_Operations
 	{
 		m_window_size_		= window_size;
 		m_window_step_size_ = CalculateWindowStepSize_(window_size);
+		BuildBLOBGrid_();
 		ShiftWindowToBegin();
 	}
 
@@ -150,8 +202,73 @@ namespace WSICS::BLOB_Operations
 		m_window_bottom_right_	= cv::Point2f(m_window_top_left_.x + m_window_size_, m_window_top_left_.y + m_window_size_);
 	}
 
+	void BLOB_Window::ShiftWindowTo(const size_t window_index)
+	{
+		if (window_index >= GetWindowCount())
+		{
+			throw std::out_of_range("The window index exceeds the amount of windows.");
+		}
+
+		size_t windows_per_row	= static_cast<size_t>(std::floor(m_matrix_bottom_right_.x / m_window_step_size_)) + 1;
+		m_window_top_left_		= cv::Point2f((window_index % windows_per_row) * m_window_step_size_, (window_index / windows_per_row) * m_window_step_size_);
+		m_window_bottom_right_	= cv::Point2f(m_window_top_left_.x + m_window_size_, m_window_top_left_.y + m_window_size_);
+	}
+
+	void BLOB_Window::BuildBLOBGrid_(void)
+	{
+		// The grid is replaced rather than altered, as it may be shared with copies of this window.
+		std::shared_ptr<std::vector<std::vector<size_t>>> blob_grid(std::make_shared<std::vector<std::vector<size_t>>>());
+		m_blob_grid_	= blob_grid;
+		m_grid_columns_	= 0;
+		m_grid_rows_	= 0;
+		if (m_labeled_blobs_->empty())
+		{
+			return;
+		}
+
+		// Spans the grid from the origin towards the furthest BLOB, BLOBs beyond it are clamped into the outer cells.
+		cv::Point2f furthest_point(0, 0);
+		for (const std::pair<const size_t, BLOB>& labeled_blob : *m_labeled_blobs_)
+		{
+			furthest_point.x = std::max(furthest_point.x, labeled_blob.second.GetBottomRightPoint().x);
+			furthest_point.y = std::max(furthest_point.y, labeled_blob.second.GetBottomRightPoint().y);
+		}
+
+		float cell_size	= std::max(m_window_step_size_, 1u);
+		m_grid_columns_	= static_cast<size_t>(furthest_point.x / cell_size) + 1;
+		m_grid_rows_	= static_cast<size_t>(furthest_point.y / cell_size) + 1;
+		blob_grid->resize(m_grid_columns_ * m_grid_rows_);
+
+		for (const std::pair<const size_t, BLOB>& labeled_blob : *m_labeled_blobs_)
+		{
+			const cv::Point2f& top_left(labeled_blob.second.GetTopLeftPoint());
+			const cv::Point2f& bottom_right(labeled_blob.second.GetBottomRightPoint());
+			for (size_t row = GetGridCell_(top_left.y, m_grid_rows_); row <= GetGridCell_(bottom_right.y, m_grid_rows_); ++row)
+			{
+				for (size_t column = GetGridCell_(top_left.x, m_grid_columns_); column <= GetGridCell_(bottom_right.x, m_grid_columns_); ++column)
+				{
+					(*blob_grid)[row * m_grid_columns_ + column].push_back(labeled_blob.first);
+				}
+			}
+		}
+	}
+
 	uint32_t BLOB_Window::CalculateWindowStepSize_(const uint32_t window_size)
 	{
 		return window_size * 5.0f / 6.0f;
 	}
+
+	size_t BLOB_Window::GetGridCell_(const float coordinate, const size_t cell_count) const
+	{
+		float cell = std::floor(coordinate / std::max(m_window_step_size_, 1u));
+		if (cell >= cell_count)
+		{
+			return cell_count - 1;
+		}
+		if (!(cell >= 0))
+		{
+			return 0;
+		}
+		return static_cast<size_t>(cell);
+	}
 }
\ No newline at end of file
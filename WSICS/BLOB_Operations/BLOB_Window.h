@@ -1,7 +1,9 @@
 #ifndef __WSICS_BLOBOPERATIONS_BLOBWINDOW__
 #define __WSICS_BLOBOPERATIONS_BLOBWINDOW__
 
+#include <memory>
 #include <unordered_map>
+#include <vector>
 #include <opencv2/core.hpp>
 
 #include "BLOB_Operations.h"
@@ -11,6 +13,9 @@ namespace WSICS::BLOB_Operations
 	/// <summary>
 	/// Provides windowed / tiled access to the BLOBs of a given matrix.
 	/// Thread unsafe.
+	///
+	/// The BLOBs and the grid that lists them are immutable once created, and are shared between copies of the
+	/// window. Copying a window therefore only copies its position.
 	/// </summary>
 	class BLOB_Window
 	{
@@ -53,11 +58,33 @@ namespace WSICS::BLOB_Operations
 			/// <returns>All the acquired BLOBs that are present within the matrix.</returns>
 			const std::unordered_map<size_t, BLOB>& GetAllMatrixBLOBs(void) const;
 			/// <summary>
+			/// Returns a single BLOB through its label.
+			/// </summary>
+			/// <param name="label">The label of the BLOB.</param>
+			/// <returns>The BLOB attached to the label.</returns>
+			const BLOB& GetBLOB(const size_t label) const;
+			/// <summary>
 			/// Acquires all the BLOBs that have any kind of overlap with the current window.
 			/// </summary>
 			/// <returns>All the BLOBs that have any kind of overlap with the current window.</returns>
-			std::unordered_map<size_t, BLOB*> GetWindowBLOBs(void);
+			std::unordered_map<size_t, const BLOB*> GetWindowBLOBs(void) const;
+			/// <summary>
+			/// Acquires the labels of all the BLOBs that have any kind of overlap with the current window. Only the
+			/// BLOBs listed within the grid cells covered by the window are tested for overlap.
+			/// </summary>
+			/// <returns>The labels of the BLOBs that overlap with the current window, in ascending order.</returns>
+			std::vector<size_t> GetWindowLabels(void) const;
 
+			/// <summary>
+			/// Returns the index of the current window, counted in the order in which ShiftWindowForward visits them.
+			/// </summary>
+			/// <returns>The index of the current window.</returns>
+			size_t GetWindowIndex(void) const;
+			/// <summary>
+			/// Returns the amount of windows that ShiftWindowForward visits, including the first window.
+			/// </summary>
+			/// <returns>The amount of windows.</returns>
+			size_t GetWindowCount(void) const;
 			/// <summary>
 			/// Returns the current window or tile size.
 			/// </summary>
@@ -89,6 +116,11 @@ namespace WSICS::BLOB_Operations
 			/// Shifts the window to its final position at the bottom right corner of the matrix.
 			/// </summary>
 			void ShiftWindowToEnd(void);
+			/// <summary>
+			/// Places the window at the passed index, as counted by GetWindowIndex.
+			/// </summary>
+			/// <param name="window_index">The index of the window.</param>
+			void ShiftWindowTo(const size_t window_index);
 
 		private:
 			uint32_t	m_window_size_;
@@ -97,9 +129,24 @@ namespace WSICS::BLOB_Operations
 			cv::Point2f m_window_bottom_right_;
 			cv::Point2f m_matrix_bottom_right_;
 
-			std::unordered_map<size_t, BLOB>		m_labeled_blobs_;
+			std::shared_ptr<const std::unordered_map<size_t, BLOB>>		m_labeled_blobs_;
+			std::shared_ptr<const std::vector<std::vector<size_t>>>	m_blob_grid_;
+			size_t														m_grid_columns_;
+			size_t														m_grid_rows_;
 
+			/// <summary>
+			/// Lists the label of each BLOB within the grid cells its bounding box overlaps. The cells are as wide as
+			/// the window step, which limits a window to a few cells.
+			/// </summary>
+			void BuildBLOBGrid_(void);
 			uint32_t CalculateWindowStepSize_(const uint32_t window_size);
+			/// <summary>
+			/// Returns the column or row of the grid cell that holds the coordinate, clamped to the grid.
+			/// </summary>
+			/// <param name="coordinate">The coordinate to acquire the cell for.</param>
+			/// <param name="cell_count">The amount of columns or rows of the grid.</param>
+			/// <returns>The column or row of the grid cell.</returns>
+			size_t GetGridCell_(const float coordinate, const size_t cell_count) const;
 	};
 };
 #endif // __WSICS_BLOBOPERATIONS_BLOBWINDOW__
\ No newline at end of file
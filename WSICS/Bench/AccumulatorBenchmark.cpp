@@ -0,0 +1,60 @@
+#include "Benchmarks.h"
+
+#include <iostream>
+
+#include "BenchmarkUtilities.h"
+#include "SyntheticData.h"
+#include "../HoughTransform/GridAccumulator.h"
+#include "../HoughTransform/RandomizedHoughTransform.h"
+#include "../Misc/Random.h"
+
+namespace WSICS::Bench
+{
+	void RunAccumulatorBenchmark(const BenchmarkSettings& settings)
+	{
+		struct FieldDescription
+		{
+			cv::Size	size;
+			size_t		nuclei;
+			size_t		candidates_per_nucleus;
+		};
+
+		// The dense fields place nuclei against each other, while every nucleus receives the candidates of many epochs.
+		const std::vector<FieldDescription> fields({ { cv::Size(1024, 1024), 1000, 20 }, { cv::Size(2048, 2048), 4000, 20 }, { cv::Size(1024, 1024), 1000, 200 } });
+		const HoughTransform::RandomizedHoughTransformParameters parameters(HoughTransform::RandomizedHoughTransform::GetStandardParameters());
+
+		ResultTable table({ "field", "nuclei", "candidates", "radii threshold", "accumulated", "ms", "candidates/ms" });
+		for (size_t field_index = 0; field_index < fields.size(); ++field_index)
+		{
+			const FieldDescription& field(fields[field_index]);
+			boost::mt19937_64 generator(Misc::Random::CreateStream(settings.seed, field_index));
+			std::vector<HoughTransform::Ellipse> nuclei(SyntheticData::GenerateNuclei(field.size, field.nuclei, parameters.min_ellipse_radius, parameters.max_ellipse_radius, generator));
+			std::vector<HoughTransform::Ellipse> candidates(SyntheticData::GenerateCandidates(nuclei, field.size, field.candidates_per_nucleus, 1.5f, 0.2f, generator));
+
+			for (float radii_threshold : { parameters.ellipse_radii_threshold / 4, parameters.ellipse_radii_threshold })
+			{
+				size_t accumulated = 0;
+				auto accumulate = [&]()
+				{
+					HoughTransform::GridAccumulator accumulator(radii_threshold, parameters.ellipse_position_threshold, parameters.count_threshold);
+					for (const HoughTransform::Ellipse& candidate : candidates)
+					{
+						HoughTransform::Ellipse ellipse(candidate);
+						accumulator.AddEllipse(ellipse);
+					}
+					accumulated = accumulator.Accumulate().size();
+				};
+
+				double seconds = MeasureMedianSeconds(settings.repetitions, accumulate);
+				table.AddRow({ std::to_string(field.size.width) + "x" + std::to_string(field.size.height),
+					std::to_string(nuclei.size()),
+					std::to_string(candidates.size()),
+					FormatValue(radii_threshold, 1),
+					std::to_string(accumulated),
+					FormatValue(seconds * 1000),
+					FormatValue(candidates.size() / (seconds * 1000), 0) });
+			}
+		}
+		table.Print(std::cout);
+	}
+}
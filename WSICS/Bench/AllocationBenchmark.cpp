@@ -0,0 +1,82 @@
+#include "Benchmarks.h"
+
+#include <iostream>
+
+#include "AllocationCounter.h"
+#include "BenchmarkUtilities.h"
+#include "SyntheticData.h"
+#include "../HoughTransform/RandomizedHoughTransform.h"
+
+namespace WSICS::Bench
+{
+	void RunAllocationBenchmark(const BenchmarkSettings& settings)
+	{
+		const HoughTransform::RandomizedHoughTransformParameters transform_parameters(HoughTransform::RandomizedHoughTransform::GetStandardParameters());
+		const size_t triplets_per_window = 4096;
+
+		SyntheticData::Tile sampling_tile(SyntheticData::GenerateTile({ cv::Size(1024, 1024), 1000 }, transform_parameters.min_ellipse_radius, transform_parameters.max_ellipse_radius, settings.seed, 0));
+
+		HoughTransform::WindowedTripletDetector detector(HoughTransform::WindowedTripletDetector::GetStandardParameters());
+		cv::Mat labeled_matrix;
+		detector.Initialize(sampling_tile.contours, labeled_matrix, BLOB_Operations::EIGHT_CONNECTEDNESS);
+		detector.SetSeed(settings.seed);
+
+		// Only counts the allocations made while sampling, the construction of each window is excluded.
+		size_t per_triplet_allocations	= 0;
+		size_t batched_allocations		= 0;
+		size_t triplets					= 0;
+		for (size_t window = 0; window < detector.GetWindowCount(); ++window)
+		{
+			detector.MoveTo(window);
+
+			size_t allocations_before = GetAllocationCount();
+			for (size_t triplet = 0; triplet < triplets_per_window; ++triplet)
+			{
+				HoughTransform::PointCollection points(detector.GetNextTriplet());
+			}
+			per_triplet_allocations += GetAllocationCount() - allocations_before;
+
+			HoughTransform::TripletBatch batch;
+			allocations_before = GetAllocationCount();
+			for (size_t drawn = 0; drawn < triplets_per_window; drawn += batch.size)
+			{
+				batch.Clear();
+				detector.GetNextTriplets(batch, HoughTransform::TripletBatch::CAPACITY - batch.size);
+			}
+			batched_allocations += GetAllocationCount() - allocations_before;
+			triplets += triplets_per_window;
+		}
+
+		ResultTable sampling_table({ "entry point", "windows", "triplets", "allocations", "allocations/triplet" });
+		sampling_table.AddRow({ "per triplet", std::to_string(detector.GetWindowCount()), std::to_string(triplets), std::to_string(per_triplet_allocations), FormatValue(static_cast<double>(per_triplet_allocations) / triplets, 4) });
+		sampling_table.AddRow({ "batched", std::to_string(detector.GetWindowCount()), std::to_string(triplets), std::to_string(batched_allocations), FormatValue(static_cast<double>(batched_allocations) / triplets, 4) });
+		sampling_table.Print(std::cout);
+		std::cout << std::endl;
+
+		// The allocations of a complete transform include the BLOB detection, windows and accumulators of each tile.
+		const std::vector<SyntheticData::TileDescription> tiles({ { cv::Size(512, 512), 250 }, { cv::Size(1024, 1024), 1000 }, { cv::Size(2048, 2048), 4000 } });
+		ResultTable tile_table({ "tile", "nuclei", "ellipses", "trials", "allocations", "allocations/1000 trials" });
+		for (size_t tile_index = 0; tile_index < tiles.size(); ++tile_index)
+		{
+			const SyntheticData::TileDescription& description(tiles[tile_index]);
+			SyntheticData::Tile tile(SyntheticData::GenerateTile(description, transform_parameters.min_ellipse_radius, transform_parameters.max_ellipse_radius, settings.seed, tile_index + 1));
+
+			HoughTransform::RandomizedHoughTransformParameters parameters(transform_parameters);
+			parameters.seed = settings.seed;
+			HoughTransform::RandomizedHoughTransform transform(parameters);
+
+			cv::Mat output_matrix;
+			size_t allocations_before = GetAllocationCount();
+			size_t ellipses = transform.Execute(tile.contours, output_matrix, BLOB_Operations::EIGHT_CONNECTEDNESS).size();
+			size_t allocations = GetAllocationCount() - allocations_before;
+
+			tile_table.AddRow({ std::to_string(description.size.width) + "x" + std::to_string(description.size.height),
+				std::to_string(tile.nuclei.size()),
+				std::to_string(ellipses),
+				std::to_string(transform.GetTrialCount()),
+				std::to_string(allocations),
+				FormatValue(allocations * 1000.0 / std::max<size_t>(transform.GetTrialCount(), 1)) });
+		}
+		tile_table.Print(std::cout);
+	}
+}
@@ -0,0 +1,60 @@
+#include "AllocationCounter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+	std::atomic<size_t> allocation_count(0);
+
+	void* Allocate_(const size_t size)
+	{
+		allocation_count.fetch_add(1, std::memory_order_relaxed);
+		void* memory = std::malloc(size == 0 ? 1 : size);
+		if (!memory)
+		{
+			throw std::bad_alloc();
+		}
+		return memory;
+	}
+}
+
+// Replaces the global allocation functions of the benchmark executable, so that every heap allocation is counted.
+void* operator new(const size_t size)
+{
+	return Allocate_(size);
+}
+
+void* operator new[](const size_t size)
+{
+	return Allocate_(size);
+}
+
+void operator delete(void* memory) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete[](void* memory) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete[](void* memory, size_t) noexcept
+{
+	std::free(memory);
+}
+
+namespace WSICS::Bench
+{
+	size_t GetAllocationCount(void)
+	{
+		return allocation_count.load(std::memory_order_relaxed);
+	}
+}
@@ -0,0 +1,14 @@
+#ifndef __WSICS_BENCH_ALLOCATIONCOUNTER__
+#define __WSICS_BENCH_ALLOCATIONCOUNTER__
+
+#include <cstddef>
+
+namespace WSICS::Bench
+{
+	/// <summary>
+	/// Returns the amount of heap allocations made through the global operator new since the start of the program.
+	/// </summary>
+	/// <returns>The amount of allocations.</returns>
+	size_t GetAllocationCount(void);
+}
+#endif // __WSICS_BENCH_ALLOCATIONCOUNTER__
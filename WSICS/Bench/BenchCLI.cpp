@@ -0,0 +1,76 @@
+#include "BenchCLI.h"
+
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+#include "Benchmarks.h"
+
+namespace WSICS::Bench
+{
+	BenchCLI::BenchCLI(void)
+	{
+	}
+
+	void BenchCLI::ExecuteModuleFunctionality$(const boost::program_options::variables_map& variables)
+	{
+		BenchmarkSettings settings;
+		settings.repetitions	= std::max(variables["repetitions"].as<uint32_t>(), 1u);
+		settings.seed			= variables["seed"].as<uint64_t>();
+		settings.thread_count	= variables["threads"].as<uint32_t>();
+
+		std::vector<Benchmark> benchmarks(GetBenchmarks());
+		std::string selection(variables["benchmark"].as<std::string>());
+
+		// Lists the benchmarks to execute, in the order in which they're defined.
+		std::vector<const Benchmark*> selected_benchmarks;
+		if (selection == "all")
+		{
+			for (const Benchmark& benchmark : benchmarks)
+			{
+				selected_benchmarks.push_back(&benchmark);
+			}
+		}
+		else
+		{
+			std::stringstream selection_stream(selection);
+			std::string name;
+			while (std::getline(selection_stream, name, ','))
+			{
+				auto benchmark = std::find_if(benchmarks.begin(), benchmarks.end(), [&name](const Benchmark& benchmark) { return benchmark.name == name; });
+				if (benchmark == benchmarks.end())
+				{
+					throw std::runtime_error("Unknown benchmark: " + name);
+				}
+				selected_benchmarks.push_back(&(*benchmark));
+			}
+		}
+
+		for (const Benchmark* benchmark : selected_benchmarks)
+		{
+			std::cout << "== " << benchmark->name << ": " << benchmark->description << std::endl;
+			benchmark->run(settings);
+			std::cout << std::endl;
+		}
+	}
+
+	void BenchCLI::AddModuleOptions$(boost::program_options::options_description& options)
+	{
+		std::string benchmark_names;
+		for (const Benchmark& benchmark : GetBenchmarks())
+		{
+			benchmark_names += ", " + benchmark.name;
+		}
+
+		options.add_options()
+			("benchmark,b", boost::program_options::value<std::string>()->default_value("all"), std::string("A comma separated list of the benchmarks to execute, or all. Options are: all" + benchmark_names).c_str())
+			("repetitions,r", boost::program_options::value<uint32_t>()->default_value(5), "The amount of times each measurement is repeated, of which the median is reported.")
+			("seed", boost::program_options::value<uint64_t>()->default_value(0), "The seed from which the synthetic data and random streams are derived.")
+			("threads,t", boost::program_options::value<uint32_t>()->default_value(0), "The amount of helper threads for benchmarks that measure concurrent execution, 0 executes them serially.");
+	}
+
+	void BenchCLI::Setup$(void)
+	{
+	}
+}
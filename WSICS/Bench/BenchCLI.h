@@ -0,0 +1,36 @@
+#ifndef __WSICS_BENCH_BENCHCLI__
+#define __WSICS_BENCH_BENCHCLI__
+
+#include "../IO/CommandLineInterface.h"
+
+namespace WSICS::Bench
+{
+	/// <summary>
+	/// Defines the CLI interaction required to select and execute the benchmarks.
+	/// </summary>
+	class BenchCLI : public IO::CommandLineInterface
+	{
+		public:
+			/// <summary>
+			/// Default constructor.
+			/// </summary>
+			BenchCLI(void);
+
+		protected:
+			/// <summary>
+			/// Executes the selected benchmarks.
+			/// </summary>
+			/// <param name="variables">A map containing the command line variables.</param>
+			void ExecuteModuleFunctionality$(const boost::program_options::variables_map& variables);
+			/// <summary>
+			/// Adds the benchmark options to the command line interface.
+			/// </summary>
+			/// <param name="options">A reference to the options_description object, that'll hold the full list of parameters.</param>
+			void AddModuleOptions$(boost::program_options::options_description& options);
+			/// <summary>
+			/// Performs any module specific preparations.
+			/// </summary>
+			void Setup$(void);
+	};
+}
+#endif // __WSICS_BENCH_BENCHCLI__
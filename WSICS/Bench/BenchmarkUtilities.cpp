@@ -0,0 +1,74 @@
+#include "BenchmarkUtilities.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <sstream>
+
+namespace WSICS::Bench
+{
+	ResultTable::ResultTable(const std::vector<std::string>& columns) : m_columns_(columns)
+	{
+	}
+
+	void ResultTable::AddRow(const std::vector<std::string>& values)
+	{
+		m_rows_.push_back(values);
+		m_rows_.back().resize(m_columns_.size());
+	}
+
+	void ResultTable::Print(std::ostream& stream) const
+	{
+		std::vector<size_t> widths(m_columns_.size());
+		for (size_t column = 0; column < m_columns_.size(); ++column)
+		{
+			widths[column] = m_columns_[column].size();
+			for (const std::vector<std::string>& row : m_rows_)
+			{
+				widths[column] = std::max(widths[column], row[column].size());
+			}
+		}
+
+		auto print_row = [&stream, &widths](const std::vector<std::string>& values)
+		{
+			for (size_t column = 0; column < values.size(); ++column)
+			{
+				stream << std::setw(static_cast<int>(widths[column]) + 2) << values[column];
+			}
+			stream << std::endl;
+		};
+
+		print_row(m_columns_);
+		for (const std::vector<std::string>& row : m_rows_)
+		{
+			print_row(row);
+		}
+	}
+
+	double MeasureMedianSeconds(const size_t repetitions, const std::function<void(void)>& function)
+	{
+		return MeasureMedianSeconds(repetitions, []() { }, function);
+	}
+
+	double MeasureMedianSeconds(const size_t repetitions, const std::function<void(void)>& setup, const std::function<void(void)>& function)
+	{
+		std::vector<double> seconds;
+		for (size_t repetition = 0; repetition < std::max(repetitions, size_t(1)); ++repetition)
+		{
+			setup();
+			std::chrono::steady_clock::time_point start(std::chrono::steady_clock::now());
+			function();
+			seconds.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+		}
+
+		std::nth_element(seconds.begin(), seconds.begin() + seconds.size() / 2, seconds.end());
+		return seconds[seconds.size() / 2];
+	}
+
+	std::string FormatValue(const double value, const int decimals)
+	{
+		std::stringstream stream;
+		stream << std::fixed << std::setprecision(decimals) << value;
+		return stream.str();
+	}
+}
@@ -0,0 +1,63 @@
+#ifndef __WSICS_BENCH_BENCHMARKUTILITIES__
+#define __WSICS_BENCH_BENCHMARKUTILITIES__
+
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace WSICS::Bench
+{
+	/// <summary>
+	/// Collects rows of results and prints them as a table with aligned columns.
+	/// </summary>
+	class ResultTable
+	{
+		public:
+			/// <summary>
+			/// Constructs the table.
+			/// </summary>
+			/// <param name="columns">The names of the columns.</param>
+			ResultTable(const std::vector<std::string>& columns);
+
+			/// <summary>
+			/// Adds a row to the table.
+			/// </summary>
+			/// <param name="values">The values for each column.</param>
+			void AddRow(const std::vector<std::string>& values);
+			/// <summary>
+			/// Prints the table.
+			/// </summary>
+			/// <param name="stream">The stream to print the table to.</param>
+			void Print(std::ostream& stream) const;
+
+		private:
+			std::vector<std::string>				m_columns_;
+			std::vector<std::vector<std::string>>	m_rows_;
+	};
+
+	/// <summary>
+	/// Executes a function several times and returns the median of its wall clock times.
+	/// </summary>
+	/// <param name="repetitions">The amount of times to execute the function.</param>
+	/// <param name="function">The function to measure.</param>
+	/// <returns>The median execution time in seconds.</returns>
+	double MeasureMedianSeconds(const size_t repetitions, const std::function<void(void)>& function);
+	/// <summary>
+	/// Executes a function several times and returns the median of its wall clock times. The setup is executed
+	/// before each repetition and isn't included in the measurement.
+	/// </summary>
+	/// <param name="repetitions">The amount of times to execute the function.</param>
+	/// <param name="setup">The function that prepares a repetition.</param>
+	/// <param name="function">The function to measure.</param>
+	/// <returns>The median execution time in seconds.</returns>
+	double MeasureMedianSeconds(const size_t repetitions, const std::function<void(void)>& setup, const std::function<void(void)>& function);
+	/// <summary>
+	/// Formats a value with a fixed amount of decimals.
+	/// </summary>
+	/// <param name="value">The value to format.</param>
+	/// <param name="decimals">The amount of decimals.</param>
+	/// <returns>The formatted value.</returns>
+	std::string FormatValue(const double value, const int decimals = 2);
+}
+#endif // __WSICS_BENCH_BENCHMARKUTILITIES__
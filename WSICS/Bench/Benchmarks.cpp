@@ -0,0 +1,18 @@
+#include "Benchmarks.h"
+
+namespace WSICS::Bench
+{
+	std::vector<Benchmark> GetBenchmarks(void)
+	{
+		return
+		{
+			{ "accumulator", "Ellipse accumulation on dense synthetic fields.", RunAccumulatorBenchmark },
+			{ "verification", "Ellipse verification and simplification on nuclei dense tiles.", RunVerificationBenchmark },
+			{ "specialization", "Generic and specialized triplet sampling, and the specialized window processing.", RunSpecializationBenchmark },
+			{ "allocation", "Heap allocations of the triplet sampling and of complete transforms per tile.", RunAllocationBenchmark },
+			{ "convergence", "Ellipses found against trials spent for several convergence criteria.", RunConvergenceBenchmark },
+			{ "detector", "Speed and Hematoxylin mask agreement of the Hough and contour nucleus detectors.", RunDetectorBenchmark },
+			{ "scheduler", "Parallelism within concurrently normalized slides.", RunSchedulerBenchmark }
+		};
+	}
+}
@@ -0,0 +1,82 @@
+#ifndef __WSICS_BENCH_BENCHMARKS__
+#define __WSICS_BENCH_BENCHMARKS__
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace WSICS::Bench
+{
+	/// <summary>
+	/// Holds the settings shared by all benchmarks.
+	/// </summary>
+	struct BenchmarkSettings
+	{
+		size_t		repetitions;
+		uint64_t	seed;
+		size_t		thread_count;
+	};
+
+	/// <summary>
+	/// Describes a benchmark that can be selected through the command line.
+	/// </summary>
+	struct Benchmark
+	{
+		std::string										name;
+		std::string										description;
+		std::function<void(const BenchmarkSettings&)>	run;
+	};
+
+	/// <summary>
+	/// Returns all benchmarks, in the order in which they're executed.
+	/// </summary>
+	/// <returns>A list containing all the benchmarks.</returns>
+	std::vector<Benchmark> GetBenchmarks(void);
+
+	/// <summary>
+	/// Inserts clusters of ellipse candidates into the GridAccumulator, as produced by a Hough transform on a dense field
+	/// of nuclei. Reports the insertion time and the amount of accumulated ellipses for several thresholds.
+	/// </summary>
+	/// <param name="settings">The settings for the benchmark.</param>
+	void RunAccumulatorBenchmark(const BenchmarkSettings& settings);
+	/// <summary>
+	/// Verifies and simplifies ellipses on a tile densely filled with nuclei, through the point index of the detector and
+	/// through a linear scan over all points, as the detector performed before it was indexed. Reports both timings and
+	/// whether their verdicts agree.
+	/// </summary>
+	/// <param name="settings">The settings for the benchmark.</param>
+	void RunVerificationBenchmark(const BenchmarkSettings& settings);
+	/// <summary>
+	/// Draws triplets for each point selection through the per triplet entry point of the detector, which dispatches on
+	/// every call, and through the batched entry point, which dispatches once per batch. Additionally times the
+	/// Hough transform for each of its specialized combinations of midpoint calculation and ellipse removal.
+	/// </summary>
+	/// <param name="settings">The settings for the benchmark.</param>
+	void RunSpecializationBenchmark(const BenchmarkSettings& settings);
+	/// <summary>
+	/// Counts the heap allocations made while sampling triplets from the windows of a tile, and those made by complete
+	/// Hough transforms on tiles of increasing size.
+	/// </summary>
+	/// <param name="settings">The settings for the benchmark.</param>
+	void RunAllocationBenchmark(const BenchmarkSettings& settings);
+	/// <summary>
+	/// Runs the Hough transform on a sparse and a busy tile for several convergence criteria, reporting the ellipses
+	/// found and the recall of the synthetic nuclei against the trials and time spent.
+	/// </summary>
+	/// <param name="settings">The settings for the benchmark.</param>
+	void RunConvergenceBenchmark(const BenchmarkSettings& settings);
+	/// <summary>
+	/// Runs the Hough and contour nucleus detectors side by side on synthetic stained tiles, reporting their speed and
+	/// the agreement of the resulting Hematoxylin masks with the ground truth and with each other.
+	/// </summary>
+	/// <param name="settings">The settings for the benchmark.</param>
+	void RunDetectorBenchmark(const BenchmarkSettings& settings);
+	/// <summary>
+	/// Runs as many imitated slides as the pool holds workers, each distributing its work over the pool. Reports the
+	/// amount of threads that took part in each slide when the slides are pool tasks, and when they're run by the
+	/// batch scheduler.
+	/// </summary>
+	/// <param name="settings">The settings for the benchmark.</param>
+	void RunSchedulerBenchmark(const BenchmarkSettings& settings);
+}
+#endif // __WSICS_BENCH_BENCHMARKS__
@@ -0,0 +1,87 @@
+#include "Benchmarks.h"
+
+#include <iostream>
+
+#include "BenchmarkUtilities.h"
+#include "SyntheticData.h"
+#include "../HoughTransform/RandomizedHoughTransform.h"
+#include "../Misc/ThreadPool.h"
+
+namespace WSICS::Bench
+{
+	namespace
+	{
+		/// <summary>
+		/// Returns the fraction of nuclei for which a detected ellipse lies within the accumulator thresholds.
+		/// </summary>
+		double CalculateRecall_(const std::vector<HoughTransform::Ellipse>& nuclei, const std::vector<HoughTransform::Ellipse>& detections, const HoughTransform::RandomizedHoughTransformParameters& parameters)
+		{
+			size_t found = 0;
+			for (const HoughTransform::Ellipse& nucleus : nuclei)
+			{
+				for (const HoughTransform::Ellipse& detection : detections)
+				{
+					if (std::abs(nucleus.center.x - detection.center.x) <= parameters.ellipse_position_threshold &&
+						std::abs(nucleus.center.y - detection.center.y) <= parameters.ellipse_position_threshold &&
+						std::abs(nucleus.major_axis - detection.major_axis) <= parameters.ellipse_radii_threshold &&
+						std::abs(nucleus.minor_axis - detection.minor_axis) <= parameters.ellipse_radii_threshold)
+					{
+						++found;
+						break;
+					}
+				}
+			}
+			return nuclei.empty() ? 0 : static_cast<double>(found) / nuclei.size();
+		}
+	}
+
+	void RunConvergenceBenchmark(const BenchmarkSettings& settings)
+	{
+		// The busy tile packs nuclei against each other, which is where the epochs restart most often.
+		const std::vector<SyntheticData::TileDescription> tiles({ { cv::Size(1024, 1024), 250 }, { cv::Size(1024, 1024), 1000 } });
+		const std::vector<size_t> convergence_trials({ 0, 5000, 1000, 250, 50 });
+		const HoughTransform::RandomizedHoughTransformParameters standard_parameters(HoughTransform::RandomizedHoughTransform::GetStandardParameters());
+
+		Misc::ThreadPool thread_pool(settings.thread_count);
+		ResultTable table({ "tile", "nuclei", "convergence trials", "ellipses", "recall", "trials", "ms", "speedup" });
+		for (size_t tile_index = 0; tile_index < tiles.size(); ++tile_index)
+		{
+			const SyntheticData::TileDescription& description(tiles[tile_index]);
+			SyntheticData::Tile tile(SyntheticData::GenerateTile(description, standard_parameters.min_ellipse_radius, standard_parameters.max_ellipse_radius, settings.seed, tile_index));
+
+			// The first entry disables the criterion and serves as the reference for the speedup.
+			double reference_seconds = 0;
+			for (size_t trials : convergence_trials)
+			{
+				HoughTransform::RandomizedHoughTransformParameters parameters(standard_parameters);
+				parameters.convergence_trials	= trials;
+				parameters.seed					= settings.seed;
+
+				HoughTransform::RandomizedHoughTransform transform(parameters);
+				transform.SetThreadPool(&thread_pool);
+
+				std::vector<HoughTransform::Ellipse> detections;
+				double seconds = MeasureMedianSeconds(settings.repetitions, [&]()
+				{
+					cv::Mat output_matrix;
+					detections = transform.Execute(tile.contours, output_matrix, BLOB_Operations::EIGHT_CONNECTEDNESS);
+				});
+
+				if (trials == 0)
+				{
+					reference_seconds = seconds;
+				}
+
+				table.AddRow({ std::to_string(description.size.width) + "x" + std::to_string(description.size.height),
+					std::to_string(tile.nuclei.size()),
+					trials == 0 ? "off" : std::to_string(trials),
+					std::to_string(detections.size()),
+					FormatValue(CalculateRecall_(tile.nuclei, detections, parameters) * 100, 1) + "%",
+					std::to_string(transform.GetTrialCount()),
+					FormatValue(seconds * 1000),
+					FormatValue(reference_seconds / seconds, 2) + "x" });
+			}
+		}
+		table.Print(std::cout);
+	}
+}
@@ -0,0 +1,101 @@
+#include "Benchmarks.h"
+
+#include <iostream>
+#include <memory>
+
+#include <opencv2/core/core.hpp>
+
+#include "BenchmarkUtilities.h"
+#include "SyntheticData.h"
+#include "../HE_Staining/ContourNucleusDetector.h"
+#include "../HE_Staining/HoughNucleusDetector.h"
+#include "../HE_Staining/MaskGeneration.h"
+#include "../HSD/BackgroundMask.h"
+#include "../HoughTransform/RandomizedHoughTransform.h"
+#include "../Misc/ThreadPool.h"
+
+namespace WSICS::Bench
+{
+	namespace
+	{
+		/// <summary>
+		/// Returns the Dice coefficient between the non zero pixels of both masks.
+		/// </summary>
+		double CalculateDice_(const cv::Mat& first_mask, const cv::Mat& second_mask)
+		{
+			size_t total = cv::countNonZero(first_mask) + cv::countNonZero(second_mask);
+			if (total == 0)
+			{
+				return 1;
+			}
+
+			cv::Mat overlap;
+			cv::bitwise_and(first_mask != 0, second_mask != 0, overlap);
+			return 2.0 * cv::countNonZero(overlap) / total;
+		}
+	}
+
+	void RunDetectorBenchmark(const BenchmarkSettings& settings)
+	{
+		// Mirrors the settings with which the pixel classification constructs the detectors at full resolution.
+		const uint32_t blur_sigma			= 4;
+		const uint32_t canny_low_threshold	= 45;
+		const uint32_t canny_high_threshold	= 80;
+		const float hema_percentile			= 0.1f;
+
+		const std::vector<SyntheticData::TileDescription> tiles({ { cv::Size(512, 512), 100 }, { cv::Size(1024, 1024), 400 }, { cv::Size(1024, 1024), 1000 } });
+		HoughTransform::RandomizedHoughTransformParameters transform_parameters(HoughTransform::RandomizedHoughTransform::GetStandardParameters());
+		transform_parameters.seed = settings.seed;
+
+		Misc::ThreadPool thread_pool(settings.thread_count);
+		std::vector<std::pair<std::string, std::unique_ptr<HE_Staining::INucleusDetector>>> detectors;
+		detectors.emplace_back("hough", std::make_unique<HE_Staining::HoughNucleusDetector>(blur_sigma,
+			canny_low_threshold,
+			canny_high_threshold,
+			transform_parameters,
+			HoughTransform::WindowedTripletDetector::GetStandardParameters(),
+			&thread_pool));
+		detectors.emplace_back("contour", std::make_unique<HE_Staining::ContourNucleusDetector>(blur_sigma, transform_parameters.min_ellipse_radius, transform_parameters.max_ellipse_radius));
+
+		ResultTable table({ "tile", "nuclei", "detector", "ellipses", "ms", "speedup", "mask pixels", "dice truth", "dice hough" });
+		for (size_t tile_index = 0; tile_index < tiles.size(); ++tile_index)
+		{
+			const SyntheticData::TileDescription& description(tiles[tile_index]);
+			SyntheticData::Tile tile(SyntheticData::GenerateTile(description, transform_parameters.min_ellipse_radius, transform_parameters.max_ellipse_radius, settings.seed, tile_index));
+			cv::Mat truth_mask(SyntheticData::DrawNucleusMask(description.size, tile.nuclei));
+
+			HSD::HSD_Model hsd_image(SyntheticData::DrawStainedTile(description.size, tile.nuclei, tile.generator), HSD::RGB);
+			cv::Mat background_mask(HSD::BackgroundMask::CreateBackgroundMask(hsd_image, 0.24f, 0.22f));
+
+			// The Hough detector comes first, so that its time and mask serve as the reference for the alternatives.
+			double hough_seconds = 0;
+			cv::Mat hough_mask;
+			for (const std::pair<std::string, std::unique_ptr<HE_Staining::INucleusDetector>>& detector : detectors)
+			{
+				std::vector<HoughTransform::Ellipse> ellipses;
+				double seconds = MeasureMedianSeconds(settings.repetitions, [&]()
+				{
+					ellipses = detector.second->Detect(hsd_image.density);
+				});
+
+				std::pair<bool, HE_Staining::HematoxylinMaskInformation> hema_masks(HE_Staining::MaskGeneration::GenerateHematoxylinMasks(hsd_image, background_mask, ellipses, hema_percentile));
+				if (&detector == &detectors.front())
+				{
+					hough_seconds	= seconds;
+					hough_mask		= hema_masks.first ? hema_masks.second.full_mask : cv::Mat();
+				}
+
+				table.AddRow({ std::to_string(description.size.width) + "x" + std::to_string(description.size.height),
+					std::to_string(tile.nuclei.size()),
+					detector.first,
+					std::to_string(ellipses.size()),
+					FormatValue(seconds * 1000),
+					FormatValue(hough_seconds / seconds, 2) + "x",
+					hema_masks.first ? std::to_string(cv::countNonZero(hema_masks.second.full_mask)) : "rejected",
+					hema_masks.first ? FormatValue(CalculateDice_(hema_masks.second.full_mask, truth_mask), 3) : "-",
+					hema_masks.first && !hough_mask.empty() ? FormatValue(CalculateDice_(hema_masks.second.full_mask, hough_mask), 3) : "-" });
+			}
+		}
+		table.Print(std::cout);
+	}
+}
@@ -0,0 +1,8 @@
+#include "BenchCLI.h"
+
+int main(int argc, char * argv[])
+{
+	WSICS::Bench::BenchCLI cli;
+	cli.Execute(argc, argv);
+	return 0;
+}
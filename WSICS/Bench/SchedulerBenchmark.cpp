@@ -0,0 +1,98 @@
+#include "Benchmarks.h"
+
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <set>
+#include <thread>
+
+#include "BenchmarkUtilities.h"
+#include "../Misc/ThreadPool.h"
+#include "../Normalization/BatchScheduler.h"
+
+namespace WSICS::Bench
+{
+	namespace
+	{
+		/// <summary>
+		/// Imitates a slide, which distributes its work over the pool and records the threads that took part.
+		/// </summary>
+		size_t ProcessSlide_(Misc::ThreadPool& thread_pool, const size_t work_items)
+		{
+			std::mutex thread_access;
+			std::set<std::thread::id> threads;
+			thread_pool.ParallelFor(work_items, [&](const size_t item)
+			{
+				volatile double value = static_cast<double>(item);
+				for (size_t iteration = 0; iteration < 200000; ++iteration)
+				{
+					value = value * 0.999999 + 1.0;
+				}
+
+				std::lock_guard<std::mutex> lock(thread_access);
+				threads.insert(std::this_thread::get_id());
+			});
+			return threads.size();
+		}
+	}
+
+	void RunSchedulerBenchmark(const BenchmarkSettings& settings)
+	{
+		Misc::ThreadPool thread_pool(settings.thread_count);
+		const size_t slide_count	= thread_pool.Size();
+		const size_t work_items		= 256;
+
+		std::vector<Normalization::BatchJob> jobs;
+		for (size_t slide = 0; slide < slide_count; ++slide)
+		{
+			jobs.push_back({ "slide_" + std::to_string(slide), "", "", "", "", 0, 0 });
+		}
+
+		// Compares submitting each slide as a task of the pool it distributes its work over, with the dedicated
+		// threads of the scheduler. The former occupies every worker with a slide, which leaves each slide on its own.
+		ResultTable table({ "dispatch", "slides", "workers", "threads per slide", "ms" });
+
+		std::vector<size_t> pooled_threads(slide_count);
+		double pooled_seconds = MeasureMedianSeconds(settings.repetitions, [&]()
+		{
+			std::vector<std::future<void>> futures;
+			for (size_t slide = 0; slide < slide_count; ++slide)
+			{
+				futures.push_back(thread_pool.Submit([&, slide]() { pooled_threads[slide] = ProcessSlide_(thread_pool, work_items); }));
+			}
+			for (std::future<void>& future : futures)
+			{
+				future.get();
+			}
+		});
+
+		std::mutex scheduled_access;
+		std::vector<size_t> scheduled_threads;
+		double scheduled_seconds = MeasureMedianSeconds(settings.repetitions, [&]()
+		{
+			scheduled_threads.clear();
+			Normalization::BatchScheduler scheduler(thread_pool, 0, 0);
+			scheduler.Execute(jobs, [&](const Normalization::BatchJob& job)
+			{
+				size_t threads = ProcessSlide_(thread_pool, work_items);
+
+				std::lock_guard<std::mutex> lock(scheduled_access);
+				scheduled_threads.push_back(threads);
+			});
+		});
+
+		auto mean = [](const std::vector<size_t>& values)
+		{
+			double sum = 0;
+			for (size_t value : values)
+			{
+				sum += value;
+			}
+			return values.empty() ? 0 : sum / values.size();
+		};
+
+		table.AddRow({ "pool task", std::to_string(slide_count), std::to_string(thread_pool.Size()), FormatValue(mean(pooled_threads)), FormatValue(pooled_seconds * 1000) });
+		table.AddRow({ "scheduler", std::to_string(slide_count), std::to_string(thread_pool.Size()), FormatValue(mean(scheduled_threads)), FormatValue(scheduled_seconds * 1000) });
+		table.Print(std::cout);
+	}
+}
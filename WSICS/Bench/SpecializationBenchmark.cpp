@@ -0,0 +1,145 @@
+#include "Benchmarks.h"
+
+#include <iostream>
+
+#include "BenchmarkUtilities.h"
+#include "SyntheticData.h"
+#include "../HoughTransform/RandomizedHoughTransform.h"
+#include "../Misc/Random.h"
+
+namespace WSICS::Bench
+{
+	namespace
+	{
+		/// <summary>
+		/// Draws the same amount of triplets from every window of the detector. Returns a checksum over the drawn points.
+		/// </summary>
+		template <typename Sampler>
+		double SampleWindows_(HoughTransform::WindowedTripletDetector& detector, const size_t triplets_per_window, Sampler sample)
+		{
+			const size_t batch_capacity = HoughTransform::TripletBatch::CAPACITY;
+			double checksum = 0;
+			HoughTransform::TripletBatch batch;
+			for (size_t window = 0; window < detector.GetWindowCount(); ++window)
+			{
+				detector.MoveTo(window);
+				for (size_t drawn = 0; drawn < triplets_per_window; drawn += batch.size)
+				{
+					batch.Clear();
+					sample(detector, batch, std::min(triplets_per_window - drawn, batch_capacity));
+					for (size_t lane = 0; lane < batch.size; ++lane)
+					{
+						checksum += batch.valid[lane] ? batch.point_x[0][lane] + batch.point_y[1][lane] * 3 + batch.point_x[2][lane] * 7 : -1;
+					}
+				}
+			}
+			return checksum;
+		}
+	}
+
+	void RunSpecializationBenchmark(const BenchmarkSettings& settings)
+	{
+		const HoughTransform::RandomizedHoughTransformParameters transform_parameters(HoughTransform::RandomizedHoughTransform::GetStandardParameters());
+		const cv::Size tile_size(1024, 1024);
+		const size_t triplets_per_window = 4096;
+
+		boost::mt19937_64 generator(Misc::Random::CreateStream(settings.seed, 0));
+		std::vector<HoughTransform::Ellipse> nuclei(SyntheticData::GenerateNuclei(tile_size, 1000, transform_parameters.min_ellipse_radius, transform_parameters.max_ellipse_radius, generator));
+		cv::Mat contours(SyntheticData::DrawNucleusContours(tile_size, nuclei));
+
+		// Compares the per triplet entry point, which dispatches on the point selection for every call, against the
+		// batched entry point that dispatches once and fills the batch through the specialized sampler.
+		HoughTransform::WindowedTripletDetector detector(HoughTransform::WindowedTripletDetector::GetStandardParameters());
+		cv::Mat labeled_matrix;
+		detector.Initialize(contours, labeled_matrix, BLOB_Operations::EIGHT_CONNECTEDNESS);
+
+		const std::vector<std::pair<HoughTransform::PointSelection, std::string>> point_selections(
+		{
+			{ HoughTransform::POINT_SELECTION_FULLY_LABELED, "fully labeled" },
+			{ HoughTransform::POINT_SELECTION_PARTIALLY_LABELED, "partially labeled" },
+			{ HoughTransform::POINT_SELECTION_FULLY_RANDOM, "fully random" },
+			{ HoughTransform::POINT_SELECTION_FULLY_LABELED_DIST_RESTR, "fully labeled, restricted" },
+			{ HoughTransform::POINT_SELECTION_PARTIALLY_LABELED_DIST_RESTR, "partially labeled, restricted" },
+			{ HoughTransform::POINT_SELECTION_FULLY_RANDOM_DIST_RESTR, "fully random, restricted" }
+		});
+
+		ResultTable sampling_table({ "point selection", "triplets", "per triplet ms", "batched ms", "speedup", "identical" });
+		for (const std::pair<HoughTransform::PointSelection, std::string>& point_selection : point_selections)
+		{
+			detector.parameters.point_selection = point_selection.first;
+
+			double per_triplet_checksum = 0;
+			// Both paths start from the same seed, which should make them draw identical triplets.
+			double per_triplet_seconds = MeasureMedianSeconds(settings.repetitions, [&]() { detector.SetSeed(settings.seed); }, [&]()
+			{
+				per_triplet_checksum = SampleWindows_(detector, triplets_per_window, [](HoughTransform::WindowedTripletDetector& detector, HoughTransform::TripletBatch& batch, const size_t count)
+				{
+					for (size_t triplet = 0; triplet < count; ++triplet)
+					{
+						batch.Add(detector.GetNextTriplet());
+					}
+				});
+			});
+
+			double batched_checksum = 0;
+			double batched_seconds = MeasureMedianSeconds(settings.repetitions, [&]() { detector.SetSeed(settings.seed); }, [&]()
+			{
+				batched_checksum = SampleWindows_(detector, triplets_per_window, [](HoughTransform::WindowedTripletDetector& detector, HoughTransform::TripletBatch& batch, const size_t count)
+				{
+					detector.GetNextTriplets(batch, count);
+				});
+			});
+
+			sampling_table.AddRow({ point_selection.second,
+				std::to_string(triplets_per_window * detector.GetWindowCount()),
+				FormatValue(per_triplet_seconds * 1000),
+				FormatValue(batched_seconds * 1000),
+				FormatValue(per_triplet_seconds / batched_seconds, 2) + "x",
+				per_triplet_checksum == batched_checksum ? "yes" : "no" });
+		}
+		sampling_table.Print(std::cout);
+		std::cout << std::endl;
+
+		// The window processing only exists in its specialized form, which is timed for each instantiation.
+		const std::vector<std::pair<HoughTransform::MidpointCalculation, std::string>> midpoint_calculations(
+		{
+			{ HoughTransform::MIDPOINT_CALCULATION_DEFAULT, "default" },
+			{ HoughTransform::MIDPOINT_CALCULATION_OPTIMAL, "optimal" }
+		});
+		const std::vector<std::pair<HoughTransform::EllipseRemoval, std::string>> ellipse_removals(
+		{
+			{ HoughTransform::ELLIPSE_REMOVAL_NONE, "none" },
+			{ HoughTransform::ELLIPSE_REMOVAL_SIMPLE, "simple" },
+			{ HoughTransform::ELLIPSE_REMOVAL_EMPTY_ACCUMULATOR, "empty accumulator" },
+			{ HoughTransform::ELLIPSE_REMOVAL_ALL_IN_EPOCH, "all in epoch" },
+			{ HoughTransform::ELLIPSE_REMOVAL_BEST_IN_EPOCH, "best in epoch" }
+		});
+
+		const cv::Size transform_tile_size(512, 512);
+		std::vector<HoughTransform::Ellipse> transform_nuclei(SyntheticData::GenerateNuclei(transform_tile_size, 250, transform_parameters.min_ellipse_radius, transform_parameters.max_ellipse_radius, generator));
+		cv::Mat transform_contours(SyntheticData::DrawNucleusContours(transform_tile_size, transform_nuclei));
+
+		ResultTable transform_table({ "midpoint", "removal", "ellipses", "trials", "ms" });
+		for (const std::pair<HoughTransform::MidpointCalculation, std::string>& midpoint_calculation : midpoint_calculations)
+		{
+			for (const std::pair<HoughTransform::EllipseRemoval, std::string>& ellipse_removal : ellipse_removals)
+			{
+				HoughTransform::RandomizedHoughTransformParameters parameters(transform_parameters);
+				parameters.midpoint_calculation		= midpoint_calculation.first;
+				parameters.ellipse_removal_method	= ellipse_removal.first;
+				parameters.seed						= settings.seed;
+
+				HoughTransform::RandomizedHoughTransform transform(parameters);
+				size_t ellipses = 0;
+				double seconds = MeasureMedianSeconds(settings.repetitions, [&]()
+				{
+					cv::Mat output_matrix;
+					ellipses = transform.Execute(transform_contours, output_matrix, BLOB_Operations::EIGHT_CONNECTEDNESS).size();
+				});
+
+				transform_table.AddRow({ midpoint_calculation.second, ellipse_removal.second, std::to_string(ellipses), std::to_string(transform.GetTrialCount()), FormatValue(seconds * 1000) });
+			}
+		}
+		transform_table.Print(std::cout);
+	}
+}
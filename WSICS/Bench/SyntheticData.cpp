@@ -0,0 +1,144 @@
+#include "SyntheticData.h"
+
+#define _USE_MATH_DEFINES
+
+#include <math.h>
+
+#include <boost/random/normal_distribution.hpp>
+#include <opencv2/imgproc/imgproc.hpp>
+#include <boost/random/uniform_real_distribution.hpp>
+
+#include "../Misc/Random.h"
+
+namespace WSICS::Bench::SyntheticData
+{
+	namespace
+	{
+		void DrawNucleus_(cv::Mat& matrix, const HoughTransform::Ellipse& nucleus, const cv::Scalar& color, const int thickness)
+		{
+			// The mask generation rotates the major axis by the negated theta, while OpenCV expects degrees.
+			cv::ellipse(matrix, cv::RotatedRect(nucleus.center, cv::Size2f(nucleus.major_axis * 2, nucleus.minor_axis * 2), static_cast<float>(-nucleus.theta * 180 / M_PI)), color, thickness, cv::LINE_8);
+		}
+	}
+
+	std::vector<HoughTransform::Ellipse> GenerateNuclei(const cv::Size& size, const size_t count, const float min_radius, const float max_radius, boost::mt19937_64& generator)
+	{
+		boost::random::uniform_real_distribution<float> radius_distribution(min_radius, max_radius);
+		boost::random::uniform_real_distribution<float> x_distribution(max_radius, std::max(max_radius, size.width - max_radius));
+		boost::random::uniform_real_distribution<float> y_distribution(max_radius, std::max(max_radius, size.height - max_radius));
+		boost::random::uniform_real_distribution<float> theta_distribution(static_cast<float>(-M_PI_2), static_cast<float>(M_PI_2));
+
+		// Rejects nuclei whose bounding circles overlap, giving up once the field appears to be full.
+		std::vector<HoughTransform::Ellipse> nuclei;
+		for (size_t attempt = 0; nuclei.size() < count && attempt < count * 20; ++attempt)
+		{
+			float major_axis = radius_distribution(generator);
+			float minor_axis = radius_distribution(generator);
+			HoughTransform::Ellipse nucleus(cv::Point2f(x_distribution(generator), y_distribution(generator)), std::max(major_axis, minor_axis), std::min(major_axis, minor_axis), theta_distribution(generator));
+
+			bool overlaps = false;
+			for (const HoughTransform::Ellipse& other : nuclei)
+			{
+				cv::Point2f difference(nucleus.center - other.center);
+				float distance = nucleus.major_axis + other.major_axis + 2;
+				if (difference.x * difference.x + difference.y * difference.y < distance * distance)
+				{
+					overlaps = true;
+					break;
+				}
+			}
+
+			if (!overlaps)
+			{
+				nuclei.push_back(nucleus);
+			}
+		}
+
+		return nuclei;
+	}
+
+	std::vector<HoughTransform::Ellipse> GenerateCandidates(const std::vector<HoughTransform::Ellipse>& nuclei,
+		const cv::Size& size,
+		const size_t candidates_per_nucleus,
+		const float jitter,
+		const float false_candidate_ratio,
+		boost::mt19937_64& generator)
+	{
+		boost::random::normal_distribution<float> jitter_distribution(0, jitter);
+		boost::random::uniform_real_distribution<float> x_distribution(0, static_cast<float>(size.width));
+		boost::random::uniform_real_distribution<float> y_distribution(0, static_cast<float>(size.height));
+		boost::random::uniform_real_distribution<float> theta_distribution(static_cast<float>(-M_PI_2), static_cast<float>(M_PI_2));
+
+		std::vector<HoughTransform::Ellipse> candidates;
+		for (const HoughTransform::Ellipse& nucleus : nuclei)
+		{
+			for (size_t candidate = 0; candidate < candidates_per_nucleus; ++candidate)
+			{
+				candidates.push_back(HoughTransform::Ellipse(nucleus.center + cv::Point2f(jitter_distribution(generator), jitter_distribution(generator)),
+					nucleus.major_axis + jitter_distribution(generator),
+					nucleus.minor_axis + jitter_distribution(generator),
+					nucleus.theta + jitter_distribution(generator) * 0.05f));
+			}
+		}
+
+		// False candidates draw their axes from the true nuclei, as the Hough transform restricts their range.
+		size_t false_candidates = static_cast<size_t>(candidates.size() * false_candidate_ratio);
+		for (size_t candidate = 0; candidate < false_candidates && !nuclei.empty(); ++candidate)
+		{
+			const HoughTransform::Ellipse& nucleus(nuclei[Misc::Random::RandomIndex(generator, nuclei.size())]);
+			candidates.push_back(HoughTransform::Ellipse(cv::Point2f(x_distribution(generator), y_distribution(generator)), nucleus.major_axis, nucleus.minor_axis, theta_distribution(generator)));
+		}
+
+		Misc::Random::Shuffle(candidates, generator);
+		return candidates;
+	}
+
+	cv::Mat DrawNucleusContours(const cv::Size& size, const std::vector<HoughTransform::Ellipse>& nuclei)
+	{
+		cv::Mat contours(cv::Mat::zeros(size, CV_8UC1));
+		for (const HoughTransform::Ellipse& nucleus : nuclei)
+		{
+			DrawNucleus_(contours, nucleus, cv::Scalar(255), 1);
+		}
+		return contours;
+	}
+
+	cv::Mat DrawNucleusMask(const cv::Size& size, const std::vector<HoughTransform::Ellipse>& nuclei)
+	{
+		cv::Mat mask(cv::Mat::zeros(size, CV_8UC1));
+		for (const HoughTransform::Ellipse& nucleus : nuclei)
+		{
+			DrawNucleus_(mask, nucleus, cv::Scalar(255), cv::FILLED);
+		}
+		return mask;
+	}
+
+	cv::Mat DrawStainedTile(const cv::Size& size, const std::vector<HoughTransform::Ellipse>& nuclei, boost::mt19937_64& generator)
+	{
+		boost::random::uniform_real_distribution<double> intensity_distribution(0.8, 1.2);
+
+		cv::Mat tile(size, CV_8UC3, cv::Scalar(235, 170, 200));
+		for (const HoughTransform::Ellipse& nucleus : nuclei)
+		{
+			double intensity = intensity_distribution(generator);
+			DrawNucleus_(tile, nucleus, cv::Scalar(95 * intensity, 60 * intensity, 150 * intensity), cv::FILLED);
+		}
+		cv::GaussianBlur(tile, tile, cv::Size(0, 0), 1.0);
+
+		cv::Mat noise(size, CV_16SC3);
+		cv::RNG noise_generator(generator());
+		noise_generator.fill(noise, cv::RNG::NORMAL, cv::Scalar::all(0), cv::Scalar::all(6));
+		cv::Mat noisy_tile;
+		cv::add(tile, noise, noisy_tile, cv::noArray(), CV_8UC3);
+		return noisy_tile;
+	}
+
+	Tile GenerateTile(const TileDescription& description, const float min_radius, const float max_radius, const uint64_t seed, const size_t tile_index)
+	{
+		Tile tile;
+		tile.generator	= Misc::Random::CreateStream(seed, tile_index);
+		tile.nuclei		= GenerateNuclei(description.size, description.nuclei, min_radius, max_radius, tile.generator);
+		tile.contours	= DrawNucleusContours(description.size, tile.nuclei);
+		return tile;
+	}
+}
@@ -0,0 +1,94 @@
+#ifndef __WSICS_BENCH_SYNTHETICDATA__
+#define __WSICS_BENCH_SYNTHETICDATA__
+
+#include <vector>
+
+#include <boost/random/mersenne_twister.hpp>
+#include <opencv2/core/core.hpp>
+
+#include "../HoughTransform/Ellipse.h"
+
+namespace WSICS::Bench::SyntheticData
+{
+	/// <summary>
+	/// Describes a tile through its size and the amount of nuclei to place on it.
+	/// </summary>
+	struct TileDescription
+	{
+		cv::Size	size;
+		size_t		nuclei;
+	};
+
+	/// <summary>
+	/// Holds the nuclei of a generated tile and their contours. The generator continues the stream of the tile,
+	/// which allows the remaining synthetic data of the tile to be drawn from it.
+	/// </summary>
+	struct Tile
+	{
+		std::vector<HoughTransform::Ellipse>	nuclei;
+		cv::Mat									contours;
+		boost::mt19937_64						generator;
+	};
+
+	/// <summary>
+	/// Generates a field of nuclei, described by ellipses that don't overlap each other.
+	/// </summary>
+	/// <param name="size">The size of the field.</param>
+	/// <param name="count">The amount of nuclei to place, fewer are returned if the field runs out of space.</param>
+	/// <param name="min_radius">The minimum length of the semi axes.</param>
+	/// <param name="max_radius">The maximum length of the semi axes.</param>
+	/// <param name="generator">The generator to draw from.</param>
+	/// <returns>The ellipses describing the nuclei.</returns>
+	std::vector<HoughTransform::Ellipse> GenerateNuclei(const cv::Size& size, const size_t count, const float min_radius, const float max_radius, boost::mt19937_64& generator);
+	/// <summary>
+	/// Generates the candidates a Hough transform reports for a field of nuclei. Each nucleus produces a cluster of
+	/// jittered ellipses, which are intermixed with uniformly drawn false candidates.
+	/// </summary>
+	/// <param name="nuclei">The nuclei to generate candidates for.</param>
+	/// <param name="size">The size of the field.</param>
+	/// <param name="candidates_per_nucleus">The amount of candidates generated for each nucleus.</param>
+	/// <param name="jitter">The standard deviation of the center and axes of a candidate.</param>
+	/// <param name="false_candidate_ratio">The amount of false candidates, relative to the amount of true candidates.</param>
+	/// <param name="generator">The generator to draw from.</param>
+	/// <returns>The candidates in random order.</returns>
+	std::vector<HoughTransform::Ellipse> GenerateCandidates(const std::vector<HoughTransform::Ellipse>& nuclei,
+		const cv::Size& size,
+		const size_t candidates_per_nucleus,
+		const float jitter,
+		const float false_candidate_ratio,
+		boost::mt19937_64& generator);
+	/// <summary>
+	/// Draws the contours of the nuclei, as a binary matrix resembling the output of an edge detector.
+	/// </summary>
+	/// <param name="size">The size of the field.</param>
+	/// <param name="nuclei">The nuclei to draw.</param>
+	/// <returns>A CV_8UC1 matrix, holding 255 for every contour pixel and 0 elsewhere.</returns>
+	cv::Mat DrawNucleusContours(const cv::Size& size, const std::vector<HoughTransform::Ellipse>& nuclei);
+	/// <summary>
+	/// Draws the filled nuclei, as a binary matrix resembling an ideal Hematoxylin mask.
+	/// </summary>
+	/// <param name="size">The size of the field.</param>
+	/// <param name="nuclei">The nuclei to draw.</param>
+	/// <returns>A CV_8UC1 matrix, holding 255 for every nucleus pixel and 0 elsewhere.</returns>
+	cv::Mat DrawNucleusMask(const cv::Size& size, const std::vector<HoughTransform::Ellipse>& nuclei);
+	/// <summary>
+	/// Draws a H&E stained tile, with dark purple nuclei of varying intensity on a pink background, slightly blurred and
+	/// overlaid with noise.
+	/// </summary>
+	/// <param name="size">The size of the field.</param>
+	/// <param name="nuclei">The nuclei to draw.</param>
+	/// <param name="generator">The generator to draw the intensities and noise from.</param>
+	/// <returns>A CV_8UC3 matrix in RGB order.</returns>
+	cv::Mat DrawStainedTile(const cv::Size& size, const std::vector<HoughTransform::Ellipse>& nuclei, boost::mt19937_64& generator);
+	/// <summary>
+	/// Generates the nuclei of a tile and draws their contours, drawing from the stream of the tile.
+	/// </summary>
+	/// <param name="description">The size of the tile and the amount of nuclei to place.</param>
+	/// <param name="min_radius">The minimum length of the semi axes.</param>
+	/// <param name="max_radius">The maximum length of the semi axes.</param>
+	/// <param name="seed">The seed from which the stream of the tile is derived.</param>
+	/// <param name="tile_index">The index of the tile, which identifies its stream.</param>
+	/// <returns>The nuclei, their contours and the generator of the tile.</returns>
+	Tile GenerateTile(const TileDescription& description, const float min_radius, const float max_radius, const uint64_t seed, const size_t tile_index);
+}
+#endif // __WSICS_BENCH_SYNTHETICDATA__
@@ -0,0 +1,191 @@
+#include "Benchmarks.h"
+
+#define _USE_MATH_DEFINES
+
+#include <math.h>
+#include <iostream>
+
+#include "BenchmarkUtilities.h"
+#include "SyntheticData.h"
+#include "../BLOB_Operations/BLOB_Operations.h"
+#include "../HoughTransform/RandomizedHoughTransform.h"
+#include "../Misc/Random.h"
+
+namespace WSICS::Bench
+{
+	namespace
+	{
+		/// <summary>
+		/// Holds every point of a tile, alongside whether or not it has been removed.
+		/// </summary>
+		struct LinearPoints
+		{
+			std::vector<cv::Point2f>	points;
+			std::vector<unsigned char>	removed;
+		};
+
+		/// <summary>
+		/// Verifies an ellipse by scanning every point, including the removed ones. Follows the computation of the detector.
+		/// </summary>
+		bool LinearVerify_(const LinearPoints& points, const HoughTransform::Ellipse& ellipse, const HoughTransform::WindowedTripletDetectorParameters& parameters)
+		{
+			float major_axis = ellipse.major_axis;
+			float minor_axis = ellipse.minor_axis;
+
+			float estimated_pixels_on_ellipse = M_PI * (3.0f * (major_axis + minor_axis) - std::sqrt((3.0f * major_axis + minor_axis) * (major_axis + 3.0f * minor_axis)));
+
+			float sin_theta			= std::sin(ellipse.theta);
+			float cos_theta			= std::cos(ellipse.theta);
+			float inner_major_axis	= std::pow(major_axis - parameters.ellipse_range_tolerance, 2);
+			float inner_minor_axis	= std::pow(minor_axis - parameters.ellipse_range_tolerance, 2);
+			float outer_major_axis	= std::pow(major_axis + parameters.ellipse_range_tolerance, 2);
+			float outer_minor_axis	= std::pow(minor_axis + parameters.ellipse_range_tolerance, 2);
+
+			int pixels_on_ellipse = 0;
+			for (const cv::Point2f& point : points.points)
+			{
+				cv::Point2f adjusted_point(point - ellipse.center);
+
+				float a				= std::pow(adjusted_point.y * sin_theta + adjusted_point.x * cos_theta, 2);
+				float b				= std::pow(adjusted_point.y * cos_theta - adjusted_point.x * sin_theta, 2);
+				float inner_result	= a / inner_major_axis + b / inner_minor_axis;
+				float outer_result	= a / outer_major_axis + b / outer_minor_axis;
+
+				if (inner_result > 1 && outer_result < 1)
+				{
+					pixels_on_ellipse++;
+				}
+			}
+
+			return (static_cast<float>(pixels_on_ellipse) / static_cast<float>(estimated_pixels_on_ellipse) > parameters.min_coverage);
+		}
+
+		/// <summary>
+		/// Removes the points covered by an ellipse by scanning every point. Follows the computation of the detector.
+		/// </summary>
+		void LinearSimplify_(LinearPoints& points, const HoughTransform::Ellipse& ellipse, const HoughTransform::WindowedTripletDetectorParameters& parameters)
+		{
+			float sin_theta			= std::sin(ellipse.theta);
+			float cos_theta			= std::cos(ellipse.theta);
+			float outer_major_axis	= std::pow(ellipse.major_axis + parameters.ellipse_removal_range, 2);
+			float outer_minor_axis	= std::pow(ellipse.minor_axis + parameters.ellipse_removal_range, 2);
+
+			for (size_t point = 0; point < points.points.size(); ++point)
+			{
+				if (points.removed[point])
+				{
+					continue;
+				}
+
+				cv::Point2f adjusted_point(points.points[point] - ellipse.center);
+
+				float a = std::pow(adjusted_point.y * sin_theta + adjusted_point.x * cos_theta, 2);
+				float b = std::pow(adjusted_point.y * cos_theta - adjusted_point.x * sin_theta, 2);
+				if (a / outer_major_axis + b / outer_minor_axis < 1)
+				{
+					points.removed[point] = 1;
+				}
+			}
+		}
+
+		/// <summary>
+		/// Verifies each query, simplifying every tenth verified ellipse. Returns the verdict for each query.
+		/// </summary>
+		template <typename Verifier, typename Simplifier>
+		std::vector<unsigned char> ProcessQueries_(const std::vector<HoughTransform::Ellipse>& queries, Verifier verify, Simplifier simplify)
+		{
+			std::vector<unsigned char> verdicts(queries.size(), 0);
+			size_t verified = 0;
+			for (size_t query = 0; query < queries.size(); ++query)
+			{
+				verdicts[query] = verify(queries[query]);
+				if (verdicts[query] && ++verified % 10 == 0)
+				{
+					simplify(queries[query]);
+				}
+			}
+			return verdicts;
+		}
+	}
+
+	void RunVerificationBenchmark(const BenchmarkSettings& settings)
+	{
+		const std::vector<SyntheticData::TileDescription> tiles({ { cv::Size(512, 512), 250 }, { cv::Size(1024, 1024), 1000 }, { cv::Size(2048, 2048), 4000 } });
+		const HoughTransform::RandomizedHoughTransformParameters transform_parameters(HoughTransform::RandomizedHoughTransform::GetStandardParameters());
+		const size_t max_queries = 2000;
+
+		ResultTable table({ "tile", "nuclei", "points", "queries", "verified", "index ms", "linear ms", "speedup", "agreement" });
+		for (size_t tile_index = 0; tile_index < tiles.size(); ++tile_index)
+		{
+			const SyntheticData::TileDescription& description(tiles[tile_index]);
+			SyntheticData::Tile tile(SyntheticData::GenerateTile(description, transform_parameters.min_ellipse_radius, transform_parameters.max_ellipse_radius, settings.seed, tile_index));
+
+			// Half of the queries describe a nucleus, while the other half are displaced far enough to be rejected.
+			std::vector<HoughTransform::Ellipse> queries(tile.nuclei);
+			Misc::Random::Shuffle(queries, tile.generator);
+			queries.resize(std::min(queries.size(), max_queries));
+			for (HoughTransform::Ellipse& query : queries)
+			{
+				if (Misc::Random::RandomIndex(tile.generator, 2) == 0)
+				{
+					query.center += cv::Point2f(3, 3);
+				}
+			}
+
+			// A single window covering the tile places every point within reach of the linear scan.
+			HoughTransform::WindowedTripletDetectorParameters detector_parameters(HoughTransform::WindowedTripletDetector::GetStandardParameters());
+			detector_parameters.window_size = static_cast<uint32_t>(std::max(description.size.width, description.size.height) + 1);
+
+			cv::Mat labeled_matrix;
+			HoughTransform::WindowedTripletDetector detector(detector_parameters);
+			detector.Initialize(tile.contours, labeled_matrix, BLOB_Operations::EIGHT_CONNECTEDNESS);
+
+			LinearPoints linear_points;
+			for (const std::pair<const size_t, BLOB_Operations::BLOB>& labeled_blob : BLOB_Operations::LabelAndGroup(tile.contours, labeled_matrix, BLOB_Operations::EIGHT_CONNECTEDNESS))
+			{
+				if (labeled_blob.second.Size() >= detector_parameters.min_point_distance)
+				{
+					linear_points.points.insert(linear_points.points.end(), labeled_blob.second.GetPoints().begin(), labeled_blob.second.GetPoints().end());
+				}
+			}
+			linear_points.removed.assign(linear_points.points.size(), 0);
+
+			HoughTransform::WindowedTripletDetector working_detector(detector);
+			std::vector<unsigned char> index_verdicts;
+			double index_seconds = MeasureMedianSeconds(settings.repetitions, [&]() { working_detector = detector; }, [&]()
+			{
+				index_verdicts = ProcessQueries_(queries,
+					[&working_detector](const HoughTransform::Ellipse& ellipse) { return working_detector.Verify(ellipse); },
+					[&working_detector](const HoughTransform::Ellipse& ellipse) { working_detector.Simplify(ellipse); });
+			});
+
+			LinearPoints working_points;
+			std::vector<unsigned char> linear_verdicts;
+			double linear_seconds = MeasureMedianSeconds(settings.repetitions, [&]() { working_points = linear_points; }, [&]()
+			{
+				linear_verdicts = ProcessQueries_(queries,
+					[&working_points, &detector_parameters](const HoughTransform::Ellipse& ellipse) { return LinearVerify_(working_points, ellipse, detector_parameters); },
+					[&working_points, &detector_parameters](const HoughTransform::Ellipse& ellipse) { LinearSimplify_(working_points, ellipse, detector_parameters); });
+			});
+
+			size_t verified = 0;
+			size_t agreeing = 0;
+			for (size_t query = 0; query < queries.size(); ++query)
+			{
+				verified += index_verdicts[query];
+				agreeing += index_verdicts[query] == linear_verdicts[query];
+			}
+
+			table.AddRow({ std::to_string(description.size.width) + "x" + std::to_string(description.size.height),
+				std::to_string(tile.nuclei.size()),
+				std::to_string(linear_points.points.size()),
+				std::to_string(queries.size()),
+				std::to_string(verified),
+				FormatValue(index_seconds * 1000),
+				FormatValue(linear_seconds * 1000),
+				FormatValue(linear_seconds / index_seconds, 1) + "x",
+				FormatValue(100.0 * agreeing / std::max<size_t>(queries.size(), 1), 1) + "%" });
+		}
+		table.Print(std::cout);
+	}
+}
@@ -0,0 +1,68 @@
+#include "ContourNucleusDetector.h"
+
+#define _USE_MATH_DEFINES
+#include <algorithm>
+#include <math.h>
+
+#include <opencv2/imgproc/imgproc.hpp>
+
+#include "MaskGeneration.h"
+
+namespace WSICS::HE_Staining
+{
+	ContourNucleusDetector::ContourNucleusDetector(const uint32_t blur_sigma, const float min_radius, const float max_radius, const float min_fill_ratio)
+		: m_blur_sigma_(blur_sigma), m_min_radius_(min_radius), m_max_radius_(max_radius), m_min_fill_ratio_(min_fill_ratio)
+	{
+	}
+
+	std::vector<HoughTransform::Ellipse> ContourNucleusDetector::Detect(const cv::Mat& density_matrix)
+	{
+		std::vector<HoughTransform::Ellipse> detected_ellipses;
+
+		// Blurs the density and scales it towards an 8 bit range, in the same manner as the Canny edge preprocessing.
+		cv::Mat smoothed_matrix;
+		density_matrix.copyTo(smoothed_matrix);
+		MaskGeneration::ApplyBlur(smoothed_matrix, smoothed_matrix, m_blur_sigma_);
+
+		double minimum_value, maximum_value;
+		cv::minMaxIdx(smoothed_matrix, &minimum_value, &maximum_value);
+		if (maximum_value <= 0)
+		{
+			return detected_ellipses;
+		}
+		smoothed_matrix.convertTo(smoothed_matrix, CV_8UC1, 255 / maximum_value);
+
+		// Separates the dense regions and opens them with a disk the size of the smallest nucleus.
+		cv::Mat binary_matrix;
+		cv::threshold(smoothed_matrix, binary_matrix, 0, 255, cv::THRESH_BINARY | cv::THRESH_OTSU);
+
+		int kernel_size = std::max(3, 2 * static_cast<int>(m_min_radius_) + 1);
+		cv::morphologyEx(binary_matrix, binary_matrix, cv::MORPH_OPEN, cv::getStructuringElement(cv::MORPH_ELLIPSE, cv::Size(kernel_size, kernel_size)));
+
+		std::vector<std::vector<cv::Point>> contours;
+		cv::findContours(binary_matrix, contours, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_NONE);
+
+		// Fits an ellipse onto each contour, rejecting those outside of the radius range and irregular clumps of nuclei.
+		for (const std::vector<cv::Point>& contour : contours)
+		{
+			if (contour.size() < 5)
+			{
+				continue;
+			}
+
+			HoughTransform::Ellipse ellipse(MaskGeneration::EllipseFromBox(cv::fitEllipse(contour)));
+			if (ellipse.minor_axis < m_min_radius_ || ellipse.major_axis > m_max_radius_)
+			{
+				continue;
+			}
+
+			double ellipse_area = M_PI * ellipse.major_axis * ellipse.minor_axis;
+			if (cv::contourArea(contour) >= m_min_fill_ratio_ * ellipse_area)
+			{
+				detected_ellipses.push_back(ellipse);
+			}
+		}
+
+		return detected_ellipses;
+	}
+}
@@ -0,0 +1,43 @@
+#ifndef __WSICS_HESTAINING_CONTOURNUCLEUSDETECTOR__
+#define __WSICS_HESTAINING_CONTOURNUCLEUSDETECTOR__
+
+#include "INucleusDetector.h"
+
+namespace WSICS::HE_Staining
+{
+	/// <summary>
+	/// Detects nuclei by thresholding the density and fitting an ellipse onto the contour of each dense region.
+	///
+	/// The density is blurred, scaled towards an 8 bit range and separated through Otsu's threshold. An opening
+	/// with a disk the size of the smallest nucleus removes specks and detaches nuclei that touch through thin
+	/// bridges. Each remaining contour receives an ellipse through cv::fitEllipse, which is only accepted if its
+	/// radii fall into the expected range and the contour fills most of it. Unlike the randomized Hough transform,
+	/// this doesn't sample any points and is therefore deterministic, at the cost of missing nuclei that overlap.
+	/// </summary>
+	class ContourNucleusDetector : public INucleusDetector
+	{
+		public:
+			/// <summary>
+			/// Constructs the detector.
+			/// </summary>
+			/// <param name="blur_sigma">The sigma value for the blur transform.</param>
+			/// <param name="min_radius">The smallest radius a nucleus may have.</param>
+			/// <param name="max_radius">The largest radius a nucleus may have.</param>
+			/// <param name="min_fill_ratio">The fraction of its fitted ellipse that a contour has to cover.</param>
+			ContourNucleusDetector(const uint32_t blur_sigma, const float min_radius, const float max_radius, const float min_fill_ratio = 0.7f);
+
+			/// <summary>
+			/// Detects the nuclei within the density matrix.
+			/// </summary>
+			/// <param name="density_matrix">The density channel of a HSD model.</param>
+			/// <returns>An ellipse for each detected nucleus.</returns>
+			std::vector<HoughTransform::Ellipse> Detect(const cv::Mat& density_matrix);
+
+		private:
+			uint32_t	m_blur_sigma_;
+			float		m_min_radius_;
+			float		m_max_radius_;
+			float		m_min_fill_ratio_;
+	};
+}
+#endif // __WSICS_HESTAINING_CONTOURNUCLEUSDETECTOR__
@@ -1,8 +1,13 @@
 #include "HE_Classifier.h"
 
+#include <algorithm>
+#include <chrono>
+#include <map>
+
 namespace WSICS::HE_Staining
 {
-	HE_Classifier::HE_Classifier(uint32_t max_leaf_size, uint32_t k_value) : max_leaf_size(max_leaf_size), k_value(k_value)
+	HE_Classifier::HE_Classifier(uint32_t max_leaf_size, uint32_t k_value, uint32_t max_index_samples, uint32_t voxel_resolution, uint32_t agreement_samples)
+		: max_leaf_size(max_leaf_size), k_value(k_value), max_index_samples(max_index_samples), voxel_resolution(voxel_resolution), agreement_samples(agreement_samples), m_thread_pool_(nullptr)
 	{
 	}
 
@@ -13,7 +18,7 @@ namespace WSICS::HE_Staining
 		results.train_and_class_data = CreateTrainAndClassData_(hsd_image, background_mask, hema_mask_info, eosin_mask_info);
 
 		// Acquires the classification information.
-		std::pair<cv::Mat, cv::Mat> class_info(this->Apply_KNN_(hsd_image, background_mask, hema_mask_info, eosin_mask_info, results.train_and_class_data));
+		std::pair<cv::Mat, cv::Mat> class_info(this->Apply_KNN_(hsd_image, background_mask, hema_mask_info, eosin_mask_info, results.train_and_class_data, results));
 		results.tissue_classes	= std::move(class_info.first);
 		results.all_classes		= std::move(class_info.second);
 
@@ -37,64 +42,90 @@ namespace WSICS::HE_Staining
 		return results;
 	}
 
+	void HE_Classifier::SetThreadPool(Misc::ThreadPool* thread_pool)
+	{
+		m_thread_pool_ = thread_pool;
+	}
+
 	std::pair<cv::Mat, cv::Mat> HE_Classifier::Apply_KNN_(
 		const HSD::HSD_Model& hsd_image,
 		const cv::Mat& background_mask,
 		const HematoxylinMaskInformation& hema_mask_info,
 		const EosinMaskInformation& eosin_mask_info,
-		const TrainAndClassData& train_and_class_data)
+		const TrainAndClassData& train_and_class_data,
+		ClassificationResults& results)
 	{
 		const cv::Mat&					class_data(train_and_class_data.class_data);
 		const cv::Mat&					train_data(train_and_class_data.train_data);
 		const cv::Mat&					test_data(train_and_class_data.test_data);
 		const std::vector<cv::Point>&	test_indices(train_and_class_data.test_indices);
 
-		// Copies the train and test data into flann matrices.
-		cvflann::Matrix<float> flann_train_data(new float[train_data.rows * train_data.cols], train_data.rows, train_data.cols);
-		for (uint32_t x = 0; x < train_data.rows; ++x)
+		std::chrono::steady_clock::time_point index_start(std::chrono::steady_clock::now());
+
+		// Caps the amount of samples indexed by the tree, the full training data is still reported to the caller.
+		cv::Mat index_train_data(train_data);
+		cv::Mat index_class_data(class_data);
+		if (this->max_index_samples > 0 && static_cast<uint32_t>(train_data.rows) > this->max_index_samples)
 		{
-			for (uint32_t y = 0; y < train_data.cols; ++y)
-			{
-				flann_train_data[x][y] = train_data.at<float>(x, y);
-			}
+			SubsampleTrainingData_(train_data, class_data, index_train_data, index_class_data);
 		}
 
-		cvflann::Matrix<float> flann_test_data(new float[test_data.rows * test_data.cols], test_data.rows, test_data.cols);
-		for (uint32_t x = 0; x < test_data.rows; ++x)
+		// Wraps the train and test data into flann matrices, which only requires them to be continuous.
+		if (!index_train_data.isContinuous())
 		{
-			for (uint32_t y = 0; y < test_data.cols; ++y)
-			{
-				flann_test_data[x][y] = test_data.at<float>(x, y);
-			}
+			index_train_data = index_train_data.clone();
 		}
+		cv::Mat continuous_test_data(test_data.isContinuous() ? test_data : test_data.clone());
+
+		cvflann::Matrix<float> flann_train_data(index_train_data.ptr<float>(), index_train_data.rows, index_train_data.cols);
 
 		// Initializes the knn tree.
 		cvflann::KDTreeSingleIndexParams index_parameters(this->max_leaf_size);
 		cvflann::KDTreeSingleIndex<cvflann::L2<float>> tree_model(flann_train_data, index_parameters);
 		tree_model.buildIndex();
 
-		// Creates two flann matrices to hold the results and executes the K-NN search.
-		cvflann::Matrix<int> flann_indices(new int[this->k_value * test_data.rows], test_data.rows, this->k_value);
-		cvflann::Matrix<float> flann_distributions(new float[this->k_value * test_data.rows], test_data.rows, this->k_value);
-		tree_model.knnSearch(flann_test_data, flann_indices, flann_distributions, this->k_value, cvflann::SearchParams(128));
+		std::chrono::steady_clock::time_point search_start(std::chrono::steady_clock::now());
 
-		std::vector<float> value_list(this->k_value);
-		cv::Mat predicted(cv::Mat::zeros(test_data.rows, 1, CV_32FC1));
-		for (uint32_t x = 0; x < flann_indices.rows; ++x)
+		// Classifies the test pixels either through the votes of their own neighbours, or through the votes of the voxels they fall into.
+		cv::Mat predicted;
+		results.voxel_count = 0;
+		if (this->voxel_resolution > 0)
 		{
-			for (uint32_t y = 0; y < this->k_value; ++y)
-			{
-				value_list[y] = class_data.at<float>(flann_indices[x][y], 0);
-			}
+			predicted = ClassifyThroughVoxels_(tree_model, index_class_data, continuous_test_data, results.voxel_count);
+		}
+		else
+		{
+			predicted = ClassifyThroughNeighbours_(tree_model, index_class_data, continuous_test_data);
+		}
 
-			if (std::accumulate(value_list.begin(), value_list.end(), 0) > 0)
+		std::chrono::steady_clock::time_point search_end(std::chrono::steady_clock::now());
+		results.index_samples	= static_cast<size_t>(index_train_data.rows);
+		results.index_seconds	= std::chrono::duration<double>(search_start - index_start).count();
+		results.search_seconds	= std::chrono::duration<double>(search_end - search_start).count();
+
+		// Compares the voxel classification against exact K-NN, on an evenly spaced subset of the test pixels.
+		results.voxel_agreement = -1.0;
+		if (this->voxel_resolution > 0 && this->agreement_samples > 0 && continuous_test_data.rows > 0)
+		{
+			int sample_count = std::min(continuous_test_data.rows, static_cast<int>(this->agreement_samples));
+			std::vector<int> sampled_rows(sample_count);
+			cv::Mat sampled_test_data(sample_count, continuous_test_data.cols, CV_32FC1);
+			for (int sample = 0; sample < sample_count; ++sample)
 			{
-				predicted.at<float>(x, 0) = 1;
+				sampled_rows[sample] = static_cast<int>(static_cast<int64_t>(sample) * continuous_test_data.rows / sample_count);
+				continuous_test_data.row(sampled_rows[sample]).copyTo(sampled_test_data.row(sample));
 			}
-			else
+
+			cv::Mat exact_predictions(ClassifyThroughNeighbours_(tree_model, index_class_data, sampled_test_data));
+			size_t agreeing_samples = 0;
+			for (int sample = 0; sample < sample_count; ++sample)
 			{
-				predicted.at<float>(x, 0) = -1;
+				if (exact_predictions.at<float>(sample, 0) == predicted.at<float>(sampled_rows[sample], 0))
+				{
+					++agreeing_samples;
+				}
 			}
+			results.voxel_agreement = static_cast<double>(agreeing_samples) / sample_count;
 		}
 
 		// Generates the tissue_class matrix, based on the results of the prediction matrix.
@@ -188,4 +219,167 @@ namespace WSICS::HE_Staining
 
 		return TrainAndClassData();
 	}
+
+	void HE_Classifier::SearchNeighbours_(cvflann::KDTreeSingleIndex<cvflann::L2<float>>& tree_model, const cv::Mat& query_data, std::vector<int>& neighbour_indices)
+	{
+		// Executes the K-NN search in batches of queries, each writing into its own section of the result buffers.
+		const size_t batch_size		= 8192;
+		const size_t query_count	= static_cast<size_t>(query_data.rows);
+		const size_t batch_count	= (query_count + batch_size - 1) / batch_size;
+		neighbour_indices.resize(this->k_value * query_count);
+		std::vector<float> neighbour_distances(this->k_value * query_count);
+
+		auto search_batch = [this, &query_data, &tree_model, &neighbour_indices, &neighbour_distances, batch_size, query_count](const size_t batch)
+		{
+			size_t first_row	= batch * batch_size;
+			size_t row_count	= std::min(batch_size, query_count - first_row);
+
+			cvflann::Matrix<float> flann_query_data(const_cast<float*>(query_data.ptr<float>(static_cast<int>(first_row))), row_count, query_data.cols);
+			cvflann::Matrix<int> flann_indices(neighbour_indices.data() + first_row * this->k_value, row_count, this->k_value);
+			cvflann::Matrix<float> flann_distances(neighbour_distances.data() + first_row * this->k_value, row_count, this->k_value);
+			tree_model.knnSearch(flann_query_data, flann_indices, flann_distances, this->k_value, cvflann::SearchParams(128));
+		};
+
+		if (m_thread_pool_ && m_thread_pool_->Size() > 0 && batch_count > 1)
+		{
+			m_thread_pool_->ParallelFor(batch_count, search_batch);
+		}
+		else
+		{
+			for (size_t batch = 0; batch < batch_count; ++batch)
+			{
+				search_batch(batch);
+			}
+		}
+	}
+
+	cv::Mat HE_Classifier::ClassifyThroughNeighbours_(cvflann::KDTreeSingleIndex<cvflann::L2<float>>& tree_model, const cv::Mat& class_data, const cv::Mat& query_data)
+	{
+		std::vector<int> neighbour_indices;
+		SearchNeighbours_(tree_model, query_data, neighbour_indices);
+
+		std::vector<float> value_list(this->k_value);
+		cv::Mat predicted(cv::Mat::zeros(query_data.rows, 1, CV_32FC1));
+		for (int x = 0; x < query_data.rows; ++x)
+		{
+			for (uint32_t y = 0; y < this->k_value; ++y)
+			{
+				value_list[y] = class_data.at<float>(neighbour_indices[x * this->k_value + y], 0);
+			}
+
+			if (std::accumulate(value_list.begin(), value_list.end(), 0) > 0)
+			{
+				predicted.at<float>(x, 0) = 1;
+			}
+			else
+			{
+				predicted.at<float>(x, 0) = -1;
+			}
+		}
+
+		return predicted;
+	}
+
+	cv::Mat HE_Classifier::ClassifyThroughVoxels_(cvflann::KDTreeSingleIndex<cvflann::L2<float>>& tree_model, const cv::Mat& class_data, const cv::Mat& query_data, size_t& voxel_count)
+	{
+		cv::Mat predicted(cv::Mat::zeros(query_data.rows, 1, CV_32FC1));
+		voxel_count = 0;
+		if (query_data.rows == 0)
+		{
+			return predicted;
+		}
+
+		// Spans the grid over the range of the queries, with the resolution applying to each feature axis.
+		const int resolution	= static_cast<int>(this->voxel_resolution);
+		const int features		= query_data.cols;
+		std::vector<float> minimum(features);
+		std::vector<float> step(features);
+		size_t grid_size = 1;
+		for (int feature = 0; feature < features; ++feature)
+		{
+			double feature_min, feature_max;
+			cv::minMaxLoc(query_data.col(feature), &feature_min, &feature_max);
+			minimum[feature]	= static_cast<float>(feature_min);
+			step[feature]		= feature_max > feature_min ? static_cast<float>((feature_max - feature_min) / resolution) : 1.0f;
+			grid_size			*= resolution;
+		}
+
+		// Assigns each query to a voxel, and each occupied voxel to a slot within the table of votes.
+		std::vector<int32_t>	voxel_slots(grid_size, -1);
+		std::vector<int32_t>	query_slots(query_data.rows);
+		std::vector<size_t>		occupied_voxels;
+		for (int row = 0; row < query_data.rows; ++row)
+		{
+			const float* query = query_data.ptr<float>(row);
+
+			size_t voxel = 0;
+			for (int feature = 0; feature < features; ++feature)
+			{
+				float position	= (query[feature] - minimum[feature]) / step[feature];
+				int cell		= position >= 0 ? std::min(static_cast<int>(position), resolution - 1) : 0;
+				voxel			= voxel * resolution + cell;
+			}
+
+			if (voxel_slots[voxel] < 0)
+			{
+				voxel_slots[voxel] = static_cast<int32_t>(occupied_voxels.size());
+				occupied_voxels.push_back(voxel);
+			}
+			query_slots[row] = voxel_slots[voxel];
+		}
+
+		// Classifies the centres of the occupied voxels, after which each query adopts the vote of its voxel.
+		cv::Mat voxel_centres(static_cast<int>(occupied_voxels.size()), features, CV_32FC1);
+		for (size_t slot = 0; slot < occupied_voxels.size(); ++slot)
+		{
+			float* centre = voxel_centres.ptr<float>(static_cast<int>(slot));
+
+			size_t voxel = occupied_voxels[slot];
+			for (int feature = features - 1; feature >= 0; --feature)
+			{
+				centre[feature]	= minimum[feature] + (static_cast<float>(voxel % resolution) + 0.5f) * step[feature];
+				voxel			/= resolution;
+			}
+		}
+
+		cv::Mat voxel_votes(ClassifyThroughNeighbours_(tree_model, class_data, voxel_centres));
+		for (int row = 0; row < query_data.rows; ++row)
+		{
+			predicted.at<float>(row, 0) = voxel_votes.at<float>(query_slots[row], 0);
+		}
+
+		voxel_count = occupied_voxels.size();
+		return predicted;
+	}
+
+	void HE_Classifier::SubsampleTrainingData_(const cv::Mat& train_data, const cv::Mat& class_data, cv::Mat& subsampled_train_data, cv::Mat& subsampled_class_data) const
+	{
+		// Groups the samples by class, preserving their order.
+		std::map<float, std::vector<int>> class_rows;
+		for (int row = 0; row < class_data.rows; ++row)
+		{
+			class_rows[class_data.at<float>(row, 0)].push_back(row);
+		}
+
+		// Selects an evenly spaced subset of each class, proportional to its share of the training data.
+		std::vector<int> selected_rows;
+		selected_rows.reserve(this->max_index_samples + class_rows.size());
+		for (const std::pair<const float, std::vector<int>>& rows : class_rows)
+		{
+			size_t class_size	= rows.second.size();
+			size_t selection	= std::max<size_t>(1, class_size * this->max_index_samples / class_data.rows);
+			for (size_t sample = 0; sample < selection; ++sample)
+			{
+				selected_rows.push_back(rows.second[sample * class_size / selection]);
+			}
+		}
+
+		subsampled_train_data = cv::Mat(static_cast<int>(selected_rows.size()), train_data.cols, CV_32FC1);
+		subsampled_class_data = cv::Mat(static_cast<int>(selected_rows.size()), 1, CV_32FC1);
+		for (size_t sample = 0; sample < selected_rows.size(); ++sample)
+		{
+			train_data.row(selected_rows[sample]).copyTo(subsampled_train_data.row(static_cast<int>(sample)));
+			subsampled_class_data.at<float>(static_cast<int>(sample), 0) = class_data.at<float>(selected_rows[sample], 0);
+		}
+	}
 }
\ No newline at end of file
@@ -15,6 +15,7 @@
 
 #include "../HSD/HSD_Model.h"
 #include "../HE_Staining/MaskGeneration.h"
+#include "../Misc/ThreadPool.h"
 
 namespace WSICS::HE_Staining
 {
@@ -39,6 +40,11 @@ namespace WSICS::HE_Staining
 		size_t hema_pixels;
 		size_t eosin_pixels;
 		size_t background_pixels;
+		size_t index_samples;
+		double index_seconds;
+		double search_seconds;
+		size_t voxel_count;
+		double voxel_agreement;
 		TrainAndClassData train_and_class_data;
 	};
 
@@ -53,13 +59,19 @@ namespace WSICS::HE_Staining
 		public:
 			uint32_t max_leaf_size;
 			uint32_t k_value;
+			uint32_t max_index_samples;
+			uint32_t voxel_resolution;
+			uint32_t agreement_samples;
 
 			/// <summary>
 			/// Initializes the classifier, setting the max leaf size and k value that direct the K-NN execution.
 			/// </summary>
 			/// <param name="max_leaf_size">The max leaf size for the tree, used by the K-NN algorithm.</param>
 			/// <param name="k_value">The K value for the K-NN algorithm.</param>
-			HE_Classifier(uint32_t max_leaf_size = 50, uint32_t k_value = 7);
+			/// <param name="max_index_samples">The maximum amount of training samples indexed by the tree, 0 indexes all of them.</param>
+			/// <param name="voxel_resolution">The amount of voxels along each feature axis, 0 classifies each test pixel through its own neighbours instead.</param>
+			/// <param name="agreement_samples">The amount of test pixels on which the voxel classification is compared against exact K-NN, 0 skips the comparison.</param>
+			HE_Classifier(uint32_t max_leaf_size = 50, uint32_t k_value = 7, uint32_t max_index_samples = 100000, uint32_t voxel_resolution = 0, uint32_t agreement_samples = 0);
 
 			/// <summary>
 			/// Performs the classification of the image, using the background, Eosin and Hematoxylin masks to
@@ -71,23 +83,34 @@ namespace WSICS::HE_Staining
 			/// <param name="eosin_mask_info">The Eosin masks, annotating pixels corresponding to the staining and those used for training.</param>
 			/// <returns></returns>
 			ClassificationResults Classify(HSD::HSD_Model& hsd_image, cv::Mat& background_mask, HematoxylinMaskInformation& hema_mask_info, EosinMaskInformation& eosin_mask_info);
+			/// <summary>
+			/// Sets the pool used to classify batches of test pixels concurrently. Without a pool, the batches are classified serially.
+			/// </summary>
+			/// <param name="thread_pool">The pool to distribute the batches over, or a nullptr.</param>
+			void SetThreadPool(Misc::ThreadPool* thread_pool);
 
 		private:
+			Misc::ThreadPool* m_thread_pool_;
+
 			/// <summary>
-			/// Classifies the image through the application of K-NN.
+			/// Classifies the image through the application of K-NN. The tree indexes a stratified subsample of the training
+			/// data if it exceeds the maximum amount of index samples, after which the test data is either queried in batches
+			/// or classified through a table of voxel votes.
 			/// </summary>
 			/// <param name="hsd_image">The image to perform the classification on.</param>
 			/// <param name="background_mask">A matrix annotating the background pixels.</param>
 			/// <param name="hema_mask_info">The Hematoxylin masks, annotating pixels corresponding to the staining and those used for training</param>
 			/// <param name="eosin_mask_info">The Eosin masks, annotating pixels corresponding to the staining and those used for training.</param>
 			/// <param name="train_and_class_data">The generated struct with the specific class, training and test data.</param>
+			/// <param name="results">The results to report the amount of indexed samples and the timings in.</param>
 			/// <returns>A pair containing two matrices which together hold the classification information.</returns>
 			std::pair<cv::Mat, cv::Mat> Apply_KNN_(
 				const HSD::HSD_Model& hsd_image,
 				const cv::Mat& background_mask,
 				const HematoxylinMaskInformation& hema_mask_info,
 				const EosinMaskInformation& eosin_mask_info,
-				const TrainAndClassData& train_and_class_data);
+				const TrainAndClassData& train_and_class_data,
+				ClassificationResults& results);
 			/// <summary>
 			/// Calculates the mean and standard deviation values for the matrix. Subtracting the latter from the former.
 			/// </summary>
@@ -103,6 +126,40 @@ namespace WSICS::HE_Staining
 			/// <param name="eosin_mask_info">The Eosin masks, annotating pixels corresponding to the staining and those used for training.</param>
 			/// <returns>A struct containing the class, training and test data.</returns>
 			TrainAndClassData CreateTrainAndClassData_(HSD::HSD_Model& hsd_image, cv::Mat& background_mask, HematoxylinMaskInformation& hema_mask_info, EosinMaskInformation& eosin_mask_info);
+			/// <summary>
+			/// Selects an evenly spaced subset of the samples of each class, keeping the class proportions intact.
+			/// </summary>
+			/// <param name="train_data">The training data to subsample.</param>
+			/// <param name="class_data">The class of each training sample.</param>
+			/// <param name="subsampled_train_data">The matrix to hold the selected training samples.</param>
+			/// <param name="subsampled_class_data">The matrix to hold the classes of the selected samples.</param>
+			void SubsampleTrainingData_(const cv::Mat& train_data, const cv::Mat& class_data, cv::Mat& subsampled_train_data, cv::Mat& subsampled_class_data) const;
+			/// <summary>
+			/// Acquires the K nearest training samples of each query, searching batches of queries concurrently if a thread pool is set.
+			/// </summary>
+			/// <param name="tree_model">The tree that indexes the training samples.</param>
+			/// <param name="query_data">The continuous matrix holding a query per row.</param>
+			/// <param name="neighbour_indices">The vector to hold the K indices of each query, row after row.</param>
+			void SearchNeighbours_(cvflann::KDTreeSingleIndex<cvflann::L2<float>>& tree_model, const cv::Mat& query_data, std::vector<int>& neighbour_indices);
+			/// <summary>
+			/// Classifies each query through the majority vote of its K nearest training samples.
+			/// </summary>
+			/// <param name="tree_model">The tree that indexes the training samples.</param>
+			/// <param name="class_data">The class of each indexed training sample.</param>
+			/// <param name="query_data">The continuous matrix holding a query per row.</param>
+			/// <returns>A matrix holding the predicted class of each query, either 1 or -1.</returns>
+			cv::Mat ClassifyThroughNeighbours_(cvflann::KDTreeSingleIndex<cvflann::L2<float>>& tree_model, const cv::Mat& class_data, const cv::Mat& query_data);
+			/// <summary>
+			/// Classifies each query through the vote of the voxel it falls into. The voxel grid spans the range of the queries,
+			/// and only the centres of the occupied voxels are classified through K-NN, which forms a table of votes that
+			/// the queries then look up.
+			/// </summary>
+			/// <param name="tree_model">The tree that indexes the training samples.</param>
+			/// <param name="class_data">The class of each indexed training sample.</param>
+			/// <param name="query_data">The continuous matrix holding a query per row.</param>
+			/// <param name="voxel_count">The amount of occupied voxels that were classified.</param>
+			/// <returns>A matrix holding the predicted class of each query, either 1 or -1.</returns>
+			cv::Mat ClassifyThroughVoxels_(cvflann::KDTreeSingleIndex<cvflann::L2<float>>& tree_model, const cv::Mat& class_data, const cv::Mat& query_data, size_t& voxel_count);
 	};
 }
 #endif // __WSICS_HE_STAINING_HECLASSIFIER__
\ No newline at end of file
@@ -0,0 +1,26 @@
+#include "HoughNucleusDetector.h"
+
+#include "MaskGeneration.h"
+
+namespace WSICS::HE_Staining
+{
+	HoughNucleusDetector::HoughNucleusDetector(const uint32_t blur_sigma,
+		const uint32_t canny_low_threshold,
+		const uint32_t canny_high_threshold,
+		const HoughTransform::RandomizedHoughTransformParameters& transform_parameters,
+		const HoughTransform::WindowedTripletDetectorParameters& triplet_detector_parameters,
+		Misc::ThreadPool* thread_pool)
+		: m_blur_sigma_(blur_sigma),
+		m_canny_low_threshold_(canny_low_threshold),
+		m_canny_high_threshold_(canny_high_threshold),
+		m_transform_parameters_(transform_parameters),
+		m_triplet_detector_parameters_(triplet_detector_parameters),
+		m_thread_pool_(thread_pool)
+	{
+	}
+
+	std::vector<HoughTransform::Ellipse> HoughNucleusDetector::Detect(const cv::Mat& density_matrix)
+	{
+		return MaskGeneration::DetectEllipses(density_matrix, m_blur_sigma_, m_canny_low_threshold_, m_canny_high_threshold_, m_transform_parameters_, m_triplet_detector_parameters_, m_thread_pool_);
+	}
+}
@@ -0,0 +1,48 @@
+#ifndef __WSICS_HESTAINING_HOUGHNUCLEUSDETECTOR__
+#define __WSICS_HESTAINING_HOUGHNUCLEUSDETECTOR__
+
+#include "../HoughTransform/RandomizedHoughTransform.h"
+#include "../Misc/ThreadPool.h"
+#include "INucleusDetector.h"
+
+namespace WSICS::HE_Staining
+{
+	/// <summary>
+	/// Detects nuclei by applying a blur and Canny edge transform to the density, followed by a randomized Hough transform.
+	/// </summary>
+	class HoughNucleusDetector : public INucleusDetector
+	{
+		public:
+			/// <summary>
+			/// Constructs the detector.
+			/// </summary>
+			/// <param name="blur_sigma">The sigma value for the blur transform.</param>
+			/// <param name="canny_low_threshold">The low threshold used for the canny edge transform.</param>
+			/// <param name="canny_high_threshold">The high threshold used for the canny edge transform.</param>
+			/// <param name="transform_parameters">The parameters used to perform the Hough transform.</param>
+			/// <param name="triplet_detector_parameters">The parameters used to acquire the point triplets.</param>
+			/// <param name="thread_pool">The pool to process the Hough transform windows with, or a nullptr to process them serially.</param>
+			HoughNucleusDetector(const uint32_t blur_sigma,
+				const uint32_t canny_low_threshold,
+				const uint32_t canny_high_threshold,
+				const HoughTransform::RandomizedHoughTransformParameters& transform_parameters,
+				const HoughTransform::WindowedTripletDetectorParameters& triplet_detector_parameters,
+				Misc::ThreadPool* thread_pool);
+
+			/// <summary>
+			/// Detects the nuclei within the density matrix.
+			/// </summary>
+			/// <param name="density_matrix">The density channel of a HSD model.</param>
+			/// <returns>An ellipse for each detected nucleus.</returns>
+			std::vector<HoughTransform::Ellipse> Detect(const cv::Mat& density_matrix);
+
+		private:
+			uint32_t										m_blur_sigma_;
+			uint32_t										m_canny_low_threshold_;
+			uint32_t										m_canny_high_threshold_;
+			HoughTransform::RandomizedHoughTransformParameters	m_transform_parameters_;
+			HoughTransform::WindowedTripletDetectorParameters	m_triplet_detector_parameters_;
+			Misc::ThreadPool*								m_thread_pool_;
+	};
+}
+#endif // __WSICS_HESTAINING_HOUGHNUCLEUSDETECTOR__
@@ -0,0 +1,41 @@
+#ifndef __WSICS_HESTAINING_INUCLEUSDETECTOR__
+#define __WSICS_HESTAINING_INUCLEUSDETECTOR__
+
+#include <vector>
+
+#include <opencv2/core/core.hpp>
+
+#include "../HoughTransform/Ellipse.h"
+
+namespace WSICS::HE_Staining
+{
+	/// <summary>
+	/// Lists the available nucleus detectors.
+	/// </summary>
+	enum NucleusDetection
+	{
+		NUCLEUS_DETECTION_HOUGH = 0,
+		NUCLEUS_DETECTION_CONTOUR = 1
+	};
+
+	/// <summary>
+	/// An interface for a nucleus detector, an implementor should be able to locate the nuclei within
+	/// a density matrix and describe each of them through an ellipse.
+	/// </summary>
+	class INucleusDetector
+	{
+		public:
+			/// <summary>
+			/// Destructs the object.
+			/// </summary>
+			virtual ~INucleusDetector(void) { };
+
+			/// <summary>
+			/// Detects the nuclei within the density matrix.
+			/// </summary>
+			/// <param name="density_matrix">The density channel of a HSD model.</param>
+			/// <returns>An ellipse for each detected nucleus.</returns>
+			virtual std::vector<HoughTransform::Ellipse> Detect(const cv::Mat& density_matrix) = 0;
+	};
+}
+#endif // __WSICS_HESTAINING_INUCLEUSDETECTOR__
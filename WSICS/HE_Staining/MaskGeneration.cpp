@@ -1,11 +1,13 @@
 #include "MaskGeneration.h"
 
 #define _USE_MATH_DEFINES
+#include <algorithm>
+#include <climits>
 #include <iostream>
 #include <math.h>
 
 #include "../Misc/MatrixOperations.h"
-#include "../Misc/MT_Singleton.hpp"
+#include "../Misc/Random.h"
 
 namespace WSICS::HE_Staining::MaskGeneration
 {
@@ -31,10 +33,15 @@ namespace WSICS::HE_Staining::MaskGeneration
 		cv::Canny(output_matrix, output_matrix, low_threshold, high_threshold, 3);
 	}
 
-	std::vector<HoughTransform::Ellipse> ApplyHoughTransform(const cv::Mat& binary_matrix, cv::Mat& output_matrix, const HoughTransform::RandomizedHoughTransformParameters& transform_parameters)
+	std::vector<HoughTransform::Ellipse> ApplyHoughTransform(const cv::Mat& binary_matrix,
+		cv::Mat& output_matrix,
+		const HoughTransform::RandomizedHoughTransformParameters& transform_parameters,
+		const HoughTransform::WindowedTripletDetectorParameters& triplet_detector_parameters,
+		Misc::ThreadPool* thread_pool)
 	{
 		// Prepares the Hough Transform algorithm and executes it.
-		HoughTransform::RandomizedHoughTransform hough_transform_algorithm(transform_parameters);
+		HoughTransform::RandomizedHoughTransform hough_transform_algorithm(transform_parameters, triplet_detector_parameters);
+		hough_transform_algorithm.SetThreadPool(thread_pool);
 		return hough_transform_algorithm.Execute(binary_matrix, output_matrix, WSICS::BLOB_Operations::EIGHT_CONNECTEDNESS);
 	}
 
@@ -42,7 +49,9 @@ namespace WSICS::HE_Staining::MaskGeneration
 		const uint32_t blur_sigma,
 		const uint32_t canny_low_threshold,
 		const uint32_t canny_high_threshold,
-		const HoughTransform::RandomizedHoughTransformParameters& transform_parameters)
+		const HoughTransform::RandomizedHoughTransformParameters& transform_parameters,
+		const HoughTransform::WindowedTripletDetectorParameters& triplet_detector_parameters,
+		Misc::ThreadPool* thread_pool)
 	{
 		cv::Mat temporary_matrix;
 		matrix.copyTo(temporary_matrix);
@@ -50,7 +59,23 @@ namespace WSICS::HE_Staining::MaskGeneration
 		ApplyBlur(temporary_matrix, temporary_matrix, blur_sigma);
 		ApplyCannyEdge(temporary_matrix, temporary_matrix, canny_low_threshold, canny_high_threshold);
 
-		return ApplyHoughTransform(temporary_matrix, temporary_matrix, transform_parameters);
+		return ApplyHoughTransform(temporary_matrix, temporary_matrix, transform_parameters, triplet_detector_parameters, thread_pool);
+	}
+
+	HoughTransform::Ellipse EllipseFromBox(const cv::RotatedRect& box)
+	{
+		// The box angle describes the rotation of its width in degrees, while the mask generation rotates
+		// the major axis by the negated theta in radians.
+		float major_axis	= box.size.width / 2;
+		float minor_axis	= box.size.height / 2;
+		float angle			= box.angle;
+		if (minor_axis > major_axis)
+		{
+			std::swap(major_axis, minor_axis);
+			angle += 90;
+		}
+
+		return HoughTransform::Ellipse(box.center, major_axis, minor_axis, static_cast<float>(-angle * M_PI / 180));
 	}
 
 	double AcquirePercentile(std::vector<float> mean_vector, const float index_percentage)
@@ -92,44 +117,55 @@ namespace WSICS::HE_Staining::MaskGeneration
 		return new_contours;
 	}
 
-	EosinMaskInformation GenerateEosinMasks(const HSD::HSD_Model& hsd_image, const cv::Mat& background_mask, const HematoxylinMaskInformation& hema_mask_info, const float eosin_index_percentile)
+	EosinMaskInformation GenerateEosinMasks(const HSD::HSD_Model& hsd_image, const cv::Mat& background_mask, const HematoxylinMaskInformation& hema_mask_info, boost::mt19937_64& generator, const float eosin_index_percentile)
 	{
-		// Merges the hema and background masks and generates the first eosin candidate mask.
-		cv::Mat hema_and_background_mask(255 * (background_mask + hema_mask_info.full_mask));
-		cv::Mat eosin_mask_candidate_one((255 - hema_and_background_mask) / 255);
-
-		size_t candidates_count = cv::countNonZero(eosin_mask_candidate_one);
+		// The first eosin candidates are the pixels that belong to neither the background nor the Hematoxylin mask.
+		// Gathers their red densities in a single pass, without materializing the candidate mask.
 		std::vector<float> eosin_density_values;
-		for (int row = 0; row < eosin_mask_candidate_one.rows; ++row)
+		eosin_density_values.reserve(hsd_image.red_density.total());
+		for (int row = 0; row < hsd_image.red_density.rows; ++row)
 		{
-			for (int col = 0; col < eosin_mask_candidate_one.cols; ++col)
+			const float* red_density			= hsd_image.red_density.ptr<float>(row);
+			const unsigned char* background		= background_mask.ptr<unsigned char>(row);
+			const unsigned char* hematoxylin	= hema_mask_info.full_mask.ptr<unsigned char>(row);
+			for (int column = 0; column < hsd_image.red_density.cols; ++column)
 			{
-				if (eosin_mask_candidate_one.at<unsigned char>(row, col) == 1)
+				if ((background[column] | hematoxylin[column]) == 0)
 				{
-					eosin_density_values.emplace_back(hsd_image.red_density.at<float>(row, col));
+					eosin_density_values.push_back(red_density[column]);
 				}
 			}
 		}
 
 		// Calculates the eosin percentile.
-		double eosin_percentile_value = AcquirePercentile(eosin_density_values, eosin_index_percentile);
-
-		// Generates the seconds eosin candidate mask.
-		cv::Mat eosin_mask_candidate_two(cv::Mat::zeros(hsd_image.red_density.size(), CV_8UC1));
-		cv::threshold(hsd_image.red_density, eosin_mask_candidate_two, eosin_percentile_value, 1, 1);
-		eosin_mask_candidate_two.convertTo(eosin_mask_candidate_two, CV_8UC1);
-		eosin_mask_candidate_two = eosin_mask_candidate_two.mul(1 - background_mask);
+		float eosin_percentile_value = static_cast<float>(AcquirePercentile(eosin_density_values, eosin_index_percentile));
 
-		// Composes the eosin mask out of the two candidates and acquires the non-zero pixels.
+		// Composes the eosin mask out of the first candidates whose red density doesn't exceed the percentile, and acquires the
+		// non-zero pixels in the same pass. The comparison is negated to match the inverted binary threshold it replaces.
 		EosinMaskInformation eosin_mask_info;
-		eosin_mask_info.full_mask = eosin_mask_candidate_one.mul(eosin_mask_candidate_two);
+		eosin_mask_info.full_mask = cv::Mat(hsd_image.red_density.size(), CV_8UC1);
 		std::vector<cv::Point> eosin_non_zero_pixels;
-		cv::findNonZero(eosin_mask_info.full_mask, eosin_non_zero_pixels);
-		std::shuffle(eosin_non_zero_pixels.begin(), eosin_non_zero_pixels.end(), WSICS::Misc::MT_Singleton::GetGenerator());
+		eosin_non_zero_pixels.reserve(eosin_density_values.size());
+		for (int row = 0; row < hsd_image.red_density.rows; ++row)
+		{
+			const float* red_density			= hsd_image.red_density.ptr<float>(row);
+			const unsigned char* background		= background_mask.ptr<unsigned char>(row);
+			const unsigned char* hematoxylin	= hema_mask_info.full_mask.ptr<unsigned char>(row);
+			unsigned char* eosin				= eosin_mask_info.full_mask.ptr<unsigned char>(row);
+			for (int column = 0; column < hsd_image.red_density.cols; ++column)
+			{
+				eosin[column] = static_cast<unsigned char>(((background[column] | hematoxylin[column]) == 0) & !(red_density[column] > eosin_percentile_value));
+				if (eosin[column])
+				{
+					eosin_non_zero_pixels.push_back(cv::Point(column, row));
+				}
+			}
+		}
+		Misc::Random::Shuffle(eosin_non_zero_pixels, generator);
 
 		// Creates a training mask, where each non-zero eosin mask pixel is set to 1 if there are more eosin pixels than hema pixels.
 		size_t red_mask_pixels_sum = cv::sum(hema_mask_info.training_mask)[0];
-		if (cv::sum(eosin_mask_info.full_mask)[0] > cv::sum(hema_mask_info.training_mask)[0])
+		if (eosin_non_zero_pixels.size() > red_mask_pixels_sum)
 		{
 			eosin_mask_info.training_mask = cv::Mat::zeros(hsd_image.red_density.size(), CV_8UC1);
 			for (size_t pixel = 0; pixel < red_mask_pixels_sum; ++pixel)
@@ -155,21 +191,32 @@ namespace WSICS::HE_Staining::MaskGeneration
 		const std::vector<HoughTransform::Ellipse>& ellipses,
 		const float hema_index_percentile)
 	{
-		cv::Mat green_mask;
-		cv::threshold(hsd_image.green_density, green_mask, 1.0, 1, cv::THRESH_BINARY);
-		green_mask.convertTo(green_mask, CV_8UC1);
-
-		cv::Mat difference_red_green(hsd_image.red_density - hsd_image.green_density);
-		cv::threshold(difference_red_green, difference_red_green, 0.5, 1, cv::THRESH_BINARY);
-		difference_red_green.convertTo(difference_red_green, CV_8UC1);
-		difference_red_green = difference_red_green.mul(green_mask);
+		// Counts the pixels with a high green density that is clearly exceeded by the red density, which indicates artifacts such as ink.
+		size_t artifact_pixels = 0;
+		for (int row = 0; row < hsd_image.red_density.rows; ++row)
+		{
+			const float* red_density	= hsd_image.red_density.ptr<float>(row);
+			const float* green_density	= hsd_image.green_density.ptr<float>(row);
+			for (int column = 0; column < hsd_image.red_density.cols; ++column)
+			{
+				artifact_pixels += (green_density[column] > 1.0f) & (red_density[column] - green_density[column] > 0.5f);
+			}
+		}
 
 		HematoxylinMaskInformation hema_mask_info;
 
-		if (cv::sum(difference_red_green)[0] < 10000) // Used to remove artifacts. - Good number = 10000
+		if (artifact_pixels < 10000) // Used to remove artifacts. - Good number = 10000
 		{
+			// Precomputes the unit circle that each ellipse contour is derived from.
 			uint16_t interval = 200;
 			std::vector<double> phi = LinearSpace(0, 2 * M_PI, interval);
+			std::vector<double> cos_phi(interval);
+			std::vector<double> sin_phi(interval);
+			for (uint16_t i = 0; i < interval; ++i)
+			{
+				cos_phi[i] = cos(phi[i]);
+				sin_phi[i] = sin(phi[i]);
+			}
 
 			// Initializes the vectors that will hold the mean values, reservering enough space to equal the amount of ellipses.
 			std::vector<float> red_mean;
@@ -185,32 +232,54 @@ namespace WSICS::HE_Staining::MaskGeneration
 			hema_mask_info.full_mask = cv::Mat::zeros(hsd_image.red_density.size(), CV_8UC1);
 
 			// Loops through all the ellipses, calculating contour and mean values while updating the non-rejection training mask.
+			// Each ellipse is only rasterized within its bounding box, clipped to the tile, which also limits the mean calculations.
 			for (const HoughTransform::Ellipse& ellipse : ellipses)
 			{
 				std::vector<std::vector<cv::Point>> coordinates(1);
-				coordinates.reserve(interval);
+				coordinates[0].reserve(interval);
 
-				cv::Mat rotation_matrix = (cv::Mat_<double>(2, 2) << cos(ellipse.theta), sin(ellipse.theta), -sin(ellipse.theta), cos(ellipse.theta));
+				double cos_theta = cos(ellipse.theta);
+				double sin_theta = sin(ellipse.theta);
+				cv::Point top_left(hsd_image.red_density.cols, hsd_image.red_density.rows);
+				cv::Point bottom_right(-1, -1);
 				for (uint16_t i = 0; i < interval; ++i)
 				{
-					coordinates[0].push_back
+					cv::Point point
 					(
-						cv::Point
-						(
-							(rotation_matrix.at<double>(0, 0) * ellipse.major_axis *  cos(phi[i]) + rotation_matrix.at<double>(0, 1) * ellipse.minor_axis * sin(phi[i])) + ellipse.center.x,
-							(rotation_matrix.at<double>(1, 0) * ellipse.major_axis *  cos(phi[i]) + rotation_matrix.at<double>(1, 1) * ellipse.minor_axis * sin(phi[i])) + ellipse.center.y
-						)
+						static_cast<int>((cos_theta * ellipse.major_axis * cos_phi[i] + sin_theta * ellipse.minor_axis * sin_phi[i]) + ellipse.center.x),
+						static_cast<int>((-sin_theta * ellipse.major_axis * cos_phi[i] + cos_theta * ellipse.minor_axis * sin_phi[i]) + ellipse.center.y)
 					);
+
+					top_left.x		= std::min(top_left.x, point.x);
+					top_left.y		= std::min(top_left.y, point.y);
+					bottom_right.x	= std::max(bottom_right.x, point.x);
+					bottom_right.y	= std::max(bottom_right.y, point.y);
+					coordinates[0].push_back(point);
 				}
 
-				cv::Mat all_ellipse_raw(cv::Mat::zeros(hsd_image.red_density.size(), CV_8UC1));
-				cv::drawContours(all_ellipse_raw, coordinates, 0, 255, cv::FILLED, 8);
-				hema_mask_info.full_mask += all_ellipse_raw;
+				cv::Rect roi(cv::Point(std::max(top_left.x, 0), std::max(top_left.y, 0)),
+					cv::Point(std::min(bottom_right.x + 1, hsd_image.red_density.cols), std::min(bottom_right.y + 1, hsd_image.red_density.rows)));
+
+				if (roi.area() > 0)
+				{
+					cv::Mat ellipse_mask(cv::Mat::zeros(roi.size(), CV_8UC1));
+					cv::drawContours(ellipse_mask, coordinates, 0, 255, cv::FILLED, 8, cv::noArray(), INT_MAX, cv::Point(-roi.x, -roi.y));
+
+					cv::Mat full_mask_roi(hema_mask_info.full_mask(roi));
+					full_mask_roi += ellipse_mask;
+
+					red_mean.push_back(cv::mean(hsd_image.red_density(roi), ellipse_mask).val[0]);
+					blue_mean.push_back(cv::mean(hsd_image.blue_density(roi), ellipse_mask).val[0]);
+					density_mean.push_back(cv::mean(hsd_image.density(roi), ellipse_mask).val[0]);
+				}
+				else
+				{
+					red_mean.push_back(0);
+					blue_mean.push_back(0);
+					density_mean.push_back(0);
+				}
 
 				contours.push_back(std::move(coordinates[0]));
-				red_mean.push_back(cv::mean(hsd_image.red_density, all_ellipse_raw).val[0]);
-				blue_mean.push_back(cv::mean(hsd_image.blue_density, all_ellipse_raw).val[0]);
-				density_mean.push_back(cv::mean(hsd_image.density, all_ellipse_raw).val[0]);
 			}
 
 			// Initializes the training mask and removes artifacts from it.
@@ -1,6 +1,7 @@
 #ifndef __WSICS_HESTAINING_MASKGENERATION__
 #define __WSICS_HESTAINING_MASKGENERATION__
 
+#include <boost/random/mersenne_twister.hpp>
 #include <opencv2/core/core.hpp>
 #include <opencv2/imgproc/imgproc.hpp>
 #include "../HoughTransform/RandomizedHoughTransform.h"
@@ -59,8 +60,14 @@ namespace WSICS::HE_Staining
 		/// <param name="binary_matrix">A binary matrix where each point signifies part of an object.</param>
 		/// <param name="output_matrix">The matrix to hold the results, aach pixel will be labeled according to the BLOB they belong to.</param>
 		/// <param name="transform_parameters">The parameters used to perform the Hough transform.</param>
+		/// <param name="triplet_detector_parameters">The parameters used to acquire the point triplets.</param>
+		/// <param name="thread_pool">The pool to process the Hough transform windows with, or a nullptr to process them serially.</param>
 		/// <returns>A vector containing the ellipses.</returns>
-		std::vector<HoughTransform::Ellipse> ApplyHoughTransform(const cv::Mat& binary_matrix, cv::Mat& output_matrix, const HoughTransform::RandomizedHoughTransformParameters& transform_parameters);
+		std::vector<HoughTransform::Ellipse> ApplyHoughTransform(const cv::Mat& binary_matrix,
+			cv::Mat& output_matrix,
+			const HoughTransform::RandomizedHoughTransformParameters& transform_parameters,
+			const HoughTransform::WindowedTripletDetectorParameters& triplet_detector_parameters,
+			Misc::ThreadPool* thread_pool);
 
 		/// <summary>
 		/// Performs a blur, canny edge and randomized hough transform in order to detect ellipses on the passed matrix.
@@ -69,13 +76,26 @@ namespace WSICS::HE_Staining
 		/// <param name="blur_sigma">The sigma value for the blur transform.</param>
 		/// <param name="canny_low_threshold">The low threshold used for the canny edge transform.</param>
 		/// <param name="canny_high_threshold">The high threshold used for the canny edge transform.</param>
+		/// <param name="transform_parameters">The parameters used to perform the Hough transform.</param>
+		/// <param name="triplet_detector_parameters">The parameters used to acquire the point triplets.</param>
+		/// <param name="thread_pool">The pool to process the Hough transform windows with, or a nullptr to process them serially.</param>
 		/// <returns>A vector containing the ellipses.</returns>
 		std::vector<HoughTransform::Ellipse> DetectEllipses(
 			const cv::Mat& input_matrix,
 			const uint32_t blur_sigma,
 			const uint32_t canny_low_threshold,
 			const uint32_t canny_high_threshold,
-			const HoughTransform::RandomizedHoughTransformParameters& transform_parameters);
+			const HoughTransform::RandomizedHoughTransformParameters& transform_parameters,
+			const HoughTransform::WindowedTripletDetectorParameters& triplet_detector_parameters,
+			Misc::ThreadPool* thread_pool);
+
+		/// <summary>
+		/// Converts a rotated rectangle, such as the result of cv::fitEllipse, into the ellipse it bounds. The major axis
+		/// is placed along the rotation that the Hematoxylin mask generation applies when drawing the ellipse.
+		/// </summary>
+		/// <param name="box">The rotated rectangle that bounds the ellipse.</param>
+		/// <returns>The corresponding ellipse.</returns>
+		HoughTransform::Ellipse EllipseFromBox(const cv::RotatedRect& box);
 
 		/// <summary>
 		/// Acquires a mean pixel value which is discoverd by selecting the nth element, pointed at by the amount
@@ -116,12 +136,14 @@ namespace WSICS::HE_Staining
 		/// <param name="hsd_image">A HSD format image that corresponds with the Hematoxylin and background masks.</param>
 		/// <param name="background_mask">A mask annotating the background pixels.</param>
 		/// <param name="hema_training_information">The Hematoxylin mask information.</param>
+		/// <param name="generator">The generator used to randomly select the training pixels.</param>
 		/// <param name="eosin_index_percentile">The percentile value, used to select pixels used for the training mask.</param>
 		/// <returns>The Eosin mask and training mask.</returns>
 		EosinMaskInformation GenerateEosinMasks(
 			const HSD::HSD_Model& hsd_image,
 			const cv::Mat& background_mask,
 			const HematoxylinMaskInformation& hema_training_information,
+			boost::mt19937_64& generator,
 			const float eosin_index_percentile = 0.85);
 
 		/// <summary>
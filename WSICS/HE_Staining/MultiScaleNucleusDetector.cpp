@@ -0,0 +1,120 @@
+#include "MultiScaleNucleusDetector.h"
+
+#define _USE_MATH_DEFINES
+#include <algorithm>
+#include <cmath>
+#include <math.h>
+
+#include <opencv2/imgproc/imgproc.hpp>
+
+#include "MaskGeneration.h"
+
+namespace WSICS::HE_Staining
+{
+	MultiScaleNucleusDetector::MultiScaleNucleusDetector(std::unique_ptr<INucleusDetector> coarse_detector,
+		const uint32_t downsample,
+		const bool refine,
+		const uint32_t blur_sigma,
+		const uint32_t canny_low_threshold,
+		const uint32_t canny_high_threshold,
+		const float min_radius,
+		const float max_radius)
+		: m_coarse_detector_(std::move(coarse_detector)),
+		m_downsample_(std::max<uint32_t>(downsample, 1)),
+		m_refine_(refine),
+		m_blur_sigma_(blur_sigma),
+		m_canny_low_threshold_(canny_low_threshold),
+		m_canny_high_threshold_(canny_high_threshold),
+		m_min_radius_(min_radius),
+		m_max_radius_(max_radius)
+	{
+	}
+
+	std::vector<HoughTransform::Ellipse> MultiScaleNucleusDetector::Detect(const cv::Mat& density_matrix)
+	{
+		cv::Mat coarse_matrix;
+		cv::resize(density_matrix, coarse_matrix, cv::Size(std::max(density_matrix.cols / static_cast<int>(m_downsample_), 1), std::max(density_matrix.rows / static_cast<int>(m_downsample_), 1)), 0, 0, cv::INTER_AREA);
+
+		std::vector<HoughTransform::Ellipse> detected_ellipses(m_coarse_detector_->Detect(coarse_matrix));
+
+		// Each downsampled pixel averages a square of full resolution pixels, whose center is offset by half the square.
+		float offset = (m_downsample_ - 1) / 2.0f;
+		for (HoughTransform::Ellipse& ellipse : detected_ellipses)
+		{
+			ellipse.center		= cv::Point2f(ellipse.center.x * m_downsample_ + offset, ellipse.center.y * m_downsample_ + offset);
+			ellipse.major_axis	*= m_downsample_;
+			ellipse.minor_axis	*= m_downsample_;
+		}
+
+		if (m_refine_ && !detected_ellipses.empty())
+		{
+			cv::Mat edge_matrix;
+			density_matrix.copyTo(edge_matrix);
+			MaskGeneration::ApplyBlur(edge_matrix, edge_matrix, m_blur_sigma_);
+			MaskGeneration::ApplyCannyEdge(edge_matrix, edge_matrix, m_canny_low_threshold_, m_canny_high_threshold_);
+
+			for (HoughTransform::Ellipse& ellipse : detected_ellipses)
+			{
+				RefineEllipse_(ellipse, edge_matrix);
+			}
+		}
+
+		return detected_ellipses;
+	}
+
+	void MultiScaleNucleusDetector::RefineEllipse_(HoughTransform::Ellipse& ellipse, const cv::Mat& edge_matrix) const
+	{
+		if (ellipse.minor_axis <= 0)
+		{
+			return;
+		}
+
+		float band			= static_cast<float>(m_downsample_);
+		float reach			= ellipse.major_axis + band;
+		int first_column	= std::max(static_cast<int>(std::floor(ellipse.center.x - reach)), 0);
+		int last_column		= std::min(static_cast<int>(std::ceil(ellipse.center.x + reach)), edge_matrix.cols - 1);
+		int first_row		= std::max(static_cast<int>(std::floor(ellipse.center.y - reach)), 0);
+		int last_row		= std::min(static_cast<int>(std::ceil(ellipse.center.y + reach)), edge_matrix.rows - 1);
+
+		// Projects the edge points onto the axes of the ellipse, in the orientation used by the mask generation, and
+		// gathers those whose distance towards the contour is within the band.
+		float sin_theta = std::sin(ellipse.theta);
+		float cos_theta = std::cos(ellipse.theta);
+		std::vector<cv::Point> contour_points;
+		for (int row = first_row; row <= last_row; ++row)
+		{
+			const unsigned char* edges = edge_matrix.ptr<unsigned char>(row);
+			for (int column = first_column; column <= last_column; ++column)
+			{
+				if (edges[column] == 0)
+				{
+					continue;
+				}
+
+				float x = column - ellipse.center.x;
+				float y = row - ellipse.center.y;
+				float major_projection = (x * cos_theta - y * sin_theta) / ellipse.major_axis;
+				float minor_projection = (x * sin_theta + y * cos_theta) / ellipse.minor_axis;
+				float distance = std::sqrt(major_projection * major_projection + minor_projection * minor_projection);
+				if (std::fabs(distance - 1) * ellipse.minor_axis <= band)
+				{
+					contour_points.push_back(cv::Point(column, row));
+				}
+			}
+		}
+
+		// Requires a quarter of the perimeter to be covered by edges, in order to prevent fits onto partial arcs.
+		double perimeter = M_PI * (ellipse.major_axis + ellipse.minor_axis);
+		if (contour_points.size() < std::max<size_t>(5, static_cast<size_t>(perimeter / 4)))
+		{
+			return;
+		}
+
+		HoughTransform::Ellipse refined_ellipse(MaskGeneration::EllipseFromBox(cv::fitEllipse(contour_points)));
+		float shift = std::hypot(refined_ellipse.center.x - ellipse.center.x, refined_ellipse.center.y - ellipse.center.y);
+		if (refined_ellipse.minor_axis >= m_min_radius_ && refined_ellipse.major_axis <= m_max_radius_ && shift <= band)
+		{
+			ellipse = refined_ellipse;
+		}
+	}
+}
@@ -0,0 +1,67 @@
+#ifndef __WSICS_HESTAINING_MULTISCALENUCLEUSDETECTOR__
+#define __WSICS_HESTAINING_MULTISCALENUCLEUSDETECTOR__
+
+#include <memory>
+
+#include "INucleusDetector.h"
+
+namespace WSICS::HE_Staining
+{
+	/// <summary>
+	/// Detects nuclei on a downsampled copy of the density, through a detector whose parameters have been scaled
+	/// to match, and maps the ellipses back onto the full resolution.
+	///
+	/// Downsampling by a factor of two quarters the amount of pixels and edge points, which reduces the cost of
+	/// the detection accordingly. The coarse ellipses can optionally be refined by fitting an ellipse onto the full
+	/// resolution edge points that surround them. Each fit only inspects the bounding box of its ellipse.
+	/// </summary>
+	class MultiScaleNucleusDetector : public INucleusDetector
+	{
+		public:
+			/// <summary>
+			/// Constructs the detector.
+			/// </summary>
+			/// <param name="coarse_detector">The detector to apply onto the downsampled density.</param>
+			/// <param name="downsample">The factor by which the density is downsampled.</param>
+			/// <param name="refine">Whether or not the ellipses are refined on the full resolution edges.</param>
+			/// <param name="blur_sigma">The sigma value for the blur transform applied before the full resolution edge detection.</param>
+			/// <param name="canny_low_threshold">The low threshold used for the full resolution canny edge transform.</param>
+			/// <param name="canny_high_threshold">The high threshold used for the full resolution canny edge transform.</param>
+			/// <param name="min_radius">The smallest radius a refined nucleus may have.</param>
+			/// <param name="max_radius">The largest radius a refined nucleus may have.</param>
+			MultiScaleNucleusDetector(std::unique_ptr<INucleusDetector> coarse_detector,
+				const uint32_t downsample,
+				const bool refine,
+				const uint32_t blur_sigma,
+				const uint32_t canny_low_threshold,
+				const uint32_t canny_high_threshold,
+				const float min_radius,
+				const float max_radius);
+
+			/// <summary>
+			/// Detects the nuclei within the density matrix.
+			/// </summary>
+			/// <param name="density_matrix">The density channel of a HSD model.</param>
+			/// <returns>An ellipse for each detected nucleus.</returns>
+			std::vector<HoughTransform::Ellipse> Detect(const cv::Mat& density_matrix);
+
+		private:
+			std::unique_ptr<INucleusDetector>	m_coarse_detector_;
+			uint32_t							m_downsample_;
+			bool								m_refine_;
+			uint32_t							m_blur_sigma_;
+			uint32_t							m_canny_low_threshold_;
+			uint32_t							m_canny_high_threshold_;
+			float								m_min_radius_;
+			float								m_max_radius_;
+
+			/// <summary>
+			/// Fits an ellipse onto the edge points that lie within a downsampled pixel of the coarse ellipse contour.
+			/// The ellipse is left untouched if too few edge points are found, or if the fit strays from the coarse ellipse.
+			/// </summary>
+			/// <param name="ellipse">The coarse ellipse, mapped onto the full resolution.</param>
+			/// <param name="edge_matrix">The full resolution edges.</param>
+			void RefineEllipse_(HoughTransform::Ellipse& ellipse, const cv::Mat& edge_matrix) const;
+	};
+}
+#endif // __WSICS_HESTAINING_MULTISCALENUCLEUSDETECTOR__
@@ -0,0 +1,139 @@
+#include "TileTriage.h"
+
+#define _USE_MATH_DEFINES
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <vector>
+
+#include <opencv2/imgproc/imgproc.hpp>
+
+#include "MaskGeneration.h"
+
+namespace WSICS::HE_Staining::TileTriage
+{
+	namespace
+	{
+		/// <summary>
+		/// Maps each intensity to its optical density, using the same clamping as the HSD model.
+		/// </summary>
+		const std::array<float, 256>& GetDensityTable_(void)
+		{
+			static const std::array<float, 256> table([]()
+			{
+				std::array<float, 256> densities;
+				for (size_t intensity = 0; intensity < 256; ++intensity)
+				{
+					densities[intensity] = -std::log(static_cast<float>(std::min<size_t>(std::max<size_t>(intensity, 1), 254)) / 255.0f);
+				}
+				return densities;
+			}());
+
+			return table;
+		}
+	}
+
+	TileTriageParameters GetStandardParameters(void)
+	{
+		TileTriageParameters parameters;
+		parameters.downsample			= 4;
+		parameters.min_tissue_pixels	= 0;
+		parameters.max_ink_pixels		= 15000;
+		parameters.min_nuclei			= 0;
+		parameters.min_nucleus_radius	= 0;
+		parameters.edge_fraction		= 0.5;
+		parameters.min_stain_range		= 0.05f;
+		return parameters;
+	}
+
+	TileTriageResult Evaluate(const cv::Mat& rgb_tile, const TileTriageParameters& parameters)
+	{
+		const uint32_t downsample = std::max<uint32_t>(parameters.downsample, 1);
+		cv::Mat small_tile;
+		cv::resize(rgb_tile, small_tile, cv::Size(std::max(rgb_tile.cols / static_cast<int>(downsample), 1), std::max(rgb_tile.rows / static_cast<int>(downsample), 1)), 0, 0, cv::INTER_AREA);
+
+		// Each downsampled pixel represents this many full resolution pixels.
+		const double pixel_weight = (static_cast<double>(rgb_tile.cols) * rgb_tile.rows) / (static_cast<double>(small_tile.cols) * small_tile.rows);
+
+		const std::array<float, 256>& density_table(GetDensityTable_());
+		cv::Mat density(small_tile.size(), CV_32FC1);
+		std::vector<float> tissue_densities;
+		tissue_densities.reserve(small_tile.total());
+		size_t ink_pixels = 0;
+
+		for (int row = 0; row < small_tile.rows; ++row)
+		{
+			const unsigned char* rgb = small_tile.ptr<unsigned char>(row);
+			float* density_row = density.ptr<float>(row);
+			for (int column = 0; column < small_tile.cols; ++column, rgb += 3)
+			{
+				const float red		= density_table[rgb[0]];
+				const float green	= density_table[rgb[1]];
+				const float blue	= density_table[rgb[2]];
+				const float mean	= (red + green + blue) / 3;
+				density_row[column] = mean;
+
+				// Applies the criteria of the background mask and the ink check of the Hematoxylin mask generation.
+				bool background = (mean <= 0.24f && red <= 0.22f && green <= 0.22f && blue <= 0.22f) || mean > 5.5f;
+				if (!background)
+				{
+					tissue_densities.push_back(mean);
+				}
+				if (red - green > 0.5f && green > 1.0f)
+				{
+					++ink_pixels;
+				}
+			}
+		}
+
+		if (tissue_densities.size() * pixel_weight < parameters.min_tissue_pixels || tissue_densities.empty())
+		{
+			return TRIAGE_INSUFFICIENT_TISSUE;
+		}
+		if (ink_pixels * pixel_weight >= parameters.max_ink_pixels)
+		{
+			return TRIAGE_INK;
+		}
+
+		// The downsampling acts as the blur that precedes the edge detection, after which each nucleus is expected
+		// to contribute a part of its perimeter in edge pixels.
+		if (parameters.min_nuclei > 0)
+		{
+			cv::Mat edges;
+			MaskGeneration::ApplyCannyEdge(density, edges, 45, 80);
+
+			double perimeter = 2 * M_PI * std::max(parameters.min_nucleus_radius / downsample, 1.0);
+			if (cv::countNonZero(edges) < parameters.min_nuclei * perimeter * parameters.edge_fraction)
+			{
+				return TRIAGE_FEW_NUCLEI;
+			}
+		}
+
+		size_t low_index	= (tissue_densities.size() - 1) * 5 / 100;
+		size_t high_index	= (tissue_densities.size() - 1) * 95 / 100;
+		std::nth_element(tissue_densities.begin(), tissue_densities.begin() + low_index, tissue_densities.end());
+		float low_density = tissue_densities[low_index];
+		std::nth_element(tissue_densities.begin() + low_index, tissue_densities.begin() + high_index, tissue_densities.end());
+		float high_density = tissue_densities[high_index];
+
+		if (high_density - low_density < parameters.min_stain_range)
+		{
+			return TRIAGE_LOW_STAIN_RANGE;
+		}
+
+		return TRIAGE_ACCEPTED;
+	}
+
+	std::string GetResultName(const TileTriageResult result)
+	{
+		switch (result)
+		{
+			case TRIAGE_ACCEPTED:				return "accepted";
+			case TRIAGE_INSUFFICIENT_TISSUE:	return "insufficient tissue";
+			case TRIAGE_INK:					return "ink or artifacts";
+			case TRIAGE_FEW_NUCLEI:				return "too few nuclei";
+			case TRIAGE_LOW_STAIN_RANGE:		return "low stain range";
+			default:							return "unknown";
+		}
+	}
+}
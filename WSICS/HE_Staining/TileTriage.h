@@ -0,0 +1,69 @@
+#ifndef __WSICS_HESTAINING_TILETRIAGE__
+#define __WSICS_HESTAINING_TILETRIAGE__
+
+#include <string>
+
+#include <opencv2/core/core.hpp>
+
+namespace WSICS::HE_Staining
+{
+	/// <summary>
+	/// Holds the parameters for the tile triage. The pixel counts are expressed in full resolution pixels,
+	/// which are estimated by scaling the counts on the downsampled tile.
+	/// </summary>
+	struct TileTriageParameters
+	{
+		/// <summary>The factor by which the tile is downsampled before the checks are performed.</summary>
+		uint32_t	downsample;
+		/// <summary>The minimum amount of tissue pixels, below which the stain masks can't provide enough samples.</summary>
+		double		min_tissue_pixels;
+		/// <summary>The amount of ink pixels at which the tile is rejected.</summary>
+		double		max_ink_pixels;
+		/// <summary>The minimum amount of nuclei the ellipse detection has to find, a value of zero or lower disables the check.</summary>
+		double		min_nuclei;
+		/// <summary>The smallest radius of a nucleus, in full resolution pixels.</summary>
+		double		min_nucleus_radius;
+		/// <summary>The fraction of the nuclei perimeters that is expected to result in edge pixels.</summary>
+		double		edge_fraction;
+		/// <summary>The minimum spread between the 5th and 95th percentile of the tissue density.</summary>
+		float		min_stain_range;
+	};
+
+	/// <summary>
+	/// Describes the outcome of the triage, with each rejection listing its reason.
+	/// </summary>
+	enum TileTriageResult { TRIAGE_ACCEPTED, TRIAGE_INSUFFICIENT_TISSUE, TRIAGE_INK, TRIAGE_FEW_NUCLEI, TRIAGE_LOW_STAIN_RANGE, TRIAGE_RESULT_COUNT };
+
+	/// <summary>
+	/// Performs a set of cheap checks on a downsampled copy of a tile, which reject tiles that cannot pass
+	/// the stain mask generation. This avoids the creation of a full resolution HSD model and the Hough
+	/// transform for such tiles.
+	///
+	/// The thresholds are conservative approximations of the criteria applied by the mask generation, which
+	/// itself still applies the exact criteria to every accepted tile.
+	/// </summary>
+	namespace TileTriage
+	{
+		/// <summary>
+		/// Returns the standard parameters, which mirror the thresholds of the stain mask generation.
+		/// </summary>
+		/// <returns>The standard parameters.</returns>
+		TileTriageParameters GetStandardParameters(void);
+
+		/// <summary>
+		/// Evaluates a tile.
+		/// </summary>
+		/// <param name="rgb_tile">A CV_8UC3 matrix with the channels in RGB order.</param>
+		/// <param name="parameters">The parameters to apply.</param>
+		/// <returns>Whether the tile was accepted, or the reason for its rejection.</returns>
+		TileTriageResult Evaluate(const cv::Mat& rgb_tile, const TileTriageParameters& parameters);
+
+		/// <summary>
+		/// Returns a readable description of a triage result.
+		/// </summary>
+		/// <param name="result">The result to describe.</param>
+		/// <returns>The description of the result.</returns>
+		std::string GetResultName(const TileTriageResult result);
+	}
+}
+#endif // __WSICS_HESTAINING_TILETRIAGE__
@@ -4,26 +4,27 @@ namespace WSICS::HSD::BackgroundMask
 {
 	cv::Mat CreateBackgroundMask(const HSD_Model& hsd_image, const float global_threshold, const float channel_threshold)
 	{
-		// Creates empty masks.
-		cv::Mat density_mask		= cv::Mat::zeros(hsd_image.density.size(), CV_8UC1);
-		cv::Mat red_density_mask	= density_mask;
-		cv::Mat green_density_mask	= density_mask;
-		cv::Mat blue_density_mask	= density_mask;
-		cv::Mat dark_density_mask	= density_mask;
+		cv::Mat background_mask(hsd_image.density.size(), CV_8UC1);
 
-		// Calculates the masks for the density and each channel.
-		cv::threshold(hsd_image.density, density_mask, global_threshold, 1, 1);
-		cv::threshold(hsd_image.red_density, red_density_mask, channel_threshold, 1, 1);
-		cv::threshold(hsd_image.green_density, green_density_mask, channel_threshold, 1, 1);
-		cv::threshold(hsd_image.blue_density, blue_density_mask, channel_threshold, 1, 1);
-
-		// Considers pure black pixels as background.
-		cv::threshold(hsd_image.density, dark_density_mask, 5.5, 1, 1);
-		dark_density_mask = 1 - dark_density_mask;
+		// Evaluates the density and each channel in a single pass. Pixels whose density and channels all lie below
+		// the thresholds are background, as are pure black pixels. The comparisons are negated, which handles NaN
+		// values in the same manner as the inverted binary thresholds that were previously applied per channel.
+		for (int row = 0; row < background_mask.rows; ++row)
+		{
+			const float* density		= hsd_image.density.ptr<float>(row);
+			const float* red_density	= hsd_image.red_density.ptr<float>(row);
+			const float* green_density	= hsd_image.green_density.ptr<float>(row);
+			const float* blue_density	= hsd_image.blue_density.ptr<float>(row);
+			unsigned char* background	= background_mask.ptr<unsigned char>(row);
 
-		// Creates the background mask object and returns it.
-		cv::Mat background_mask(std::move(blue_density_mask.mul(green_density_mask.mul(red_density_mask.mul(density_mask))) + dark_density_mask));
-		background_mask.convertTo(background_mask, CV_8UC1);
+			for (int column = 0; column < background_mask.cols; ++column)
+			{
+				bool faint	= !(density[column] > global_threshold) & !(red_density[column] > channel_threshold) &
+							  !(green_density[column] > channel_threshold) & !(blue_density[column] > channel_threshold);
+				bool dark	= density[column] > 5.5f;
+				background[column] = static_cast<unsigned char>(faint | dark);
+			}
+		}
 
 		return background_mask;
 	}
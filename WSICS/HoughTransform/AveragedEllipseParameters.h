@@ -6,7 +6,7 @@
 namespace WSICS::HoughTransform
 {
 	/// <summary>
-	/// A container/node class for the TreeAccumulator class containing an ellipse its parameters.
+	/// A container/node class for the GridAccumulator class containing an ellipse its parameters.
 	/// </summary>
     class AveragedEllipseParameters
     {
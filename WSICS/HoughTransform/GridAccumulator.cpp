@@ -0,0 +1,114 @@
+#include "GridAccumulator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace WSICS::HoughTransform
+{
+	GridAccumulator::GridAccumulator(const float axis_threshold, const float location_threshold, const size_t count_threshold)
+		: m_axis_threshold_(axis_threshold), m_location_threshold_(location_threshold), m_count_threshold_(count_threshold), m_cell_size_(location_threshold * 1.001)
+	{
+	}
+
+	void GridAccumulator::Clear(void)
+	{
+		m_averaged_centers_.clear();
+		m_grid_.clear();
+	}
+
+	size_t GridAccumulator::AddEllipse(Ellipse& ellipse)
+	{
+		if (std::isnan(ellipse.theta) || std::isnan(ellipse.major_axis) || std::isnan(ellipse.minor_axis))
+		{
+			return 0;
+		}
+
+		// Without a positive threshold or a finite center, no ellipse is ever close enough to an existing cell.
+		if (m_location_threshold_ <= 0 || !std::isfinite(ellipse.center.x) || !std::isfinite(ellipse.center.y))
+		{
+			m_averaged_centers_.push_back(LocationCell(ellipse, m_axis_threshold_));
+			return 1;
+		}
+
+		double squared_threshold = static_cast<double>(m_location_threshold_) * m_location_threshold_;
+		uint32_t selected_cell = std::numeric_limits<uint32_t>::max();
+		for (int32_t y_offset = -1; y_offset <= 1; ++y_offset)
+		{
+			for (int32_t x_offset = -1; x_offset <= 1; ++x_offset)
+			{
+				auto grid_cell = m_grid_.find(GetGridKey_(ellipse.center, x_offset, y_offset));
+				if (grid_cell == m_grid_.end())
+				{
+					continue;
+				}
+
+				for (uint32_t cell_index : grid_cell->second)
+				{
+					float x = ellipse.center.x - m_averaged_centers_[cell_index].GetCenter().x;
+					float y = ellipse.center.y - m_averaged_centers_[cell_index].GetCenter().y;
+
+					if (cell_index < selected_cell && static_cast<double>(x) * x + static_cast<double>(y) * y < squared_threshold)
+					{
+						selected_cell = cell_index;
+					}
+				}
+			}
+		}
+
+		if (selected_cell != std::numeric_limits<uint32_t>::max())
+		{
+			uint64_t previous_key = GetGridKey_(m_averaged_centers_[selected_cell].GetCenter());
+			size_t count = m_averaged_centers_[selected_cell].Add(ellipse);
+			UpdateGridCell_(selected_cell, previous_key);
+			return count;
+		}
+
+		m_averaged_centers_.push_back(LocationCell(ellipse, m_axis_threshold_));
+		m_grid_[GetGridKey_(ellipse.center)].push_back(static_cast<uint32_t>(m_averaged_centers_.size() - 1));
+		return 1;
+	}
+
+	std::vector<Ellipse> GridAccumulator::Accumulate(void)
+	{
+		std::vector<Ellipse> ellipses;
+
+		for (LocationCell& cell : m_averaged_centers_)
+		{
+			if (cell.GetBestAveragedEllipseParameters().GetCount() >= m_count_threshold_)
+			{
+				AveragedEllipseParameters::AveragedEllipseInformation subnode_parameters(cell.GetBestAveragedEllipseParameters().GetEllipseInformation());
+				ellipses.push_back(Ellipse(cell.GetCenter(), subnode_parameters.major_axis, subnode_parameters.minor_axis, subnode_parameters.theta));
+			}
+		}
+
+		return ellipses;
+	}
+
+	uint64_t GridAccumulator::GetGridKey_(const cv::Point2f& point, const int32_t x_offset, const int32_t y_offset) const
+	{
+		// Clamping merges the outermost cells, which keeps the cast defined for the far away centers of degenerate triplets.
+		auto clamp_cell = [](const double cell) { return static_cast<int32_t>(std::isnan(cell) ? 0.0 : std::min(std::max(cell, -2.0e9), 2.0e9)); };
+		int32_t x = clamp_cell(std::floor(point.x / m_cell_size_)) + x_offset;
+		int32_t y = clamp_cell(std::floor(point.y / m_cell_size_)) + y_offset;
+		return (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32) | static_cast<uint32_t>(y);
+	}
+
+	void GridAccumulator::UpdateGridCell_(const uint32_t cell_index, const uint64_t previous_key)
+	{
+		uint64_t current_key = GetGridKey_(m_averaged_centers_[cell_index].GetCenter());
+		if (current_key == previous_key)
+		{
+			return;
+		}
+
+		std::vector<uint32_t>& previous_cell(m_grid_[previous_key]);
+		previous_cell.erase(std::find(previous_cell.begin(), previous_cell.end(), cell_index));
+		if (previous_cell.empty())
+		{
+			m_grid_.erase(previous_key);
+		}
+
+		m_grid_[current_key].push_back(cell_index);
+	}
+}
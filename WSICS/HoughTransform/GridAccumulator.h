@@ -0,0 +1,71 @@
+#ifndef __WSICS_HOUGHTRANSFORM_GRIDACCUMULATOR__
+#define __WSICS_HOUGHTRANSFORM_GRIDACCUMULATOR__
+
+#include <unordered_map>
+
+#include "IAccumulator.h"
+#include "LocationCell.h"
+
+namespace WSICS::HoughTransform
+{
+	/// <summary>
+	///	An implementation of the IAccumulator interface that hashes the location cells onto a uniform grid.
+	///
+	/// The grid cells are slightly wider than the location threshold, which means that any location cell close
+	/// enough to an ellipse resides within the 3x3 grid cells surrounding it. The location cells themselves
+	/// are kept in a single vector in order of creation, and an ellipse is added to the first created cell
+	/// that lies within the threshold. Which results in the same ellipses as a linear scan over all cells.
+	/// </summary>
+	class GridAccumulator : public IAccumulator
+	{
+		public:
+			/// <summary>
+			/// Default constructor for the GridAccumulator.
+			/// </summary>
+			/// <param name="axis_threshold">The threshold applied to axis values.</param>
+			/// <param name="location_threshold">The threshold applied to location values.</param>
+			/// <param name="count_threshold">The threshold applied to the count.</param>
+			GridAccumulator(const float axis_threshold, const float location_threshold, const size_t count_threshold);
+
+			/// <summary>
+			/// Adds an ellipse to the accumulator, this means finding a suitable location within
+			/// the accumulator and averaging it with previously inserted ellipses.
+			///	</summary>
+			/// <param name="ellipse">The ellipse to be added and averaged.</param>
+			/// <returns>The amount of ellipses that the added ellipse was averaged with + 1.</returns>
+			size_t AddEllipse(Ellipse& ellipse);
+			/// <summary>
+			/// Clears the accumulator.
+			/// </summary>
+			void Clear(void);
+			/// <summary>
+			/// Accumulates all the ellipses in the accumulator that occur more than a certain threshold.
+			/// </summary>
+			/// <returns>A list of ellipses that has a count higher than a certain threshold.</returns>
+			std::vector<Ellipse> Accumulate(void);
+
+		private:
+			float													m_axis_threshold_;
+			float													m_location_threshold_;
+			size_t													m_count_threshold_;
+			double													m_cell_size_;
+			std::vector<LocationCell>								m_averaged_centers_;
+			std::unordered_map<uint64_t, std::vector<uint32_t>>	m_grid_;
+
+			/// <summary>
+			/// Returns the key of the grid cell a point falls into.
+			/// </summary>
+			/// <param name="point">The point to acquire the grid cell for.</param>
+			/// <param name="x_offset">The horizontal offset in grid cells.</param>
+			/// <param name="y_offset">The vertical offset in grid cells.</param>
+			/// <returns>The key of the grid cell.</returns>
+			uint64_t GetGridKey_(const cv::Point2f& point, const int32_t x_offset = 0, const int32_t y_offset = 0) const;
+			/// <summary>
+			/// Moves a location cell towards another grid cell, after its center has been altered.
+			/// </summary>
+			/// <param name="cell_index">The index of the location cell.</param>
+			/// <param name="previous_key">The key of the grid cell it was listed under.</param>
+			void UpdateGridCell_(const uint32_t cell_index, const uint64_t previous_key);
+	};
+}
+#endif // __WSICS_HOUGHTRANSFORM_GRIDACCUMULATOR__
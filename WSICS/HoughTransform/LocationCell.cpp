@@ -1,14 +1,19 @@
 #include "LocationCell.h"
 
+#include <algorithm>
 #include <cmath>
+#include <limits>
 
 namespace WSICS::HoughTransform
 {
-	LocationCell::LocationCell(const Ellipse& ellipse) : m_averaged_ellipses_({ AveragedEllipseParameters(ellipse) }), m_best_averaged_ellipse_(m_averaged_ellipses_[0]), m_center_(ellipse.center), m_count_(1)
+	LocationCell::LocationCell(const Ellipse& ellipse, const float axis_threshold)
+		: m_axis_threshold_(axis_threshold), m_bucket_width_(axis_threshold * 1.001), m_averaged_ellipses_({ AveragedEllipseParameters(ellipse) }),
+		m_best_averaged_ellipse_(0), m_center_(ellipse.center), m_count_(1)
     {
+		UpdateAxisBucket_(0, std::numeric_limits<float>::quiet_NaN());
     }
 
-	size_t LocationCell::Add(Ellipse& ellipse, const float threshold)
+	size_t LocationCell::Add(Ellipse& ellipse)
     {
 		m_center_.x = (m_center_.x * m_count_ + ellipse.center.x) / static_cast<float>(m_count_ + 1);
 		m_center_.y = (m_center_.y * m_count_ + ellipse.center.y) / static_cast<float>(m_count_ + 1);
@@ -17,25 +22,45 @@ namespace WSICS::HoughTransform
 
 		++m_count_;
 
-		for (AveragedEllipseParameters& averaged_ellipse : m_averaged_ellipses_)
+		// Without a positive threshold or a finite major axis, the ellipse is never close enough to existing parameters.
+		uint32_t selected_parameters = std::numeric_limits<uint32_t>::max();
+		if (m_axis_threshold_ > 0 && std::isfinite(ellipse.major_axis))
 		{
-			AveragedEllipseParameters::AveragedEllipseInformation averaged_ellipse_info = averaged_ellipse.GetEllipseInformation();
-
-			float difference_major_axis = ellipse.major_axis - averaged_ellipse_info.major_axis;
-			float difference_minor_axis = ellipse.minor_axis - averaged_ellipse_info.minor_axis;
-
-			if (std::fabs(difference_major_axis) < threshold && std::fabs(difference_minor_axis) < threshold)
+			int64_t bucket = GetAxisBucket_(ellipse.major_axis);
+			for (auto entry = std::lower_bound(m_axis_buckets_.begin(), m_axis_buckets_.end(), std::make_pair(bucket - 1, static_cast<uint32_t>(0)));
+				entry != m_axis_buckets_.end() && entry->first <= bucket + 1; ++entry)
 			{
-				size_t count = averaged_ellipse.Add(ellipse);
-				if (averaged_ellipse.GetCount() > m_best_averaged_ellipse_.GetCount())
+				if (entry->second < selected_parameters)
 				{
-					m_best_averaged_ellipse_ = averaged_ellipse;
+					AveragedEllipseParameters::AveragedEllipseInformation averaged_ellipse_info = m_averaged_ellipses_[entry->second].GetEllipseInformation();
+
+					float difference_major_axis = ellipse.major_axis - averaged_ellipse_info.major_axis;
+					float difference_minor_axis = ellipse.minor_axis - averaged_ellipse_info.minor_axis;
+
+					if (std::fabs(difference_major_axis) < m_axis_threshold_ && std::fabs(difference_minor_axis) < m_axis_threshold_)
+					{
+						selected_parameters = entry->second;
+					}
 				}
-				return count;
 			}
 		}
 
+		if (selected_parameters != std::numeric_limits<uint32_t>::max())
+		{
+			AveragedEllipseParameters& averaged_ellipse(m_averaged_ellipses_[selected_parameters]);
+			float previous_major_axis = averaged_ellipse.GetEllipseInformation().major_axis;
+			size_t count = averaged_ellipse.Add(ellipse);
+			UpdateAxisBucket_(selected_parameters, previous_major_axis);
+
+			if (averaged_ellipse.GetCount() > m_averaged_ellipses_[m_best_averaged_ellipse_].GetCount())
+			{
+				m_best_averaged_ellipse_ = selected_parameters;
+			}
+			return count;
+		}
+
 		m_averaged_ellipses_.push_back(AveragedEllipseParameters(ellipse));
+		UpdateAxisBucket_(static_cast<uint32_t>(m_averaged_ellipses_.size() - 1), std::numeric_limits<float>::quiet_NaN());
 
 		return 1;
     }
@@ -47,7 +72,7 @@ namespace WSICS::HoughTransform
 
 	const AveragedEllipseParameters& LocationCell::GetBestAveragedEllipseParameters(void) const
 	{
-		return m_best_averaged_ellipse_;
+		return m_averaged_ellipses_[m_best_averaged_ellipse_];
 	}
 
 	size_t LocationCell::GetCount(void) const
@@ -59,4 +84,37 @@ namespace WSICS::HoughTransform
 	{
 		return m_center_;
 	}
+
+	int64_t LocationCell::GetAxisBucket_(const float major_axis) const
+	{
+		// Clamping merges the outermost buckets, which only adds candidates to the inspection.
+		double bucket = std::floor(major_axis / m_bucket_width_);
+		return std::isnan(bucket) ? 0 : static_cast<int64_t>(std::min(std::max(bucket, -4.0e18), 4.0e18));
+	}
+
+	void LocationCell::UpdateAxisBucket_(const uint32_t parameters_index, const float previous_major_axis)
+	{
+		if (m_axis_threshold_ <= 0)
+		{
+			return;
+		}
+
+		float current_major_axis = m_averaged_ellipses_[parameters_index].GetEllipseInformation().major_axis;
+		bool previously_bucketed = std::isfinite(previous_major_axis);
+		bool currently_bucketed = std::isfinite(current_major_axis);
+		if (previously_bucketed && currently_bucketed && GetAxisBucket_(previous_major_axis) == GetAxisBucket_(current_major_axis))
+		{
+			return;
+		}
+
+		if (previously_bucketed)
+		{
+			m_axis_buckets_.erase(std::lower_bound(m_axis_buckets_.begin(), m_axis_buckets_.end(), std::make_pair(GetAxisBucket_(previous_major_axis), parameters_index)));
+		}
+		if (currently_bucketed)
+		{
+			std::pair<int64_t, uint32_t> entry(GetAxisBucket_(current_major_axis), parameters_index);
+			m_axis_buckets_.insert(std::lower_bound(m_axis_buckets_.begin(), m_axis_buckets_.end(), entry), entry);
+		}
+	}
 }
\ No newline at end of file
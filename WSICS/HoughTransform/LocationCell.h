@@ -1,6 +1,7 @@
 #ifndef __WSICS_HOUGHTRANSFORM_LOCATIONCELL__
 #define __WSICS_HOUGHTRANSFORM_LOCATIONCELL__
 
+#include <utility>
 #include <vector>
 
 #include "Ellipse.h"
@@ -9,8 +10,13 @@
 namespace WSICS::HoughTransform
 {
 	/// <summary>
-	/// A container/node class for the TreeAccumulator class containing an ellipse it's location
-	/// and a forward linked list that consist of AveragedEllipseParameters.
+	/// A container/node class for the GridAccumulator class containing an ellipse it's location
+	/// and the AveragedEllipseParameters that were accumulated at it.
+	///
+	/// The parameters are kept in a single vector in order of creation, and are additionally bucketed on their major
+	/// axis. The buckets are slightly wider than the axis threshold, which means that only the parameters within the
+	/// surrounding three buckets require inspection. An ellipse is added to the first created parameters within the
+	/// threshold, which matches a linear scan over all parameters.
 	/// </summary>
     class LocationCell
     {
@@ -19,20 +25,20 @@ namespace WSICS::HoughTransform
 			/// The default constructor for the LocationCell.
 			/// </summary>
 			/// <param name="ellipse">The initial ellipse to add.</param>
-			LocationCell(const Ellipse& ellipse);
+			/// <param name="axis_threshold">The threshold used for determining which averaged ellipse the parameters go in.</param>
+			LocationCell(const Ellipse& ellipse, const float axis_threshold);
 
 			/// <summary>
 			/// Adds an ellipse to this cell, and averages it's parameters with the existing one.
 			/// </summary>
 			/// <param name="ellipse">The ellipse to be added.</param>
-			/// <param name="threshold">The threshold used for determining which averaged ellipse the parameters go in.</param>
 			/// <returns>The new count of the averaged ellipse  that the parameters where added to.</returns>
-			size_t Add(Ellipse& ellipse, const float threshold);
+			size_t Add(Ellipse& ellipse);
 
 			/// <summary>
-			/// Returns a reference to the linked list of averaged ellipse parameters.
+			/// Returns a reference to the averaged ellipse parameters, in order of creation.
 			/// </summary>
-			/// <returns>A reference to the linked list of averaged ellipse parameters.</returns>
+			/// <returns>A reference to the averaged ellipse parameters.</returns>
 			const std::vector<AveragedEllipseParameters>& GetAveragedEllipseParameterss(void) const;
 			/// <summary>
 			/// Returns the averaged ellipse parameters with the highest count.
@@ -51,10 +57,27 @@ namespace WSICS::HoughTransform
 			const cv::Point2f& GetCenter(void) const;
 
 		private:
-			std::vector<AveragedEllipseParameters>	m_averaged_ellipses_;
-			AveragedEllipseParameters				m_best_averaged_ellipse_;
-			cv::Point2f								m_center_;
-			size_t									m_count_;
+			float										m_axis_threshold_;
+			double										m_bucket_width_;
+			std::vector<AveragedEllipseParameters>		m_averaged_ellipses_;
+			std::vector<std::pair<int64_t, uint32_t>>	m_axis_buckets_;
+			size_t										m_best_averaged_ellipse_;
+			cv::Point2f									m_center_;
+			size_t										m_count_;
+
+			/// <summary>
+			/// Returns the bucket a major axis falls into.
+			/// </summary>
+			/// <param name="major_axis">The finite major axis to acquire the bucket for.</param>
+			/// <returns>The bucket of the major axis.</returns>
+			int64_t GetAxisBucket_(const float major_axis) const;
+			/// <summary>
+			/// Moves the averaged parameters towards another bucket, after their major axis has been altered.
+			/// Parameters with a non-finite major axis can't lie within the threshold, and aren't bucketed.
+			/// </summary>
+			/// <param name="parameters_index">The index of the averaged parameters.</param>
+			/// <param name="previous_major_axis">The major axis they were bucketed under, or NaN if they weren't bucketed.</param>
+			void UpdateAxisBucket_(const uint32_t parameters_index, const float previous_major_axis);
     };
 }
 #endif // __WSICS_HOUGHTRANSFORM_LOCATIONCELL__
@@ -2,6 +2,18 @@
 
 namespace WSICS::HoughTransform
 {
+    //******************************************************************************
+    // Constructors / Destructors
+    //******************************************************************************
+	PointCollection::PointCollection(void) : complete(false)
+	{
+	}
+
+	PointCollection::PointCollection(const std::pair<cv::Point2f, Line>& a, const std::pair<cv::Point2f, Line>& b, const std::pair<cv::Point2f, Line>& c)
+		: points({ a, b, c }), complete(true)
+	{
+	}
+
     //******************************************************************************
     // Public Operators
     //******************************************************************************
@@ -1,16 +1,33 @@
 #ifndef __WSICS_HOUGHTRANSFORM_POINTTRIPLET__
 #define __WSICS_HOUGHTRANSFORM_POINTTRIPLET__
 
+#include <array>
+
 #include "Line.h"
 
 namespace WSICS::HoughTransform
 {
 	/// <summary>
-	/// A container class containing three points and three tangents running through these points.
+	/// A container class containing three points and three tangents running through these points. The points are
+	/// stored inline, which allows triplets to be created and copied without allocations.
 	/// </summary>
     struct PointCollection
     {
-		std::vector<std::pair<cv::Point2f, Line>> points;
+		std::array<std::pair<cv::Point2f, Line>, 3>	points;
+		/// <summary>Whether or not the collection holds a triplet, which is false if no triplet could be acquired.</summary>
+		bool										complete;
+
+		/// <summary>
+		/// Constructs an incomplete collection.
+		/// </summary>
+		PointCollection(void);
+		/// <summary>
+		/// Constructs a collection holding a triplet.
+		/// </summary>
+		/// <param name="a">The first point and its tangent.</param>
+		/// <param name="b">The second point and its tangent.</param>
+		/// <param name="c">The third point and its tangent.</param>
+		PointCollection(const std::pair<cv::Point2f, Line>& a, const std::pair<cv::Point2f, Line>& b, const std::pair<cv::Point2f, Line>& c);
 
 		/// <summary>
 		/// Subtracts a point from the entire collection of points.
@@ -0,0 +1,138 @@
+#include "PointIndex.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace WSICS::HoughTransform
+{
+	PointIndex::PointIndex(void) : m_origin_(0, 0), m_cell_size_(1), m_columns_(0), m_rows_(0)
+	{
+	}
+
+	void PointIndex::Build(const std::vector<size_t>& labels, const std::unordered_map<size_t, const WSICS::BLOB_Operations::BLOB*>& labeled_blobs, const float cell_size, std::unordered_map<size_t, std::vector<uint32_t>>& labeled_ids)
+	{
+		Clear();
+		labeled_ids.clear();
+		m_cell_size_ = std::max(cell_size, 1.0f);
+
+		// Spans the grid over the bounding box of the points.
+		cv::Point2f minimum(std::numeric_limits<float>::max(), std::numeric_limits<float>::max());
+		cv::Point2f maximum(std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest());
+		uint32_t point_count = 0;
+		for (size_t label : labels)
+		{
+			for (const cv::Point2f& point : labeled_blobs.at(label)->GetPoints())
+			{
+				minimum.x = std::min(minimum.x, point.x);
+				minimum.y = std::min(minimum.y, point.y);
+				maximum.x = std::max(maximum.x, point.x);
+				maximum.y = std::max(maximum.y, point.y);
+				++point_count;
+			}
+		}
+
+		if (point_count == 0)
+		{
+			return;
+		}
+
+		m_origin_	= minimum;
+		m_columns_	= static_cast<int32_t>((maximum.x - minimum.x) / m_cell_size_) + 1;
+		m_rows_		= static_cast<int32_t>((maximum.y - minimum.y) / m_cell_size_) + 1;
+		m_cells_.resize(static_cast<size_t>(m_columns_) * m_rows_);
+		m_points_.resize(point_count);
+		m_removed_points_.resize(point_count);
+
+		// Assigns the ids in the order of the labels, which keeps the ids of each label consecutive.
+		uint32_t id = 0;
+		for (size_t label : labels)
+		{
+			WSICS::BLOB_Operations::PointSpan<const cv::Point2f> points(labeled_blobs.at(label)->GetPoints());
+			std::vector<uint32_t>& ids(labeled_ids[label]);
+			ids.reserve(points.size());
+			for (const cv::Point2f& point : points)
+			{
+				IndexedPoint indexed_point = { label, &point, id++ };
+				int32_t column	= GetCellIndex_(point.x - m_origin_.x, m_columns_);
+				int32_t row		= GetCellIndex_(point.y - m_origin_.y, m_rows_);
+				m_cells_[static_cast<size_t>(row) * m_columns_ + column].push_back(indexed_point);
+				m_points_[indexed_point.id] = indexed_point;
+				ids.push_back(indexed_point.id);
+			}
+		}
+	}
+
+	void PointIndex::Clear(void)
+	{
+		m_cells_.clear();
+		m_points_.clear();
+		m_removed_points_.clear();
+		m_columns_	= 0;
+		m_rows_		= 0;
+	}
+
+	void PointIndex::Remove(const uint32_t id)
+	{
+		m_removed_points_.set(id);
+	}
+
+	bool PointIndex::IsRemoved(const uint32_t id) const
+	{
+		return m_removed_points_.test(id);
+	}
+
+	size_t PointIndex::GetRemovedCount(void) const
+	{
+		return m_removed_points_.count();
+	}
+
+	const PointIndex::IndexedPoint& PointIndex::GetPoint(const uint32_t id) const
+	{
+		return m_points_[id];
+	}
+
+	void PointIndex::QueryAnnulus(const cv::Point2f& center, const float min_distance, const float max_distance, std::vector<uint32_t>& output) const
+	{
+		QueryAnnulus_<false>(center, min_distance, max_distance, 0, output);
+	}
+
+	void PointIndex::QueryAnnulus(const cv::Point2f& center, const float min_distance, const float max_distance, const size_t label, std::vector<uint32_t>& output) const
+	{
+		QueryAnnulus_<true>(center, min_distance, max_distance, label, output);
+	}
+
+	bool PointIndex::IsPositionedWithinRadius(const cv::Point2f& center, const cv::Point2f& position, const float radius)
+	{
+		return std::pow(center.x - position.x, 2) + std::pow(center.y - position.y, 2) < std::pow(radius, 2);
+	}
+
+	int32_t PointIndex::GetCellIndex_(const float coordinate, const int32_t cell_count) const
+	{
+		float cell = std::floor(coordinate / m_cell_size_);
+		if (cell >= cell_count)
+		{
+			return cell_count - 1;
+		}
+		if (!(cell >= 0))
+		{
+			return 0;
+		}
+		return static_cast<int32_t>(cell);
+	}
+
+	template <bool restrict_label>
+	void PointIndex::QueryAnnulus_(const cv::Point2f& center, const float min_distance, const float max_distance, const size_t label, std::vector<uint32_t>& output) const
+	{
+		float radius = std::fabs(max_distance);
+		ForEachInRegion(cv::Point2f(center.x - radius, center.y - radius), cv::Point2f(center.x + radius, center.y + radius), false,
+			[&center, min_distance, max_distance, label, &output](const IndexedPoint& indexed_point)
+		{
+			if ((!restrict_label || indexed_point.label == label) &&
+				IsPositionedWithinRadius(center, *indexed_point.point, max_distance) && !IsPositionedWithinRadius(center, *indexed_point.point, min_distance))
+			{
+				output.push_back(indexed_point.id);
+			}
+		});
+	}
+}
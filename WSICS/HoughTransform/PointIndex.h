@@ -0,0 +1,166 @@
+#ifndef __WSICS_HOUGHTRANSFORM_POINTINDEX__
+#define __WSICS_HOUGHTRANSFORM_POINTINDEX__
+
+#include <unordered_map>
+#include <vector>
+
+#include <boost/dynamic_bitset.hpp>
+#include <opencv2/core/types.hpp>
+
+#include "../BLOB_Operations/BLOB.h"
+
+namespace WSICS::HoughTransform
+{
+	/// <summary>
+	/// A uniform grid over the labeled points of a window, which answers region and annulus queries by only
+	/// visiting the grid cells that overlap them. Every point receives an id when the index is built, which
+	/// queries report and which can be resolved into the points themselves, keeping the query results compact.
+	/// Points can be removed individually, which allows the index to follow the deletions of the
+	/// WindowedTripletDetector without rebuilding. Removed points remain in the grid and are marked within
+	/// a bitset over the point ids, since verification still considers them.
+	///
+	/// The index doesn't own the points, it only references the points of the BLOBs it was built with.
+	/// </summary>
+	class PointIndex
+	{
+		public:
+			/// <summary>
+			/// Holds an indexed point, alongside its label and id.
+			/// </summary>
+			struct IndexedPoint
+			{
+				size_t				label;
+				const cv::Point2f*	point;
+				uint32_t			id;
+			};
+
+			/// <summary>
+			/// Constructs an empty index.
+			/// </summary>
+			PointIndex(void);
+
+			/// <summary>
+			/// Rebuilds the index with the points of the passed BLOBs, restoring every point.
+			/// </summary>
+			/// <param name="labels">The labels to index, in the order in which their points receive their ids.</param>
+			/// <param name="labeled_blobs">The BLOBs whose points should be indexed, mapped by their label.</param>
+			/// <param name="cell_size">The width and height of each grid cell, ideally close to the largest query radius.</param>
+			/// <param name="labeled_ids">The map to fill with the ids of the points, grouped by their label.</param>
+			void Build(const std::vector<size_t>& labels, const std::unordered_map<size_t, const WSICS::BLOB_Operations::BLOB*>& labeled_blobs, const float cell_size, std::unordered_map<size_t, std::vector<uint32_t>>& labeled_ids);
+			/// <summary>
+			/// Removes every point from the index.
+			/// </summary>
+			void Clear(void);
+			/// <summary>
+			/// Marks a single point as removed.
+			/// </summary>
+			/// <param name="id">The id of the point to remove.</param>
+			void Remove(const uint32_t id);
+			/// <summary>
+			/// Returns whether a point has been removed.
+			/// </summary>
+			/// <param name="id">The id of the point to check.</param>
+			/// <returns>Whether or not the point has been removed.</returns>
+			bool IsRemoved(const uint32_t id) const;
+			/// <summary>
+			/// Returns the amount of removed points.
+			/// </summary>
+			/// <returns>The amount of removed points.</returns>
+			size_t GetRemovedCount(void) const;
+
+			/// <summary>
+			/// Calls the function for each point within the grid cells that overlap the region, which therefore
+			/// includes points close to the region. Removed points are only visited if requested.
+			/// </summary>
+			/// <param name="top_left">The top left corner of the region.</param>
+			/// <param name="bottom_right">The bottom right corner of the region.</param>
+			/// <param name="include_removed">Whether or not removed points should be visited.</param>
+			/// <param name="function">The function to call with each IndexedPoint.</param>
+			template <typename Function>
+			void ForEachInRegion(const cv::Point2f& top_left, const cv::Point2f& bottom_right, const bool include_removed, Function function) const;
+			/// <summary>
+			/// Returns an indexed point through its id.
+			/// </summary>
+			/// <param name="id">The id of the point.</param>
+			/// <returns>The indexed point.</returns>
+			const IndexedPoint& GetPoint(const uint32_t id) const;
+			/// <summary>
+			/// Collects the ids of the points that lie within the max distance of the center, but not within the min distance.
+			/// </summary>
+			/// <param name="center">The center of the annulus.</param>
+			/// <param name="min_distance">The inner radius of the annulus.</param>
+			/// <param name="max_distance">The outer radius of the annulus.</param>
+			/// <param name="output">The vector to append the point ids to.</param>
+			void QueryAnnulus(const cv::Point2f& center, const float min_distance, const float max_distance, std::vector<uint32_t>& output) const;
+			/// <summary>
+			/// Collects the ids of the points of a single label that lie within the max distance of the center, but not within the min distance.
+			/// </summary>
+			/// <param name="center">The center of the annulus.</param>
+			/// <param name="min_distance">The inner radius of the annulus.</param>
+			/// <param name="max_distance">The outer radius of the annulus.</param>
+			/// <param name="label">The label the points should belong to.</param>
+			/// <param name="output">The vector to append the point ids to.</param>
+			void QueryAnnulus(const cv::Point2f& center, const float min_distance, const float max_distance, const size_t label, std::vector<uint32_t>& output) const;
+
+			/// <summary>
+			/// Returns whether or not the position is located within the radius around the center.
+			/// </summary>
+			/// <param name="center">The center point around which the radius will be projected.</param>
+			/// <param name="position">The position to check against the center radius.</param>
+			/// <param name="radius">The radius to use for the calculation.</param>
+			/// <returns>Whether or not point is within the radius around center.</returns>
+			static bool IsPositionedWithinRadius(const cv::Point2f& center, const cv::Point2f& position, const float radius);
+
+		private:
+			cv::Point2f														m_origin_;
+			float															m_cell_size_;
+			int32_t															m_columns_;
+			int32_t															m_rows_;
+			std::vector<std::vector<IndexedPoint>>							m_cells_;
+			std::vector<IndexedPoint>										m_points_;
+			boost::dynamic_bitset<>											m_removed_points_;
+
+			/// <summary>
+			/// Returns the column or row of the grid cell that holds the coordinate, clamped to the grid.
+			/// </summary>
+			/// <param name="coordinate">The coordinate, relative to the origin of the grid.</param>
+			/// <param name="cell_count">The amount of columns or rows of the grid.</param>
+			/// <returns>The column or row of the grid cell.</returns>
+			int32_t GetCellIndex_(const float coordinate, const int32_t cell_count) const;
+			/// <summary>
+			/// Collects the points within the annulus, optionally restricted to a label.
+			/// </summary>
+			template <bool restrict_label>
+			void QueryAnnulus_(const cv::Point2f& center, const float min_distance, const float max_distance, const size_t label, std::vector<uint32_t>& output) const;
+	};
+
+	template <typename Function>
+	void PointIndex::ForEachInRegion(const cv::Point2f& top_left, const cv::Point2f& bottom_right, const bool include_removed, Function function) const
+	{
+		if (m_cells_.empty())
+		{
+			return;
+		}
+
+		// Points beyond the edges of the grid are clamped into the outer cells, which therefore keeps the bounds inclusive.
+		int32_t first_column	= GetCellIndex_(top_left.x - m_origin_.x, m_columns_);
+		int32_t last_column		= GetCellIndex_(bottom_right.x - m_origin_.x, m_columns_);
+		int32_t first_row		= GetCellIndex_(top_left.y - m_origin_.y, m_rows_);
+		int32_t last_row		= GetCellIndex_(bottom_right.y - m_origin_.y, m_rows_);
+
+		for (int32_t row = first_row; row <= last_row; ++row)
+		{
+			for (int32_t column = first_column; column <= last_column; ++column)
+			{
+				for (const IndexedPoint& indexed_point : m_cells_[static_cast<size_t>(row) * m_columns_ + column])
+				{
+					if (include_removed || !m_removed_points_[indexed_point.id])
+					{
+						function(indexed_point);
+					}
+				}
+			}
+		}
+	}
+}
+#endif // __WSICS_HOUGHTRANSFORM_POINTINDEX__
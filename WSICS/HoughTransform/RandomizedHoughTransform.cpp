@@ -2,27 +2,34 @@
 
 #define _USE_MATH_DEFINES
 
+#include <algorithm>
 #include <cmath>
 #include <math.h>
+#include <stdexcept>
 #include <opencv2/core/core.hpp>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define WSICS_HOUGHTRANSFORM_SSE2
+#endif
+
 namespace WSICS::HoughTransform
 {
     //******************************************************************************
     // Constructors / Destructors
     //******************************************************************************
 	RandomizedHoughTransform::RandomizedHoughTransform(void)
-		: parameters(GetStandardParameters()), m_triplet_detector_parameters_(WindowedTripletDetector::GetStandardParameters())
+		: parameters(GetStandardParameters()), m_triplet_detector_parameters_(WindowedTripletDetector::GetStandardParameters()), m_thread_pool_(nullptr), m_trial_count_(0)
 	{
 	}
 
 	RandomizedHoughTransform::RandomizedHoughTransform(RandomizedHoughTransformParameters parameters)
-		: parameters(parameters), m_triplet_detector_parameters_(WindowedTripletDetector::GetStandardParameters())
+		: parameters(parameters), m_triplet_detector_parameters_(WindowedTripletDetector::GetStandardParameters()), m_thread_pool_(nullptr), m_trial_count_(0)
 	{
 	}
 
 	RandomizedHoughTransform::RandomizedHoughTransform(RandomizedHoughTransformParameters hough_transform_parameters, WindowedTripletDetectorParameters triplet_detector_parameters)
-		: parameters(hough_transform_parameters), m_triplet_detector_parameters_(triplet_detector_parameters)
+		: parameters(hough_transform_parameters), m_triplet_detector_parameters_(triplet_detector_parameters), m_thread_pool_(nullptr), m_trial_count_(0)
 	{
 	}
 
@@ -33,259 +40,421 @@ namespace WSICS::HoughTransform
 	std::vector<Ellipse> RandomizedHoughTransform::Execute(const cv::Mat& binary_matrix, cv::Mat& output_matrix, const WSICS::BLOB_Operations::MaskType mask_type)
 	{
 		WindowedTripletDetector triplet_detector(m_triplet_detector_parameters_);
+		triplet_detector.SetThreadPool(m_thread_pool_);
 		triplet_detector.Initialize(binary_matrix, output_matrix, mask_type);
+		triplet_detector.SetSeed(this->parameters.seed);
 		return Execute(triplet_detector);
 	}
 
 	std::vector<Ellipse> RandomizedHoughTransform::Execute(const cv::Mat& labeled_matrix, const cv::Mat& stats_array)
 	{
 		WindowedTripletDetector triplet_detector(m_triplet_detector_parameters_);
+		triplet_detector.SetThreadPool(m_thread_pool_);
 		triplet_detector.Initialize(labeled_matrix, stats_array);
+		triplet_detector.SetSeed(this->parameters.seed);
 		return Execute(triplet_detector);
 	}
 
     std::vector<Ellipse> RandomizedHoughTransform::Execute(WindowedTripletDetector& triplet_detector)
     {
-        TreeAccumulator combiner(this->parameters.ellipse_radii_threshold*(int)(this->parameters.combine_threshold), this->parameters.ellipse_position_threshold*(int)(this->parameters.combine_threshold), 0);
-
-		bool repeat_epoch = true;
-		while (repeat_epoch || triplet_detector.Next())
+		// Each window derives its random stream from its index, and only alters its own copy of the points. Which allows
+		// the windows to be processed in any order, as long as their ellipses are combined in window order.
+		size_t window_count = triplet_detector.GetWindowCount();
+		std::vector<std::vector<Ellipse>> window_ellipses(window_count);
+		std::vector<size_t> window_trials(window_count, 0);
+		WindowProcessor process_window(GetWindowProcessor_());
+
+		if (m_thread_pool_ && m_thread_pool_->Size() > 0 && window_count > 1)
 		{
-			repeat_epoch = false;
-			Ellipse best_ellipse;
-			size_t	best_ellipse_count = 0;
-
-			TreeAccumulator accumulator(this->parameters.ellipse_radii_threshold, this->parameters.ellipse_position_threshold, this->parameters.count_threshold);
-			for (size_t epoch = 0; epoch < triplet_detector.Size() * this->parameters.epoch_size; ++epoch)
+			size_t chunk_count = std::min(window_count, (m_thread_pool_->Size() + 1) * 4);
+			m_thread_pool_->ParallelFor(chunk_count, [this, &triplet_detector, &window_ellipses, &window_trials, process_window, window_count, chunk_count](const size_t chunk)
 			{
-				std::pair<bool, Ellipse> ellipse_result(EllipseFromTriplet_(triplet_detector.GetNextTriplet()));
-				if (ellipse_result.first && ProcessDetectedEllipse_(ellipse_result.second, best_ellipse, best_ellipse_count, repeat_epoch, accumulator, combiner, triplet_detector))
+				// The copy shares the BLOBs and tangents of the detector, and only duplicates the state of its window.
+				WindowedTripletDetector chunk_detector(triplet_detector);
+				for (size_t window = chunk * window_count / chunk_count; window < (chunk + 1) * window_count / chunk_count; ++window)
 				{
-					epoch = 0;
+					chunk_detector.MoveTo(window);
+					window_ellipses[window] = (this->*process_window)(chunk_detector, window_trials[window]);
 				}
+			});
+		}
+		else
+		{
+			for (size_t window = 0; window < window_count; ++window)
+			{
+				triplet_detector.MoveTo(window);
+				window_ellipses[window] = (this->*process_window)(triplet_detector, window_trials[window]);
+			}
+		}
+
+		m_trial_count_ = 0;
+		for (size_t trials : window_trials)
+		{
+			m_trial_count_ += trials;
+		}
+
+        GridAccumulator combiner(this->parameters.ellipse_radii_threshold*(int)(this->parameters.combine_threshold), this->parameters.ellipse_position_threshold*(int)(this->parameters.combine_threshold), 0);
+		for (std::vector<Ellipse>& detected_ellipses : window_ellipses)
+		{
+			for (Ellipse& ellipse : detected_ellipses)
+			{
+				combiner.AddEllipse(ellipse);
 			}
 		}
 
-          return combiner.Accumulate();
+		return combiner.Accumulate();
     }
 
+	void RandomizedHoughTransform::SetThreadPool(Misc::ThreadPool* thread_pool)
+	{
+		m_thread_pool_ = thread_pool;
+	}
+
+	size_t RandomizedHoughTransform::GetTrialCount(void) const
+	{
+		return m_trial_count_;
+	}
+
 	RandomizedHoughTransformParameters RandomizedHoughTransform::GetStandardParameters(void)
 	{
-		return { 5, 4.0f, 8.0f, 1.0f, 5.0f, 25.0f, 30.0f, MIDPOINT_CALCULATION_OPTIMAL, ELLIPSE_REMOVAL_SIMPLE, COMBINE_THRESHOLD_FACTOR2, TANGENT_VERIFICATION_TRIPLE };
+		return { 5, 4.0f, 8.0f, 1.0f, 5.0f, 25.0f, 30.0f, MIDPOINT_CALCULATION_OPTIMAL, ELLIPSE_REMOVAL_SIMPLE, COMBINE_THRESHOLD_FACTOR2, TANGENT_VERIFICATION_TRIPLE, 0, 0, 0.5f };
 	}
 
 	//******************************************************************************
 	// Private Member Functions
 	//******************************************************************************
 
-	bool RandomizedHoughTransform::ComputeParameters_(const PointCollection& input_triplet, Ellipse& output_ellipse) const
+	void RandomizedHoughTransform::ComputeParameters_(TripletBatch& batch) const
 	{
-		double a_data[9];
-		double b_data[] = { 1.0, 1.0, 1.0 };
-
-		for (int i = 0; i < 3; i++)
+		// Solves x^2 * a + 2xy * b + y^2 * c = 1 for the three points through Cramer's rule. A singular system
+		// produces non finite parameters, which invalidates the lane.
+		size_t lane = 0;
+
+#ifdef WSICS_HOUGHTRANSFORM_SSE2
+		// Processes two lanes at once in double precision, with the same order of operations as the scalar solve. The
+		// matrix entries are rounded to float before widening, and a parameter is finite when subtracting it from itself yields zero.
+		const __m128d	zero_double	= _mm_setzero_pd();
+		const __m128	zero_float	= _mm_setzero_ps();
+		const __m128	two			= _mm_set1_ps(2.0f);
+
+		for (; lane + 2 <= batch.size; lane += 2)
 		{
-			a_data[i * 3 + 0] = input_triplet.points[i].first.x  * input_triplet.points[i].first.x;
-			a_data[i * 3 + 1] = 2 * input_triplet.points[i].first.x  * input_triplet.points[i].first.y;
-			a_data[i * 3 + 2] = input_triplet.points[i].first.y  * input_triplet.points[i].first.y;
-		}
+			__m128d matrix[3][3];
+			for (size_t point = 0; point < 3; ++point)
+			{
+				__m128 x = _mm_setr_ps(batch.point_x[point][lane], batch.point_x[point][lane + 1], 0.0f, 0.0f);
+				__m128 y = _mm_setr_ps(batch.point_y[point][lane], batch.point_y[point][lane + 1], 0.0f, 0.0f);
+				matrix[point][0] = _mm_cvtps_pd(_mm_mul_ps(x, x));
+				matrix[point][1] = _mm_cvtps_pd(_mm_mul_ps(_mm_mul_ps(two, x), y));
+				matrix[point][2] = _mm_cvtps_pd(_mm_mul_ps(y, y));
+			}
 
-		cv::Mat matrix_view = cv::Mat::zeros(3, 3, CV_32FC1);
+			__m128d minor_0		= _mm_sub_pd(_mm_mul_pd(matrix[1][1], matrix[2][2]), _mm_mul_pd(matrix[1][2], matrix[2][1]));
+			__m128d minor_1		= _mm_sub_pd(_mm_mul_pd(matrix[1][0], matrix[2][2]), _mm_mul_pd(matrix[1][2], matrix[2][0]));
+			__m128d minor_2		= _mm_sub_pd(_mm_mul_pd(matrix[1][0], matrix[2][1]), _mm_mul_pd(matrix[1][1], matrix[2][0]));
+			__m128d determinant	= _mm_add_pd(_mm_sub_pd(_mm_mul_pd(matrix[0][0], minor_0), _mm_mul_pd(matrix[0][1], minor_1)), _mm_mul_pd(matrix[0][2], minor_2));
+
+			__m128d determinant_a = _mm_add_pd(
+				_mm_sub_pd(minor_0, _mm_mul_pd(matrix[0][1], _mm_sub_pd(matrix[2][2], matrix[1][2]))),
+				_mm_mul_pd(matrix[0][2], _mm_sub_pd(matrix[2][1], matrix[1][1])));
+			__m128d determinant_b = _mm_add_pd(
+				_mm_sub_pd(_mm_mul_pd(matrix[0][0], _mm_sub_pd(matrix[2][2], matrix[1][2])), minor_1),
+				_mm_mul_pd(matrix[0][2], _mm_sub_pd(matrix[1][0], matrix[2][0])));
+			__m128d determinant_c = _mm_add_pd(
+				_mm_sub_pd(_mm_mul_pd(matrix[0][0], _mm_sub_pd(matrix[1][1], matrix[2][1])), _mm_mul_pd(matrix[0][1], _mm_sub_pd(matrix[1][0], matrix[2][0]))),
+				minor_2);
+
+			__m128 a = _mm_cvtpd_ps(_mm_div_pd(determinant_a, determinant));
+			__m128 b = _mm_cvtpd_ps(_mm_div_pd(determinant_b, determinant));
+			__m128 c = _mm_cvtpd_ps(_mm_div_pd(determinant_c, determinant));
+
+			__m128d b_double	= _mm_cvtps_pd(b);
+			__m128d conic		= _mm_sub_pd(_mm_cvtps_pd(_mm_mul_ps(a, c)), _mm_mul_pd(b_double, b_double));
+			__m128	finite		= _mm_and_ps(_mm_and_ps(
+				_mm_cmpeq_ps(_mm_sub_ps(a, a), zero_float),
+				_mm_cmpeq_ps(_mm_sub_ps(b, b), zero_float)),
+				_mm_cmpeq_ps(_mm_sub_ps(c, c), zero_float));
+			int is_ellipse = _mm_movemask_pd(_mm_cmpgt_pd(conic, zero_double)) & _mm_movemask_ps(finite);
+
+			float parameters[3][4];
+			_mm_storeu_ps(parameters[0], a);
+			_mm_storeu_ps(parameters[1], b);
+			_mm_storeu_ps(parameters[2], c);
+			for (size_t offset = 0; offset < 2; ++offset)
+			{
+				batch.theta[lane + offset]		= parameters[0][offset];
+				batch.major_axis[lane + offset]	= parameters[1][offset];
+				batch.minor_axis[lane + offset]	= parameters[2][offset];
+				batch.valid[lane + offset]		&= (is_ellipse >> offset) & 1;
+			}
+		}
+#endif
 
-		int counter = 0;
-		for (int row = 0; row < 3; ++row)
+		for (; lane < batch.size; ++lane)
 		{
-			for (int col = 0; col < 3; ++col)
+			double matrix[3][3];
+			for (size_t point = 0; point < 3; ++point)
 			{
-				matrix_view.at<float>(row, col) = a_data[counter];
-				++counter;
+				float x = batch.point_x[point][lane];
+				float y = batch.point_y[point][lane];
+				matrix[point][0] = x * x;
+				matrix[point][1] = 2 * x * y;
+				matrix[point][2] = y * y;
 			}
+
+			double minor_0 = matrix[1][1] * matrix[2][2] - matrix[1][2] * matrix[2][1];
+			double minor_1 = matrix[1][0] * matrix[2][2] - matrix[1][2] * matrix[2][0];
+			double minor_2 = matrix[1][0] * matrix[2][1] - matrix[1][1] * matrix[2][0];
+			double determinant = matrix[0][0] * minor_0 - matrix[0][1] * minor_1 + matrix[0][2] * minor_2;
+
+			// Each column replaced by the right hand side of ones.
+			double determinant_a = minor_0
+				- matrix[0][1] * (matrix[2][2] - matrix[1][2])
+				+ matrix[0][2] * (matrix[2][1] - matrix[1][1]);
+			double determinant_b = matrix[0][0] * ((matrix[2][2] - matrix[1][2]))
+				- minor_1
+				+ matrix[0][2] * (matrix[1][0] - matrix[2][0]);
+			double determinant_c = matrix[0][0] * (matrix[1][1] - matrix[2][1])
+				- matrix[0][1] * (matrix[1][0] - matrix[2][0])
+				+ minor_2;
+
+			float a = static_cast<float>(determinant_a / determinant);
+			float b = static_cast<float>(determinant_b / determinant);
+			float c = static_cast<float>(determinant_c / determinant);
+
+			batch.theta[lane]		= a;
+			batch.major_axis[lane]	= b;
+			batch.minor_axis[lane]	= c;
+
+			bool is_ellipse = static_cast<double>(a * c) - static_cast<double>(b) * b > 0 && std::isfinite(a) && std::isfinite(b) && std::isfinite(c);
+			batch.valid[lane] &= is_ellipse;
 		}
+	}
 
-		cv::Mat vector_view = cv::Mat::zeros(3, 1, CV_32FC1);
-		cv::Mat destination;
-		vector_view += 1;
+	void RandomizedHoughTransform::ConvertParameters_(TripletBatch& batch) const
+	{
+		for (size_t lane = 0; lane < batch.size; ++lane)
+		{
+			float a = batch.theta[lane];
+			float b = batch.major_axis[lane];
+			float c = batch.minor_axis[lane];
 
-		cv::solve(matrix_view, vector_view, destination, 1);
+			float new_theta = 0.5 * std::atan(2 * b / (a - c));
+			double shift	= a > c ? (b < 0 ? 0.5 * M_PI : (b > 0 ? -0.5 * M_PI : 0.0)) : 0.0;
+			new_theta		= a == c ? 0.0f : static_cast<float>(new_theta + shift);
 
-		float a = (output_ellipse.theta			= destination.at<float>(0, 0));
-		float b = (output_ellipse.major_axis	= destination.at<float>(1, 0));
-		float c = (output_ellipse.minor_axis	= destination.at<float>(2, 0));
+			double sin_theta		= std::sin(new_theta);
+			float new_major_axis	= std::sqrt(std::cos(2 * new_theta) / (a - (a + c) * (sin_theta * sin_theta)));
+			float new_minor_axis	= new_major_axis / std::sqrt((a + c) * (static_cast<double>(new_major_axis) * new_major_axis) - 1);
 
-		if (a*c - pow(b, 2) <= 0)
-		{
-			return false;
+			batch.theta[lane]		= new_theta;
+			batch.major_axis[lane]	= new_major_axis;
+			batch.minor_axis[lane]	= new_minor_axis;
 		}
-		else if (std::isnan(a) || std::isnan(b) || std::isnan(c))
-		{
-			return false;
-		}
-		return true;
 	}
 
-	void RandomizedHoughTransform::ConvertParameters_(Ellipse& ellipse) const
+	template <MidpointCalculation midpoint_calculation>
+	void RandomizedHoughTransform::DetermineCenters_(TripletBatch& batch) const
 	{
-		float new_theta, new_major_axis, new_minor_axis;
-		if (ellipse.theta == ellipse.minor_axis)
+		for (size_t lane = 0; lane < batch.size; ++lane)
 		{
-			new_theta = 0;
-		}
-		else
-		{
-			new_theta = 0.5 * std::atan(2 * ellipse.major_axis / (ellipse.theta - ellipse.minor_axis));
-			if (ellipse.theta > ellipse.minor_axis)
+			float midpoint_x[3];
+			float midpoint_y[3];
+			float intersect_x[3];
+			float intersect_y[3];
+
+			// Intersects the tangents of each pair of points, listed as AB, BC and CA.
+			for (size_t pair = 0; pair < 3; ++pair)
 			{
-				if (ellipse.major_axis < 0)
-				{
-					new_theta = new_theta - (-1) * 0.5 * M_PI;
-				}
-				else if (ellipse.major_axis > 0)
-				{
-					new_theta = new_theta - (1) * 0.5 * M_PI;
-				}
+				size_t first	= pair;
+				size_t second	= (pair + 1) % 3;
+				midpoint_x[pair] = (batch.point_x[first][lane] + batch.point_x[second][lane]) / 2.0f;
+				midpoint_y[pair] = (batch.point_y[first][lane] + batch.point_y[second][lane]) / 2.0f;
+				IntersectLines_(batch.tangent_theta[first][lane], batch.tangent_rho[first][lane], batch.tangent_theta[second][lane], batch.tangent_rho[second][lane], intersect_x[pair], intersect_y[pair]);
 			}
-		}
 
-		new_major_axis = std::sqrt(std::cos(2 * new_theta) / (ellipse.theta - (ellipse.theta + ellipse.minor_axis) * std::pow(std::sin(new_theta), 2)));
-		new_minor_axis = new_major_axis / std::sqrt((ellipse.theta + ellipse.minor_axis) * std::pow(new_major_axis, 2) - 1);
-
-		ellipse.theta		= new_theta;
-		ellipse.major_axis	= new_major_axis;
-		ellipse.minor_axis	= new_minor_axis;
-	}
-
-	cv::Point2f RandomizedHoughTransform::DetermineCenter_(const PointCollection& triplet) const
-	{
-		if (triplet.points[0].second.IsParallelWith(triplet.points[1].second))
-		{
-			return (triplet.points[0].first + triplet.points[1].first) / 2.0f;
-		}
-		else if (triplet.points[1].second.IsParallelWith(triplet.points[2].second))
-		{
-			return (triplet.points[1].first + triplet.points[2].first) / 2.0f;
-		}
-		else
-		{
-			switch (this->parameters.midpoint_calculation)
+			// The default calculation intersects the AB and BC bisectors, while the optimal calculation
+			// discards the bisector whose intersection lies closest to its midpoint.
+			size_t first_line	= 0;
+			size_t second_line	= 1;
+			if constexpr (midpoint_calculation == MIDPOINT_CALCULATION_OPTIMAL)
 			{
-				case(MIDPOINT_CALCULATION_DEFAULT):
+				float distance[3];
+				for (size_t pair = 0; pair < 3; ++pair)
 				{
-					cv::Point2f intersect_AB = triplet.points[0].second.Intersect(triplet.points[1].second);
-					cv::Point2f intersect_BC = triplet.points[1].second.Intersect(triplet.points[2].second);
-					cv::Point2f midpoint_AB = (triplet.points[0].first + triplet.points[1].first) / 2.0f;
-					cv::Point2f midpoint_BC = (triplet.points[1].first + triplet.points[2].first) / 2.0f;
-
-					Line line_AB = Line(intersect_AB, midpoint_AB);
-					Line line_BC = Line(intersect_BC, midpoint_BC);
-					return line_AB.Intersect(line_BC);
-					break;
+					double x = intersect_x[pair] - midpoint_x[pair];
+					double y = intersect_y[pair] - midpoint_y[pair];
+					distance[pair] = x * x + y * y;
 				}
-				case(MIDPOINT_CALCULATION_OPTIMAL):
-				{
-					cv::Point2f intersect_AB = triplet.points[0].second.Intersect(triplet.points[1].second);
-					cv::Point2f intersect_BC = triplet.points[1].second.Intersect(triplet.points[2].second);
-					cv::Point2f intersect_CA = triplet.points[2].second.Intersect(triplet.points[0].second);
 
-					cv::Point2f midpoint_AB = (triplet.points[0].first + triplet.points[1].first) / 2.0f;
-					cv::Point2f midpoint_BC = (triplet.points[1].first + triplet.points[2].first) / 2.0f;
-					cv::Point2f midpoint_CA = (triplet.points[2].first + triplet.points[0].first) / 2.0f;
+				bool discard_ab = distance[0] < distance[1] && distance[0] < distance[2];
+				bool discard_bc = !discard_ab && distance[1] < distance[0] && distance[1] < distance[2];
+				first_line	= discard_ab || discard_bc ? 2 : 0;
+				second_line	= discard_ab ? 1 : (discard_bc ? 0 : 1);
+			}
 
-					float dist_AB = std::pow(intersect_AB.x - midpoint_AB.x, 2) + std::pow(intersect_AB.y - midpoint_AB.y, 2);
-					float dist_BC = std::pow(intersect_BC.x - midpoint_BC.x, 2) + std::pow(intersect_BC.y - midpoint_BC.y, 2);
-					float dist_CA = std::pow(intersect_CA.x - midpoint_CA.x, 2) + std::pow(intersect_CA.y - midpoint_CA.y, 2);
+			float first_theta, first_rho, second_theta, second_rho, center_x, center_y;
+			LineThroughPoints_(intersect_x[first_line], intersect_y[first_line], midpoint_x[first_line], midpoint_y[first_line], first_theta, first_rho);
+			LineThroughPoints_(intersect_x[second_line], intersect_y[second_line], midpoint_x[second_line], midpoint_y[second_line], second_theta, second_rho);
+			IntersectLines_(first_theta, first_rho, second_theta, second_rho, center_x, center_y);
 
-					if (dist_AB < dist_BC && dist_AB < dist_CA)
-					{
-						Line line_CA = Line(intersect_CA, midpoint_CA);
-						Line line_BC = Line(intersect_BC, midpoint_BC);
-						return line_CA.Intersect(line_BC);
-					}
-					else if (dist_BC < dist_AB && dist_BC < dist_CA)
-					{
-						Line line_CA = Line(intersect_CA, midpoint_CA);
-						Line line_AB = Line(intersect_AB, midpoint_AB);
-						return line_CA.Intersect(line_AB);
-					}
-					else
-					{
-						Line line_AB = Line(intersect_AB, midpoint_AB);
-						Line line_BC = Line(intersect_BC, midpoint_BC);
-						return line_AB.Intersect(line_BC);
-					}
-					break;
-				}
+			// Parallel tangents place the center between their points.
+			bool parallel_ab = batch.tangent_theta[0][lane] == batch.tangent_theta[1][lane];
+			bool parallel_bc = !parallel_ab && batch.tangent_theta[1][lane] == batch.tangent_theta[2][lane];
+			center_x = parallel_ab ? midpoint_x[0] : (parallel_bc ? midpoint_x[1] : center_x);
+			center_y = parallel_ab ? midpoint_y[0] : (parallel_bc ? midpoint_y[1] : center_y);
+
+			batch.center_x[lane] = center_x;
+			batch.center_y[lane] = center_y;
+
+			// Places the points relative to the center.
+			for (size_t point = 0; point < 3; ++point)
+			{
+				batch.point_x[point][lane] -= center_x;
+				batch.point_y[point][lane] -= center_y;
 			}
 		}
-
-		return cv::Point2f(0, 0);
 	}
 
-	bool RandomizedHoughTransform::HasCorrectRadius_(const Ellipse& ellipse) const
+	template <MidpointCalculation midpoint_calculation>
+	void RandomizedHoughTransform::EllipsesFromTriplets_(TripletBatch& batch) const
 	{
-		return ellipse.major_axis <= this->parameters.max_ellipse_radius && ellipse.minor_axis >= this->parameters.min_ellipse_radius;
+		// Each stage computes every lane, leaving the rejection of individual lanes to the valid flags.
+		DetermineCenters_<midpoint_calculation>(batch);
+		ComputeParameters_(batch);
+		FitsContours_(batch);
+		ConvertParameters_(batch);
+		HasCorrectRadius_(batch);
 	}
 
-	bool RandomizedHoughTransform::FitsContours_(const PointCollection& triplet, const Ellipse& ellipse) const
+	RandomizedHoughTransform::WindowProcessor RandomizedHoughTransform::GetWindowProcessor_(void) const
 	{
-		char valid = 0;
-		for (const std::pair<cv::Point2f, Line>& triplet_pair : triplet.points)
+		// Instantiates the window processing for each combination of midpoint calculation and ellipse removal.
+		static const WindowProcessor processors[2][5] =
 		{
-			float difference = std::fabs(ellipse.GetTangent(triplet_pair.first) - triplet_pair.second.GetAngle());
-
-			if (difference > 0.5f * M_PI)
 			{
-				difference = M_PI - difference;
+				&RandomizedHoughTransform::ProcessWindow_<MIDPOINT_CALCULATION_DEFAULT, ELLIPSE_REMOVAL_NONE>,
+				&RandomizedHoughTransform::ProcessWindow_<MIDPOINT_CALCULATION_DEFAULT, ELLIPSE_REMOVAL_SIMPLE>,
+				&RandomizedHoughTransform::ProcessWindow_<MIDPOINT_CALCULATION_DEFAULT, ELLIPSE_REMOVAL_EMPTY_ACCUMULATOR>,
+				&RandomizedHoughTransform::ProcessWindow_<MIDPOINT_CALCULATION_DEFAULT, ELLIPSE_REMOVAL_ALL_IN_EPOCH>,
+				&RandomizedHoughTransform::ProcessWindow_<MIDPOINT_CALCULATION_DEFAULT, ELLIPSE_REMOVAL_BEST_IN_EPOCH>
+			},
+			{
+				&RandomizedHoughTransform::ProcessWindow_<MIDPOINT_CALCULATION_OPTIMAL, ELLIPSE_REMOVAL_NONE>,
+				&RandomizedHoughTransform::ProcessWindow_<MIDPOINT_CALCULATION_OPTIMAL, ELLIPSE_REMOVAL_SIMPLE>,
+				&RandomizedHoughTransform::ProcessWindow_<MIDPOINT_CALCULATION_OPTIMAL, ELLIPSE_REMOVAL_EMPTY_ACCUMULATOR>,
+				&RandomizedHoughTransform::ProcessWindow_<MIDPOINT_CALCULATION_OPTIMAL, ELLIPSE_REMOVAL_ALL_IN_EPOCH>,
+				&RandomizedHoughTransform::ProcessWindow_<MIDPOINT_CALCULATION_OPTIMAL, ELLIPSE_REMOVAL_BEST_IN_EPOCH>
 			}
+		};
+
+		if (this->parameters.midpoint_calculation < MIDPOINT_CALCULATION_DEFAULT || this->parameters.midpoint_calculation > MIDPOINT_CALCULATION_OPTIMAL ||
+			this->parameters.ellipse_removal_method < ELLIPSE_REMOVAL_NONE || this->parameters.ellipse_removal_method > ELLIPSE_REMOVAL_BEST_IN_EPOCH)
+		{
+			throw std::runtime_error("Unknown midpoint calculation or ellipse removal method.");
+		}
+		return processors[this->parameters.midpoint_calculation][this->parameters.ellipse_removal_method];
+	}
+
+	void RandomizedHoughTransform::HasCorrectRadius_(TripletBatch& batch) const
+	{
+		size_t lane = 0;
+
+#ifdef WSICS_HOUGHTRANSFORM_SSE2
+		// Processes four lanes at once. Non finite axes fail both comparisons, as they do for the scalar lanes.
+		const __m128 max_radius = _mm_set1_ps(this->parameters.max_ellipse_radius);
+		const __m128 min_radius = _mm_set1_ps(this->parameters.min_ellipse_radius);
+		for (; lane + 4 <= batch.size; lane += 4)
+		{
+			__m128 fits = _mm_and_ps(
+				_mm_cmple_ps(_mm_loadu_ps(batch.major_axis + lane), max_radius),
+				_mm_cmpge_ps(_mm_loadu_ps(batch.minor_axis + lane), min_radius));
 
-			if (difference * 180 / M_PI < this->parameters.tangent_tolerance)
+			int correct_radius = _mm_movemask_ps(fits);
+			for (size_t offset = 0; offset < 4; ++offset)
 			{
-				++valid;
+				batch.valid[lane + offset] &= (correct_radius >> offset) & 1;
 			}
 		}
-		
-		return valid >= this->parameters.tangent_verification;
+#endif
+
+		for (; lane < batch.size; ++lane)
+		{
+			batch.valid[lane] &= batch.major_axis[lane] <= this->parameters.max_ellipse_radius && batch.minor_axis[lane] >= this->parameters.min_ellipse_radius;
+		}
 	}
 
-	std::pair<bool, Ellipse> RandomizedHoughTransform::EllipseFromTriplet_(PointCollection triplet) const
+	void RandomizedHoughTransform::FitsContours_(TripletBatch& batch) const
 	{
-		Ellipse calculated_ellipse;
-		bool valid_ellipse = false;
-
-		if (triplet.points.size() >= 3)
+		for (size_t lane = 0; lane < batch.size; ++lane)
 		{
-			// Compute parameters using the triplet.
-			calculated_ellipse = Ellipse(DetermineCenter_(triplet), 0, 0, 0);
-			triplet -= calculated_ellipse.center;
+			float a = batch.theta[lane];
+			float b = batch.major_axis[lane];
+			float c = batch.minor_axis[lane];
 
-			// Use the tangents from the image and compare those with the tangents calculated from the parameters.
-			if (ComputeParameters_(triplet, calculated_ellipse) && FitsContours_(triplet, calculated_ellipse))
+			uint32_t valid = 0;
+			for (size_t point = 0; point < 3; ++point)
 			{
-				// filter the ellipse based on the calculated radius.
-				ConvertParameters_(calculated_ellipse);
-				valid_ellipse = HasCorrectRadius_(calculated_ellipse);
+				float x = batch.point_x[point][lane];
+				float y = batch.point_y[point][lane];
+
+				// The tangent of the ellipse at the point, and the angle of the tangent line through the point.
+				float ellipse_tangent	= std::atan2(a * x + b * y, -(b * x + c * y));
+				ellipse_tangent			= ellipse_tangent > 0.5 * M_PI ? static_cast<float>(ellipse_tangent - M_PI) : (ellipse_tangent < 0.5 * M_PI ? static_cast<float>(ellipse_tangent + M_PI) : ellipse_tangent);
+
+				float line_angle	= batch.tangent_theta[point][lane] + (0.5 * M_PI);
+				line_angle			= std::fabs(line_angle) > 0.5 * M_PI ? static_cast<float>(line_angle + (line_angle < 0 ? M_PI : -M_PI)) : line_angle;
+
+				float difference	= std::fabs(ellipse_tangent - line_angle);
+				difference			= difference > 0.5f * M_PI ? static_cast<float>(M_PI - difference) : difference;
+
+				valid += difference * 180 / M_PI < this->parameters.tangent_tolerance;
 			}
+
+			batch.valid[lane] &= valid >= static_cast<uint32_t>(this->parameters.tangent_verification);
 		}
+	}
+
+	void RandomizedHoughTransform::IntersectLines_(const float theta_a, const float rho_a, const float theta_b, const float rho_b, float& x, float& y)
+	{
+		float cos_a = std::cos(theta_a);
+		float cos_b = std::cos(theta_b);
 
-		return { valid_ellipse, calculated_ellipse };
+		y = (rho_b * cos_a - rho_a * cos_b) / std::sin(theta_b - theta_a);
+
+		// Vertical lines are solved through the other line.
+		float x_a = (rho_a - y * std::sin(theta_a)) / cos_a;
+		float x_b = (rho_b - y * std::sin(theta_b)) / cos_b;
+		x = cos_a != 0 ? x_a : x_b;
+	}
+
+	void RandomizedHoughTransform::LineThroughPoints_(const float x_a, const float y_a, const float x_b, const float y_b, float& theta, float& rho)
+	{
+		float angle = std::atan2(y_b - y_a, x_b - x_a);
+		theta	= angle < 0 ? angle + 0.5 * M_PI : angle - 0.5 * M_PI;
+		rho		= (y_a * x_b - x_a * y_b) / (x_b - x_a) * std::sin(theta);
 	}
 
+	template <EllipseRemoval ellipse_removal>
 	bool RandomizedHoughTransform::ProcessDetectedEllipse_(Ellipse& ellipse,
 		Ellipse& best_ellipse,
 		size_t& best_ellipse_count,
 		bool& repeat_epoch,
-		TreeAccumulator& accumulator,
-		TreeAccumulator& combiner,
-		WindowedTripletDetector& triplet_detector)
+		bool& removed_points,
+		size_t& count,
+		GridAccumulator& accumulator,
+		std::vector<Ellipse>& detected_ellipses,
+		WindowedTripletDetector& triplet_detector) const
 	{
 		bool reset_epoch = false;
 
 		// Add the ellipse to the accumulator, averaging it if collisions are found.
-		size_t count = accumulator.AddEllipse(ellipse);
+		count = accumulator.AddEllipse(ellipse);
 
 		// When using point deletion, an ellipse its points will be deleted from the current window if
 		// they fit certain criteria. This can result in restarting the epoch for the current window
 		// and the clearing of the accumulator if "EMPTY_ACCUM" point deletion method is set.
-		if (this->parameters.ellipse_removal_method == ELLIPSE_REMOVAL_BEST_IN_EPOCH)
+		if constexpr (ellipse_removal == ELLIPSE_REMOVAL_BEST_IN_EPOCH)
 		{
 			if (count > best_ellipse_count)
 			{
@@ -297,19 +466,20 @@ namespace WSICS::HoughTransform
 			{
 				if (triplet_detector.Verify(best_ellipse))
 				{
-					combiner.AddEllipse(best_ellipse);
+					detected_ellipses.push_back(best_ellipse);
 				}
 				triplet_detector.Simplify(best_ellipse);
-				repeat_epoch = true;
+				repeat_epoch	= true;
+				removed_points	= true;
 			}
 		}
 		else if (count == this->parameters.count_threshold)
 		{
-			if ((this->parameters.ellipse_removal_method == ELLIPSE_REMOVAL_SIMPLE || this->parameters.ellipse_removal_method == ELLIPSE_REMOVAL_EMPTY_ACCUMULATOR) && triplet_detector.Verify(ellipse))
+			if ((ellipse_removal == ELLIPSE_REMOVAL_SIMPLE || ellipse_removal == ELLIPSE_REMOVAL_EMPTY_ACCUMULATOR) && triplet_detector.Verify(ellipse))
 			{
-				combiner.AddEllipse(ellipse);
+				detected_ellipses.push_back(ellipse);
 
-				if (this->parameters.ellipse_removal_method == ELLIPSE_REMOVAL_EMPTY_ACCUMULATOR)
+				if constexpr (ellipse_removal == ELLIPSE_REMOVAL_EMPTY_ACCUMULATOR)
 				{
 					reset_epoch = true;
 					accumulator.Clear();
@@ -317,24 +487,82 @@ namespace WSICS::HoughTransform
 			}
 		}
 
-		if (this->parameters.ellipse_removal_method == ELLIPSE_REMOVAL_NONE || this->parameters.ellipse_removal_method == ELLIPSE_REMOVAL_ALL_IN_EPOCH)
+		if constexpr (ellipse_removal == ELLIPSE_REMOVAL_NONE || ellipse_removal == ELLIPSE_REMOVAL_ALL_IN_EPOCH)
 		{
 			std::vector<Ellipse> ellipses(accumulator.Accumulate());
 			for (Ellipse& accumulated_ellipse : ellipses)
 			{
 				if (triplet_detector.Verify(accumulated_ellipse))
 				{
-					if (this->parameters.ellipse_removal_method == ELLIPSE_REMOVAL_ALL_IN_EPOCH)
+					if constexpr (ellipse_removal == ELLIPSE_REMOVAL_ALL_IN_EPOCH)
 					{
 						triplet_detector.Simplify(accumulated_ellipse);
-						repeat_epoch = true;
+						repeat_epoch	= true;
+						removed_points	= true;
 					}
 
-					combiner.AddEllipse(accumulated_ellipse);
+					detected_ellipses.push_back(accumulated_ellipse);
 				}
 			}
 		}
 
 		return reset_epoch;
 	}
+
+	template <MidpointCalculation midpoint_calculation, EllipseRemoval ellipse_removal>
+	std::vector<Ellipse> RandomizedHoughTransform::ProcessWindow_(WindowedTripletDetector& triplet_detector, size_t& trials) const
+	{
+		std::vector<Ellipse> detected_ellipses;
+		TripletBatch batch;
+
+		// Triplets that land in a cell this close to the count threshold show that the epoch is still making progress.
+		size_t progress_count = std::max<size_t>(1, static_cast<size_t>(std::ceil(this->parameters.count_threshold * this->parameters.convergence_ratio)));
+		trials = 0;
+
+		bool repeat_epoch = true;
+		while (repeat_epoch)
+		{
+			repeat_epoch = false;
+			Ellipse best_ellipse;
+			size_t	best_ellipse_count = 0;
+
+			GridAccumulator accumulator(this->parameters.ellipse_radii_threshold, this->parameters.ellipse_position_threshold, this->parameters.count_threshold);
+			size_t trials_without_progress = 0;
+			bool converged = false;
+			for (size_t epoch = 0; epoch < triplet_detector.Size() * this->parameters.epoch_size && !converged;)
+			{
+				// Fits a batch of triplets, limited to the remainder of the epoch.
+				batch.Clear();
+				triplet_detector.GetNextTriplets(batch, static_cast<size_t>(std::ceil(triplet_detector.Size() * this->parameters.epoch_size - epoch)));
+				EllipsesFromTriplets_<midpoint_calculation>(batch);
+
+				// Once points have been removed, the remaining triplets of the batch may reference them and are discarded.
+				// Resetting the epoch leaves the points intact, which means the remaining triplets stay usable.
+				bool removed_points = false;
+				for (size_t lane = 0; lane < batch.size && !removed_points && !converged; ++lane)
+				{
+					++epoch;
+					++trials;
+					++trials_without_progress;
+					if (batch.valid[lane])
+					{
+						Ellipse ellipse(batch.GetEllipse(lane));
+						size_t count = 0;
+						if (ProcessDetectedEllipse_<ellipse_removal>(ellipse, best_ellipse, best_ellipse_count, repeat_epoch, removed_points, count, accumulator, detected_ellipses, triplet_detector))
+						{
+							epoch = 1;
+						}
+						if (count >= progress_count)
+						{
+							trials_without_progress = 0;
+						}
+					}
+
+					converged = this->parameters.convergence_trials > 0 && trials_without_progress >= this->parameters.convergence_trials;
+				}
+			}
+		}
+
+		return detected_ellipses;
+	}
 }
\ No newline at end of file
@@ -1,7 +1,9 @@
 #ifndef __WSICS_HOUGHTRANSFORM_RANDOMIZEDHOUGHTRANSFORM__
 #define __WSICS_HOUGHTRANSFORM_RANDOMIZEDHOUGHTRANSFORM__
 
-#include "TreeAccumulator.h"
+#include "../Misc/ThreadPool.h"
+#include "GridAccumulator.h"
+#include "TripletBatch.h"
 #include "WindowedTripletDetector.h"
 
 // TODO: Convert stack of variables into structs that can be passed down to the corresponding objects.
@@ -51,6 +53,9 @@ namespace WSICS::HoughTransform
 		EllipseRemoval		ellipse_removal_method;
 		CombineThreshold	combine_threshold;
 		TangentVerification tangent_verification;
+		uint64_t			seed;
+		size_t				convergence_trials;
+		float				convergence_ratio;
 	};
 
 	/// <summary>
@@ -98,6 +103,18 @@ namespace WSICS::HoughTransform
 			/// <param name="triplet_detector">A fully initialized WindowedTripletDetector to apply the Hough transform onto.</param>
 			/// <returns>The detected ellipses.<returns>
 			std::vector<Ellipse> Execute(WindowedTripletDetector& triplet_detector);
+			/// <summary>
+			/// Sets the pool used to process the windows concurrently. Each worker processes a copy of the triplet detector,
+			/// while the detected ellipses are combined in window order. Without a pool, the windows are processed serially.
+			/// </summary>
+			/// <param name="thread_pool">The pool to distribute the windows over, or a nullptr.</param>
+			void SetThreadPool(Misc::ThreadPool* thread_pool);
+			/// <summary>
+			/// Returns the amount of triplets that were fitted during the last execution, summed over all windows. Alongside
+			/// the amount of detected ellipses, this measures what the convergence criterion trades away for its speedup.
+			/// </summary>
+			/// <returns>The amount of triplet trials spent by the last execution.</returns>
+			size_t GetTrialCount(void) const;
 
 			/// <summary>
 			/// Returns the standard parameters for the RandomizedHoughTransform.
@@ -106,71 +123,119 @@ namespace WSICS::HoughTransform
 			static RandomizedHoughTransformParameters GetStandardParameters(void);
 
 		private:
-			WindowedTripletDetectorParameters m_triplet_detector_parameters_;
+			WindowedTripletDetectorParameters	m_triplet_detector_parameters_;
+			Misc::ThreadPool*					m_thread_pool_;
+			size_t								m_trial_count_;
 
 			/// <summary>
-			/// Computers the a,b,c parameters for an ellipse that has a location which is already known. It
-			/// does this by using a point triplet. Application of linear decomposition then determines the 
+			/// A window processing instantiation, specialized for a midpoint calculation and ellipse removal method.
+			/// </summary>
+			typedef std::vector<Ellipse> (RandomizedHoughTransform::*WindowProcessor)(WindowedTripletDetector&, size_t&) const;
+
+			/// <summary>
+			/// Computes the a,b,c parameters for the ellipses of a batch, whose locations are already known. The three points of each
+			/// triplet define a 3x3 linear system, which is solved in closed form through Cramer's rule. This determines the
 			/// three values that would define an ellipse, with its center located on the origin.
 			/// </summary>
-			/// <param name="input_triplet">The triplet to use as the basis for the computation.</param>
-			/// <param name="output_ellipse">The ellipse with recalculated parameters.</param>
-			/// <returns>Whether or not the new ellipse values are valid.</returns>
-			bool ComputeParameters_(const PointCollection& input_triplet, Ellipse& output_ellipse) const;
+			/// <param name="batch">The batch with centered triplets, whose lanes are invalidated if they don't describe an ellipse.</param>
+			void ComputeParameters_(TripletBatch& batch) const;
 			/// <summary>
 			/// Converts the ellipses parameters from an a, b, c format to a theta, major axis, minor axis format.
 			/// The reason for doing so is to create a more accumulator friendly range of numbers for each parameter.
 			/// </summary>
-			/// <param name="ellipse">The ellipse to convert.</param>
-			void ConvertParameters_(Ellipse& ellipse) const;
+			/// <param name="batch">The batch holding the ellipses to convert.</param>
+			void ConvertParameters_(TripletBatch& batch) const;
 			/// <summary>
-			/// Determines the center of an ellipse through the usage of a point triplet and its tangents. This is achieved
-			/// by making use of the symmetry of an ellipse.
+			/// Determines the centers of the ellipses through the usage of the point triplets and their tangents. This is achieved
+			/// by making use of the symmetry of an ellipse. Afterwards, the points are placed relative to the centers.
 			/// </summary>
-			/// <param name="triplet">The triplet from which to determine its center.</param>
-			/// <returns>The center point of the triplet.</returns>
-			cv::Point2f DetermineCenter_(const PointCollection& triplet) const;
+			/// <typeparam name="midpoint_calculation">The method used to calculate the centers.</typeparam>
+			/// <param name="batch">The batch from which to determine the centers.</param>
+			template <MidpointCalculation midpoint_calculation>
+			void DetermineCenters_(TripletBatch& batch) const;
 			/// <summary>
-			/// Attempts to create a new ellipse through a point triplet. It performs several checks
-			/// in order to report the validity of the created ellipse.
+			/// Attempts to create a new ellipse through each point triplet of a batch. It performs several checks
+			/// in order to report the validity of each created ellipse.
 			/// </summary>
-			/// <param name="triplet">The point triplet to convert into an ellipse.</param>
-			/// <returns>A pair where the first value defines whether or not the Ellipse in the second value is valid.</returns>
-			std::pair<bool, Ellipse> EllipseFromTriplet_(PointCollection triplet) const;
+			/// <typeparam name="midpoint_calculation">The method used to calculate the centers.</typeparam>
+			/// <param name="batch">The batch of triplets to convert into ellipses.</param>
+			template <MidpointCalculation midpoint_calculation>
+			void EllipsesFromTriplets_(TripletBatch& batch) const;
+			/// <summary>
+			/// Returns the window processing instantiation that matches the midpoint calculation and ellipse removal
+			/// parameters. This resolves the parameters once per execution, rather than for each triplet.
+			/// </summary>
+			/// <returns>A pointer towards the specialized window processing member function.</returns>
+			WindowProcessor GetWindowProcessor_(void) const;
 
 			/// <summary>
-			/// Determines whether an ellipse its size falls into a certain range. To accomplish this, the variables "max_ellipse_radius"
-			/// and "min_ellipse_radius" are used. If an ellipse is too big or too small, "false" will be returned.
+			/// Determines whether the ellipse sizes fall into a certain range. To accomplish this, the variables "max_ellipse_radius"
+			/// and "min_ellipse_radius" are used. If an ellipse is too big or too small, its lane will be invalidated.
 			/// </summary>
-			/// <param name="ellipse">The ellipse to check.</param>
-			/// <returns>Whether or not the ellipse has a valid radius.</returns>
-			bool HasCorrectRadius_(const Ellipse& ellipse) const;
+			/// <param name="batch">The batch holding the ellipses to check.</param>
+			void HasCorrectRadius_(TripletBatch& batch) const;
 			/// <summary>
-			/// Determines whether an ellipse defines contours that intersect with the three points of the triplet. It does this by
+			/// Determines whether the ellipses define contours that intersect with the three points of their triplet. It does this by
 			/// calculating the tangent at each of the three points, using the ellipses parameters. It then compares those with the
-			/// tangets calculated by the triplet itself. If the difference between the tangents is too large, "false" will be returned.
+			/// tangets calculated by the triplet itself. If the difference between the tangents is too large, the lane will be invalidated.
+			/// </summary>
+			/// <param name="batch">The batch holding the triplets and the ellipses that define the contours.</param>
+			void FitsContours_(TripletBatch& batch) const;
+			/// <summary>
+			/// Calculates the intersection of two lines.
 			/// </summary>
-			/// <param name="triplet">The triplet to match to the Ellipses contours.</param>
-			/// <param name="ellipse">The ellipse that defines the contours.</param>
-			/// <returns>Whether or not the ellipse and triplet contorus align within a certain range.</returns>
-			bool FitsContours_(const PointCollection& triplet, const Ellipse& ellipse) const;
+			/// <param name="theta_a">The theta of the first line.</param>
+			/// <param name="rho_a">The rho of the first line.</param>
+			/// <param name="theta_b">The theta of the second line.</param>
+			/// <param name="rho_b">The rho of the second line.</param>
+			/// <param name="x">The horizontal coordinate of the intersection.</param>
+			/// <param name="y">The vertical coordinate of the intersection.</param>
+			static void IntersectLines_(const float theta_a, const float rho_a, const float theta_b, const float rho_b, float& x, float& y);
+			/// <summary>
+			/// Calculates the theta and rho of the line running through two points.
+			/// </summary>
+			/// <param name="x_a">The horizontal coordinate of the first point.</param>
+			/// <param name="y_a">The vertical coordinate of the first point.</param>
+			/// <param name="x_b">The horizontal coordinate of the second point.</param>
+			/// <param name="y_b">The vertical coordinate of the second point.</param>
+			/// <param name="theta">The theta of the line.</param>
+			/// <param name="rho">The rho of the line.</param>
+			static void LineThroughPoints_(const float x_a, const float y_a, const float x_b, const float y_b, float& theta, float& rho);
 			/// <summary>
 			/// Performs the neccesary operations for the ellipse extraction.
 			/// </summary>
+			/// <typeparam name="ellipse_removal">The method used to remove the points of detected ellipses.</typeparam>
 			/// <param name="ellipse">The detected ellipse.</param>
 			/// <param name="best_ellipse">The currently best performing ellipse, based on the amount of detections.</param>
 			/// <param name="best_ellipse_count">The highest amount of counts for the detected ellipses.</param>
 			/// <param name="repeat_epoch">Whether or not to repeat the current epoch.</param>
+			/// <param name="removed_points">Whether or not points have been removed from the triplet detector.</param>
+			/// <param name="count">The amount of ellipses within the accumulator cell that the ellipse was added to.</param>
 			/// <param name="accumulator">The accumulator for this epoch.</param>
-			/// <param name="combiner">The accumulator for the entire execution.</param>
+			/// <param name="detected_ellipses">The verified ellipses of the window, which are combined once every window has been processed.</param>
 			/// <param name="triplet_detector">The triplet detector which is providing the points for the detection.</param>
+			template <EllipseRemoval ellipse_removal>
 			bool ProcessDetectedEllipse_(Ellipse& ellipse,
 				Ellipse& best_ellipse,
 				size_t& best_ellipse_count,
 				bool& repeat_epoch,
-				TreeAccumulator& accumulator,
-				TreeAccumulator& combiner,
-				WindowedTripletDetector& triplet_detector);
+				bool& removed_points,
+				size_t& count,
+				GridAccumulator& accumulator,
+				std::vector<Ellipse>& detected_ellipses,
+				WindowedTripletDetector& triplet_detector) const;
+			/// <summary>
+			/// Performs the epochs for the current window of the triplet detector, repeating them while points are being removed.
+			/// If a convergence criterion is set, an epoch ends early once "convergence_trials" consecutive triplets have failed
+			/// to add to an accumulator cell holding at least "convergence_ratio" of the count threshold.
+			/// </summary>
+			/// <typeparam name="midpoint_calculation">The method used to calculate the centers.</typeparam>
+			/// <typeparam name="ellipse_removal">The method used to remove the points of detected ellipses.</typeparam>
+			/// <param name="triplet_detector">The triplet detector, placed at the window to process.</param>
+			/// <param name="trials">The amount of triplets fitted for the window.</param>
+			/// <returns>The verified ellipses of the window, in order of detection.</returns>
+			template <MidpointCalculation midpoint_calculation, EllipseRemoval ellipse_removal>
+			std::vector<Ellipse> ProcessWindow_(WindowedTripletDetector& triplet_detector, size_t& trials) const;
     };
 }
 #endif // __WSICS_HOUGHTRANSFORM_RANDOMIZEDHOUGHTRANSFORM__
\ No newline at end of file
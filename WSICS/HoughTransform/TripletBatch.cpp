@@ -0,0 +1,45 @@
+#include "TripletBatch.h"
+
+#include <stdexcept>
+
+namespace WSICS::HoughTransform
+{
+	TripletBatch::TripletBatch(void) : size(0)
+	{
+	}
+
+	void TripletBatch::Add(const PointCollection& triplet)
+	{
+		if (IsFull())
+		{
+			throw std::runtime_error("The triplet batch has reached its capacity.");
+		}
+
+		bool complete = triplet.complete;
+		for (size_t point = 0; point < 3; ++point)
+		{
+			point_x[point][size]		= complete ? triplet.points[point].first.x : 0.0f;
+			point_y[point][size]		= complete ? triplet.points[point].first.y : 0.0f;
+			tangent_theta[point][size]	= complete ? triplet.points[point].second.theta : 0.0f;
+			tangent_rho[point][size]	= complete ? triplet.points[point].second.rho : 0.0f;
+		}
+
+		valid[size] = complete;
+		++size;
+	}
+
+	void TripletBatch::Clear(void)
+	{
+		size = 0;
+	}
+
+	Ellipse TripletBatch::GetEllipse(const size_t lane) const
+	{
+		return Ellipse(cv::Point2f(center_x[lane], center_y[lane]), major_axis[lane], minor_axis[lane], theta[lane]);
+	}
+
+	bool TripletBatch::IsFull(void) const
+	{
+		return size == CAPACITY;
+	}
+}
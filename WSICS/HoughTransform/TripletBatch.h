@@ -0,0 +1,73 @@
+#ifndef __WSICS_HOUGHTRANSFORM_TRIPLETBATCH__
+#define __WSICS_HOUGHTRANSFORM_TRIPLETBATCH__
+
+#include <cstdint>
+
+#include "Ellipse.h"
+#include "PointCollection.h"
+
+namespace WSICS::HoughTransform
+{
+	/// <summary>
+	/// Holds a batch of point triplets in a structure of arrays layout, alongside the ellipse parameters that are
+	/// derived from them. Each triplet occupies a single lane across the arrays, which allows the ellipse fitting
+	/// to process the batch with plain loops over the lanes that are free of per lane branches.
+	///
+	/// The parameter arrays first hold the a, b, c conic parameters and are converted into the theta, major axis
+	/// and minor axis format in place, mirroring how the Ellipse object was used by the original scalar fitting.
+	/// </summary>
+	struct TripletBatch
+	{
+		/// <summary>The maximum amount of triplets within a single batch.</summary>
+		static const size_t CAPACITY = 64;
+
+		/// <summary>The amount of triplets within the batch.</summary>
+		size_t	size;
+
+		/// <summary>The coordinates of the three points of each triplet, indexed by point and then lane.</summary>
+		float	point_x[3][CAPACITY];
+		float	point_y[3][CAPACITY];
+		/// <summary>The tangent lines through the three points of each triplet, indexed by point and then lane.</summary>
+		float	tangent_theta[3][CAPACITY];
+		float	tangent_rho[3][CAPACITY];
+
+		/// <summary>The centers of the ellipses.</summary>
+		float	center_x[CAPACITY];
+		float	center_y[CAPACITY];
+		/// <summary>The a parameter, which is later converted into the rotation of the ellipse.</summary>
+		float	theta[CAPACITY];
+		/// <summary>The b parameter, which is later converted into the major axis of the ellipse.</summary>
+		float	major_axis[CAPACITY];
+		/// <summary>The c parameter, which is later converted into the minor axis of the ellipse.</summary>
+		float	minor_axis[CAPACITY];
+		/// <summary>Whether or not the lane still holds a valid ellipse.</summary>
+		uint8_t	valid[CAPACITY];
+
+		/// <summary>
+		/// Constructs an empty batch.
+		/// </summary>
+		TripletBatch(void);
+
+		/// <summary>
+		/// Adds a triplet to the batch. An incomplete collection occupies a lane that is marked invalid.
+		/// </summary>
+		/// <param name="triplet">The triplet to add.</param>
+		void Add(const PointCollection& triplet);
+		/// <summary>
+		/// Removes all triplets from the batch.
+		/// </summary>
+		void Clear(void);
+		/// <summary>
+		/// Returns the ellipse held by a lane.
+		/// </summary>
+		/// <param name="lane">The lane of the ellipse.</param>
+		/// <returns>The ellipse held by the lane.</returns>
+		Ellipse GetEllipse(const size_t lane) const;
+		/// <summary>
+		/// Returns whether or not the batch has reached its capacity.
+		/// </summary>
+		/// <returns>Whether or not the batch is full.</returns>
+		bool IsFull(void) const;
+	};
+}
+#endif // __WSICS_HOUGHTRANSFORM_TRIPLETBATCH__
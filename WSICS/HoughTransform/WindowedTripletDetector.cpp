@@ -2,22 +2,30 @@
 
 #define _USE_MATH_DEFINES
 
+#include <algorithm>
 #include <cmath>
-#include <cstdlib> // rand
+#include <limits>
 #include <math.h> // M_PI
+#include <numeric>
 #include <stdexcept>
 
+#include "../Misc/Random.h"
+
 namespace WSICS::HoughTransform
 {
     //******************************************************************************
     // Constructors / Destructors
     //******************************************************************************
 
-	WindowedTripletDetector::WindowedTripletDetector(void) : parameters(GetStandardParameters()), m_blob_window_(this->parameters.window_size)
+	WindowedTripletDetector::WindowedTripletDetector(void)
+		: parameters(GetStandardParameters()), m_blob_tangents_(std::make_shared<std::unordered_map<size_t, std::vector<Line>>>()), m_blob_window_(this->parameters.window_size),
+		m_total_window_points_(0), m_seed_(0), m_thread_pool_(nullptr)
 	{
 	}
 
-	WindowedTripletDetector::WindowedTripletDetector(const WindowedTripletDetectorParameters parameters) : parameters(parameters), m_blob_window_(this->parameters.window_size)
+	WindowedTripletDetector::WindowedTripletDetector(const WindowedTripletDetectorParameters parameters)
+		: parameters(parameters), m_blob_tangents_(std::make_shared<std::unordered_map<size_t, std::vector<Line>>>()), m_blob_window_(this->parameters.window_size),
+		m_total_window_points_(0), m_seed_(0), m_thread_pool_(nullptr)
     {
     }
 
@@ -28,12 +36,16 @@ namespace WSICS::HoughTransform
 	void WindowedTripletDetector::Initialize(const cv::Mat& binary_matrix, cv::Mat& output_matrix, const WSICS::BLOB_Operations::MaskType mask_type)
     {
 		m_blob_window_ = WSICS::BLOB_Operations::BLOB_Window(m_blob_window_.GetWindowSize(), binary_matrix, output_matrix, mask_type);
+		CalculateAllTangents_();
+		ClearWindowInformation_();
 		UpdateWindowInformation_();
     }
 
 	void WindowedTripletDetector::Initialize(const cv::Mat& labeled_blob_matrix, const cv::Mat& stats_array)
 	{
 		m_blob_window_ = WSICS::BLOB_Operations::BLOB_Window(m_blob_window_.GetWindowSize(), labeled_blob_matrix, stats_array);
+		CalculateAllTangents_();
+		ClearWindowInformation_();
 		UpdateWindowInformation_();
 	}
 
@@ -46,29 +58,45 @@ namespace WSICS::HoughTransform
     {
 		CheckValidAccess_();
 
-		// If triplets can still be collected.
-		if (Size() - m_deleted_points_.size() > 3)
+		switch (this->parameters.point_selection)
 		{
-			std::pair<size_t, cv::Point2f*> origin(GetRandomLabeledPoint$());
-			switch (this->parameters.point_selection)
-			{
-				case POINT_SELECTION_FULLY_LABELED:					return AcquireRandomTriplet_(true, true, origin);				break;
-				case POINT_SELECTION_PARTIALLY_LABELED:				return AcquireRandomTriplet_(true, false, origin);				break;
-				case POINT_SELECTION_FULLY_RANDOM:					return AcquireRandomTriplet_(false, false, origin);				break;
-				case POINT_SELECTION_FULLY_LABELED_DIST_RESTR:		return AcquireRangeRestrictedTriplet_(true, true, origin);		break;
-				case POINT_SELECTION_PARTIALLY_LABELED_DIST_RESTR:	return AcquireRangeRestrictedTriplet_(true, false, origin);		break;
-				case POINT_SELECTION_FULLY_RANDOM_DIST_RESTR:		return AcquireRangeRestrictedTriplet_(false, false, origin);	break;
-			}
+			case POINT_SELECTION_FULLY_LABELED:					return GetNextTriplet_<POINT_SELECTION_FULLY_LABELED>();				break;
+			case POINT_SELECTION_PARTIALLY_LABELED:				return GetNextTriplet_<POINT_SELECTION_PARTIALLY_LABELED>();			break;
+			case POINT_SELECTION_FULLY_RANDOM:					return GetNextTriplet_<POINT_SELECTION_FULLY_RANDOM>();					break;
+			case POINT_SELECTION_FULLY_LABELED_DIST_RESTR:		return GetNextTriplet_<POINT_SELECTION_FULLY_LABELED_DIST_RESTR>();		break;
+			case POINT_SELECTION_PARTIALLY_LABELED_DIST_RESTR:	return GetNextTriplet_<POINT_SELECTION_PARTIALLY_LABELED_DIST_RESTR>();	break;
+			case POINT_SELECTION_FULLY_RANDOM_DIST_RESTR:		return GetNextTriplet_<POINT_SELECTION_FULLY_RANDOM_DIST_RESTR>();		break;
 		}
 		return PointCollection();
     }
 
+	void WindowedTripletDetector::GetNextTriplets(TripletBatch& batch, const size_t count)
+	{
+		CheckValidAccess_();
+
+		size_t capped_count = std::min(count, TripletBatch::CAPACITY - batch.size);
+		switch (this->parameters.point_selection)
+		{
+			case POINT_SELECTION_FULLY_LABELED:					GetNextTriplets_<POINT_SELECTION_FULLY_LABELED>(batch, capped_count);					break;
+			case POINT_SELECTION_PARTIALLY_LABELED:				GetNextTriplets_<POINT_SELECTION_PARTIALLY_LABELED>(batch, capped_count);				break;
+			case POINT_SELECTION_FULLY_RANDOM:					GetNextTriplets_<POINT_SELECTION_FULLY_RANDOM>(batch, capped_count);					break;
+			case POINT_SELECTION_FULLY_LABELED_DIST_RESTR:		GetNextTriplets_<POINT_SELECTION_FULLY_LABELED_DIST_RESTR>(batch, capped_count);		break;
+			case POINT_SELECTION_PARTIALLY_LABELED_DIST_RESTR:	GetNextTriplets_<POINT_SELECTION_PARTIALLY_LABELED_DIST_RESTR>(batch, capped_count);	break;
+			case POINT_SELECTION_FULLY_RANDOM_DIST_RESTR:		GetNextTriplets_<POINT_SELECTION_FULLY_RANDOM_DIST_RESTR>(batch, capped_count);			break;
+			default:
+			{
+				for (size_t triplet = 0; triplet < capped_count; ++triplet)
+				{
+					batch.Add(PointCollection());
+				}
+			}
+		}
+	}
+
 	void WindowedTripletDetector::Clear(void)
 	{
-		m_labeled_blobs_.clear();
-		m_deleted_points_.clear();
-		m_labeled_points_.clear();
-		m_current_labels_.clear();
+		ClearWindowInformation_();
+		m_blob_tangents_ = std::make_shared<std::unordered_map<size_t, std::vector<Line>>>();
 		m_blob_window_ = WSICS::BLOB_Operations::BLOB_Window(m_blob_window_.GetWindowSize());
 	}
 
@@ -95,6 +123,30 @@ namespace WSICS::HoughTransform
 		UpdateWindowInformation_();
 	}
 
+	void WindowedTripletDetector::MoveTo(const size_t window_index)
+	{
+		CheckValidAccess_();
+
+		m_blob_window_.ShiftWindowTo(window_index);
+		UpdateWindowInformation_();
+	}
+
+	size_t WindowedTripletDetector::GetWindowCount(void) const
+	{
+		return m_blob_window_.GetWindowCount();
+	}
+
+	void WindowedTripletDetector::SetSeed(const uint64_t seed)
+	{
+		m_seed_			= seed;
+		m_generator_	= Misc::Random::CreateStream(m_seed_, m_blob_window_.GetWindowIndex());
+	}
+
+	void WindowedTripletDetector::SetThreadPool(Misc::ThreadPool* thread_pool)
+	{
+		m_thread_pool_ = thread_pool;
+	}
+
     void WindowedTripletDetector::Simplify(const HoughTransform::Ellipse& ellipse)
     {
 		CheckValidAccess_();
@@ -104,39 +156,45 @@ namespace WSICS::HoughTransform
 		float outer_major_axis	= std::pow(ellipse.major_axis + this->parameters.ellipse_removal_range, 2);
 		float outer_minor_axis	= std::pow(ellipse.minor_axis + this->parameters.ellipse_removal_range, 2);
 
-		// Removes points from the BLOBs and any empty blob.
-		std::vector<size_t> blobs_to_remove;
-		for (std::pair<size_t, std::vector<cv::Point2f*>> labeled_points : m_labeled_points_)
+		// Marks the points within the bounding box of the outer ellipse as removed, tracking the labels they belong to.
+		std::vector<size_t> affected_labels;
+		std::pair<cv::Point2f, cv::Point2f> bounding_box(GetBoundingBox_(ellipse, outer_major_axis, outer_minor_axis));
+		m_point_index_.ForEachInRegion(bounding_box.first, bounding_box.second, false,
+			[sin_theta, cos_theta, outer_major_axis, outer_minor_axis, &ellipse, &affected_labels, this](const PointIndex::IndexedPoint& indexed_point)
 		{
-			labeled_points.second.erase(std::remove_if(labeled_points.second.begin(), labeled_points.second.end(),
-				[sin_theta, cos_theta, outer_major_axis, outer_minor_axis, ellipse, this](cv::Point2f* point)
-			{
-				cv::Point2f adjusted_point(*point - ellipse.center);
+			cv::Point2f adjusted_point(*indexed_point.point - ellipse.center);
 
-				float a = std::pow(adjusted_point.y * sin_theta + adjusted_point.x * cos_theta, 2);
-				float b = std::pow(adjusted_point.y * cos_theta - adjusted_point.x * sin_theta, 2);
-				float outer_result = a / outer_major_axis + b / outer_minor_axis;
+			float a = std::pow(adjusted_point.y * sin_theta + adjusted_point.x * cos_theta, 2);
+			float b = std::pow(adjusted_point.y * cos_theta - adjusted_point.x * sin_theta, 2);
+			float outer_result = a / outer_major_axis + b / outer_minor_axis;
 
-				if (outer_result < 1)
+			if (outer_result < 1)
+			{
+				m_point_index_.Remove(indexed_point.id);
+				if (std::find(affected_labels.begin(), affected_labels.end(), indexed_point.label) == affected_labels.end())
 				{
-					m_deleted_points_.insert(point);
-					return true;
+					affected_labels.push_back(indexed_point.label);
 				}
-				return false;
+			}
+		});
+
+		// Removes the points from the BLOBs and any empty blob.
+		for (size_t label : affected_labels)
+		{
+			std::vector<uint32_t>& labeled_points(m_labeled_points_[label]);
+			labeled_points.erase(std::remove_if(labeled_points.begin(), labeled_points.end(), [this](const uint32_t point_id)
+			{
+				return m_point_index_.IsRemoved(point_id);
 			}),
-			labeled_points.second.end());
+			labeled_points.end());
 
-			if (labeled_points.second.empty())
+			if (labeled_points.empty())
 			{
-				blobs_to_remove.emplace_back(labeled_points.first);
+				m_labeled_points_.erase(label);
+				m_current_labels_.erase(std::remove(m_current_labels_.begin(), m_current_labels_.end(), label), m_current_labels_.end());
 			}
 		}
-
-		for (size_t blob_id : blobs_to_remove)
-		{
-			m_labeled_points_.erase(blob_id);
-			m_current_labels_.erase(std::remove(m_current_labels_.begin(), m_current_labels_.end(), blob_id), m_current_labels_.end());
-		}
+		m_altered_labels_.insert(m_altered_labels_.end(), affected_labels.begin(), affected_labels.end());
     }
 
 	size_t WindowedTripletDetector::Size(void)
@@ -160,29 +218,12 @@ namespace WSICS::HoughTransform
         float outer_major_axis	= std::pow(major_axis + this->parameters.ellipse_range_tolerance, 2);
         float outer_minor_axis	= std::pow(minor_axis + this->parameters.ellipse_range_tolerance, 2);
 
-		// Loops through the undeleted points.
-		for (std::pair<size_t, std::vector<cv::Point2f*>> labeled_points : m_labeled_points_)
-		{
-			for (cv::Point2f* point : labeled_points.second)
-			{
-				cv::Point2f adjusted_point(*point - ellipse.center);
-
-				float a				= std::pow(adjusted_point.y * sin_theta + adjusted_point.x * cos_theta, 2);
-				float b				= std::pow(adjusted_point.y * cos_theta - adjusted_point.x * sin_theta, 2);
-				float inner_result	= a / inner_major_axis + b / inner_minor_axis;
-				float outer_result	= a / outer_major_axis + b / outer_minor_axis;
-
-				if (inner_result > 1 && outer_result < 1)
-				{
-					pixels_on_ellipse++;
-				}
-			}
-		}
-
-		// Loops through the deleted points.
-		for (cv::Point2f* point : m_deleted_points_)
+		// Loops through the undeleted and deleted points within the bounding box of the outer ellipse.
+		std::pair<cv::Point2f, cv::Point2f> bounding_box(GetBoundingBox_(ellipse, outer_major_axis, outer_minor_axis));
+		m_point_index_.ForEachInRegion(bounding_box.first, bounding_box.second, true,
+			[sin_theta, cos_theta, inner_major_axis, inner_minor_axis, outer_major_axis, outer_minor_axis, &ellipse, &pixels_on_ellipse](const PointIndex::IndexedPoint& indexed_point)
 		{
-			cv::Point2f adjusted_point(*point - ellipse.center);
+			cv::Point2f adjusted_point(*indexed_point.point - ellipse.center);
 
 			float a				= std::pow(adjusted_point.y * sin_theta + adjusted_point.x * cos_theta, 2);
 			float b				= std::pow(adjusted_point.y * cos_theta - adjusted_point.x * sin_theta, 2);
@@ -193,7 +234,7 @@ namespace WSICS::HoughTransform
 			{
 				pixels_on_ellipse++;
 			}
-		}
+		});
 
         return (static_cast<float>(pixels_on_ellipse) / static_cast<float>(estimated_pixels_on_ellipse) > this->parameters.min_coverage);
     }
@@ -207,131 +248,253 @@ namespace WSICS::HoughTransform
 	// Protected Member Functions
 	//******************************************************************************
 
-	inline std::pair<size_t, cv::Point2f*> WindowedTripletDetector::GetRandomLabeledPoint$(void)
+	inline const PointIndex::IndexedPoint& WindowedTripletDetector::GetRandomLabeledPoint$(void)
 	{
-		size_t label = m_current_labels_[std::rand() % m_current_labels_.size()];
+		size_t label = m_current_labels_[Misc::Random::RandomIndex(m_generator_, m_current_labels_.size())];
 		return GetRandomLabeledPoint$(label);
 	}
 
-	inline std::pair<size_t, cv::Point2f*> WindowedTripletDetector::GetRandomLabeledPoint$(const size_t label)
+	inline const PointIndex::IndexedPoint& WindowedTripletDetector::GetRandomLabeledPoint$(const size_t label)
 	{
-		std::vector<cv::Point2f*>& point_vector(m_labeled_points_[label]);
-		return { label, point_vector[std::rand() % point_vector.size()] };
+		std::vector<uint32_t>& point_vector(m_labeled_points_[label]);
+		return m_point_index_.GetPoint(point_vector[Misc::Random::RandomIndex(m_generator_, point_vector.size())]);
 	}
 
 	//******************************************************************************
 	// Private Member Functions
 	//******************************************************************************
 
-	PointCollection WindowedTripletDetector::AcquireRandomTriplet_(const bool a_from_same_label, const bool b_from_same_label, std::pair<size_t, cv::Point2f*>& labeled_origin)
+	template <bool a_from_same_label, bool b_from_same_label>
+	PointCollection WindowedTripletDetector::AcquireRandomTriplet_(const PointIndex::IndexedPoint& labeled_origin)
 	{
-		// Initializes the point vectors. Depending on the settings, one or both will be initialized.
-		std::vector<std::pair<size_t, cv::Point2f*>> label_points_within_range;
-		std::vector<std::pair<size_t, cv::Point2f*>> points_within_range;
+		// Fills the point buffers. Depending on the settings, one or both will be filled.
 		if (a_from_same_label || b_from_same_label)
 		{
-			label_points_within_range = std::move(GetPointsFromRadius_(*labeled_origin.second, labeled_origin.first));
+			GetPointsFromRadius_(*labeled_origin.point, labeled_origin.label, m_label_points_within_range_);
 		}
 		if (!a_from_same_label || !b_from_same_label)
 		{
-			points_within_range = std::move(GetPointsFromRadius_(*labeled_origin.second));
+			GetPointsFromRadius_(*labeled_origin.point, m_points_within_range_);
+		}
+
+		// Returns an empty collection if either of the required buffers holds no points.
+		if (((a_from_same_label || b_from_same_label) && m_label_points_within_range_.empty()) || ((!a_from_same_label || !b_from_same_label) && m_points_within_range_.empty()))
+		{
+			return PointCollection();
 		}
 
 		// Acquires the Alpha and Bravo points randomly.
-		std::pair<size_t, cv::Point2f*> point_a = a_from_same_label ? label_points_within_range[std::rand() & label_points_within_range.size()]
-																	: points_within_range[std::rand() & points_within_range.size()];
-		std::pair<size_t, cv::Point2f*> point_b = b_from_same_label ? label_points_within_range[std::rand() & label_points_within_range.size()]
-																	: points_within_range[std::rand() & points_within_range.size()];
-
-		PointCollection collection;
-		collection.points.push_back({ *labeled_origin.second, CalculateTangent_(labeled_origin) });
-		collection.points.push_back({ *point_a.second, CalculateTangent_(point_a) });
-		collection.points.push_back({ *point_b.second, CalculateTangent_(point_b) });
-		return collection;
+		const PointIndex::IndexedPoint& point_a(m_point_index_.GetPoint(a_from_same_label ? m_label_points_within_range_[Misc::Random::RandomIndex(m_generator_, m_label_points_within_range_.size())]
+																						   : m_points_within_range_[Misc::Random::RandomIndex(m_generator_, m_points_within_range_.size())]));
+		const PointIndex::IndexedPoint& point_b(m_point_index_.GetPoint(b_from_same_label ? m_label_points_within_range_[Misc::Random::RandomIndex(m_generator_, m_label_points_within_range_.size())]
+																						   : m_points_within_range_[Misc::Random::RandomIndex(m_generator_, m_points_within_range_.size())]));
+
+		return PointCollection({ *labeled_origin.point, CalculateTangent_(labeled_origin) },
+							   { *point_a.point, CalculateTangent_(point_a) },
+							   { *point_b.point, CalculateTangent_(point_b) });
 	}
 
-	PointCollection WindowedTripletDetector::AcquireRangeRestrictedTriplet_(const bool a_from_same_label, const bool b_from_same_label, std::pair<size_t, cv::Point2f*>& labeled_origin)
+	template <bool a_from_same_label, bool b_from_same_label>
+	PointCollection WindowedTripletDetector::AcquireRangeRestrictedTriplet_(const PointIndex::IndexedPoint& labeled_origin)
 	{
-		// Initializes the point vectors. Depending on the settings, one or both will be initialized.
-		std::vector<std::pair<size_t, cv::Point2f*>> label_points_within_range;
-		std::vector<std::pair<size_t, cv::Point2f*>> points_within_range;
+		// Fills the point buffers. Depending on the settings, one or both will be filled.
+		m_label_points_within_range_.clear();
+		m_points_within_range_.clear();
 		if (a_from_same_label || b_from_same_label)
 		{
-			label_points_within_range = std::move(GetPointsFromRadius_(*labeled_origin.second, labeled_origin.first));
+			GetPointsFromRadius_(*labeled_origin.point, labeled_origin.label, m_label_points_within_range_);
 		}
 		if (!a_from_same_label || !b_from_same_label)
 		{
-			points_within_range = std::move(GetPointsFromRadius_(*labeled_origin.second));
+			GetPointsFromRadius_(*labeled_origin.point, m_points_within_range_);
 		}
 
-		// Leaves the points empty if the corresponding vectors are empty.
-		std::pair<size_t, cv::Point2f*> point_a;
-		std::pair<size_t, cv::Point2f*> point_b;
+		// Leaves the points empty if the corresponding buffers are empty.
+		const PointIndex::IndexedPoint* point_a = nullptr;
+		const PointIndex::IndexedPoint* point_b = nullptr;
 
 		// Acquires the Alpha point.
-		if ((a_from_same_label && !label_points_within_range.empty()) || (!a_from_same_label && !points_within_range.empty()))
+		if ((a_from_same_label && !m_label_points_within_range_.empty()) || (!a_from_same_label && !m_points_within_range_.empty()))
 		{
-			point_a = a_from_same_label ? label_points_within_range[std::rand() % label_points_within_range.size()] : points_within_range[std::rand() % points_within_range.size()];
+			point_a = &m_point_index_.GetPoint(a_from_same_label ? m_label_points_within_range_[Misc::Random::RandomIndex(m_generator_, m_label_points_within_range_.size())]
+																 : m_points_within_range_[Misc::Random::RandomIndex(m_generator_, m_points_within_range_.size())]);
+		}
+		if (!point_a)
+		{
+			return PointCollection();
 		}
 
 		// Filters the range around Alpha to ensure the remaining points are within the correct ranges and then attempts to acquire Bravo.
-		if (!label_points_within_range.empty())
+		auto outside_alpha_range = [this, point_a](const uint32_t point_id)
 		{
-			label_points_within_range.erase(std::remove_if(label_points_within_range.begin(), label_points_within_range.end(), [this, point_a](std::pair<size_t, cv::Point2f*>& labeled_point)
-			{
-				return !IsPositionedWithinRadius_(*point_a.second, *labeled_point.second, this->parameters.max_point_distance) ||
-						IsPositionedWithinRadius_(*point_a.second, *labeled_point.second, this->parameters.min_point_distance);
-			}),
-			label_points_within_range.end());
+			const cv::Point2f& point(*m_point_index_.GetPoint(point_id).point);
+			return !PointIndex::IsPositionedWithinRadius(*point_a->point, point, this->parameters.max_point_distance) ||
+					PointIndex::IsPositionedWithinRadius(*point_a->point, point, this->parameters.min_point_distance);
+		};
+		m_label_points_within_range_.erase(std::remove_if(m_label_points_within_range_.begin(), m_label_points_within_range_.end(), outside_alpha_range), m_label_points_within_range_.end());
+		m_points_within_range_.erase(std::remove_if(m_points_within_range_.begin(), m_points_within_range_.end(), outside_alpha_range), m_points_within_range_.end());
+
+		// Attempts to acquire Bravo within the range of Alpha.
+		if ((b_from_same_label && !m_label_points_within_range_.empty()) || (!b_from_same_label && !m_points_within_range_.empty()))
+		{
+			point_b = &m_point_index_.GetPoint(b_from_same_label ? m_label_points_within_range_[Misc::Random::RandomIndex(m_generator_, m_label_points_within_range_.size())]
+																 : m_points_within_range_[Misc::Random::RandomIndex(m_generator_, m_points_within_range_.size())]);
 		}
-		if (!points_within_range.empty())
+		if (!point_b)
+		{
+			return PointCollection();
+		}
+
+		return PointCollection({ *labeled_origin.point, CalculateTangent_(labeled_origin) },
+							   { *point_a->point, CalculateTangent_(*point_a) },
+							   { *point_b->point, CalculateTangent_(*point_b) });
+	}
+
+	template <PointSelection point_selection>
+	PointCollection WindowedTripletDetector::GetNextTriplet_(void)
+	{
+		constexpr bool range_restricted		= point_selection >= POINT_SELECTION_FULLY_LABELED_DIST_RESTR;
+		constexpr bool a_from_same_label	= point_selection != POINT_SELECTION_FULLY_RANDOM && point_selection != POINT_SELECTION_FULLY_RANDOM_DIST_RESTR;
+		constexpr bool b_from_same_label	= point_selection == POINT_SELECTION_FULLY_LABELED || point_selection == POINT_SELECTION_FULLY_LABELED_DIST_RESTR;
+
+		// If triplets can still be collected.
+		if (Size() - m_point_index_.GetRemovedCount() > 3)
 		{
-			points_within_range.erase(std::remove_if(points_within_range.begin(), points_within_range.end(), [this, point_a](const std::pair<size_t, cv::Point2f*>& labeled_point)
+			const PointIndex::IndexedPoint& origin(GetRandomLabeledPoint$());
+			if constexpr (range_restricted)
 			{
-				return !IsPositionedWithinRadius_(*point_a.second, *labeled_point.second, this->parameters.max_point_distance) ||
-					IsPositionedWithinRadius_(*point_a.second, *labeled_point.second, this->parameters.min_point_distance);
-			}),
-			points_within_range.end());
+				return AcquireRangeRestrictedTriplet_<a_from_same_label, b_from_same_label>(origin);
+			}
+			else
+			{
+				return AcquireRandomTriplet_<a_from_same_label, b_from_same_label>(origin);
+			}
 		}
+		return PointCollection();
+	}
 
-		// Attempts to acquire Bravo within the range of Alpha.
-		if ((b_from_same_label && !label_points_within_range.empty()) || (!b_from_same_label && !points_within_range.empty()))
+	template <PointSelection point_selection>
+	void WindowedTripletDetector::GetNextTriplets_(TripletBatch& batch, const size_t count)
+	{
+		for (size_t triplet = 0; triplet < count; ++triplet)
 		{
-			point_b = b_from_same_label ? label_points_within_range[std::rand() % label_points_within_range.size()] : points_within_range[std::rand() % points_within_range.size()];
+			batch.Add(GetNextTriplet_<point_selection>());
 		}
+	}
 
-		PointCollection collection;
-		if (labeled_origin.second && point_a.second && point_b.second)
+	Line WindowedTripletDetector::CalculateTangent_(const PointIndex::IndexedPoint& indexed_point)
+	{
+		// The point references an element of the BLOB its points, which offers its index.
+		const cv::Point2f* first_point(m_labeled_blobs_[indexed_point.label]->GetPoints().data());
+		return m_blob_tangents_->at(indexed_point.label)[indexed_point.point - first_point];
+	}
+
+	void WindowedTripletDetector::CalculateAllTangents_(void)
+	{
+		// The map is filled with every key before the tangents are calculated, which allows the BLOBs to be processed
+		// concurrently without altering the structure of the map.
+		std::shared_ptr<std::unordered_map<size_t, std::vector<Line>>> blob_tangents(std::make_shared<std::unordered_map<size_t, std::vector<Line>>>());
+		std::vector<std::pair<const WSICS::BLOB_Operations::BLOB*, std::vector<Line>*>> pending_blobs;
+		for (const std::pair<const size_t, WSICS::BLOB_Operations::BLOB>& labeled_blob : m_blob_window_.GetAllMatrixBLOBs())
 		{
-			collection.points.push_back({ *labeled_origin.second, CalculateTangent_(labeled_origin) });
-			collection.points.push_back({ *point_a.second, CalculateTangent_(point_a) });
-			collection.points.push_back({ *point_b.second, CalculateTangent_(point_b) });
+			if (labeled_blob.second.Size() >= this->parameters.min_point_distance)
+			{
+				pending_blobs.push_back({ &labeled_blob.second, &(*blob_tangents)[labeled_blob.first] });
+			}
 		}
-		return collection;
+
+		auto calculate_tangents = [this, &pending_blobs](const size_t blob)
+		{
+			*pending_blobs[blob].second = CalculateBLOBTangents_(pending_blobs[blob].first->GetPoints());
+		};
+
+		if (m_thread_pool_ && m_thread_pool_->Size() > 0 && pending_blobs.size() > 1)
+		{
+			m_thread_pool_->ParallelFor(pending_blobs.size(), calculate_tangents);
+		}
+		else
+		{
+			for (size_t blob = 0; blob < pending_blobs.size(); ++blob)
+			{
+				calculate_tangents(blob);
+			}
+		}
+
+		m_blob_tangents_ = std::move(blob_tangents);
 	}
 
-	Line WindowedTripletDetector::CalculateTangent_(std::pair<size_t, cv::Point2f*>& point)
+	std::vector<Line> WindowedTripletDetector::CalculateBLOBTangents_(const WSICS::BLOB_Operations::PointSpan<const cv::Point2f>& blob_points)
 	{
+		float search_radius = std::fabs(this->parameters.tangent_search_radius);
+		size_t max_points	= static_cast<size_t>(this->parameters.tangent_search_radius * 2);
+		if (max_points == 0)
+		{
+			max_points = std::numeric_limits<size_t>::max();
+		}
+
+		std::vector<uint32_t> sorted_indices(blob_points.size());
+		std::iota(sorted_indices.begin(), sorted_indices.end(), 0);
+		std::stable_sort(sorted_indices.begin(), sorted_indices.end(), [&blob_points](const uint32_t lhs, const uint32_t rhs)
+		{
+			return blob_points[lhs].y < blob_points[rhs].y;
+		});
+
+		std::vector<Line> tangents(blob_points.size());
+		std::vector<uint32_t> neighbour_indices;
 		std::vector<cv::Point2f> points;
-		for (cv::Point2f& blob_point : m_labeled_blobs_[point.first]->GetPoints())
+		size_t band_start = 0;
+		for (uint32_t point_index : sorted_indices)
 		{
-			cv::Point2f difference(blob_point - *point.second);
+			const cv::Point2f& point(blob_points[point_index]);
+			while (point.y - blob_points[sorted_indices[band_start]].y > search_radius)
+			{
+				++band_start;
+			}
 
-			if (std::fabs(difference.x) < std::fabs(this->parameters.tangent_search_radius) && std::fabs(difference.y) < std::fabs(this->parameters.tangent_search_radius))
+			neighbour_indices.clear();
+			for (size_t band_index = band_start; band_index < sorted_indices.size() && blob_points[sorted_indices[band_index]].y - point.y <= search_radius; ++band_index)
 			{
-				points.push_back(blob_point);
+				cv::Point2f difference(blob_points[sorted_indices[band_index]] - point);
+				if (std::fabs(difference.x) < search_radius && std::fabs(difference.y) < search_radius)
+				{
+					neighbour_indices.push_back(sorted_indices[band_index]);
+				}
 			}
-			if (points.size() == static_cast<size_t>(this->parameters.tangent_search_radius * 2))
+
+			// Selects the neighbours that come first in the BLOB, which matches a scan over the unsorted points.
+			std::sort(neighbour_indices.begin(), neighbour_indices.end());
+			points.clear();
+			for (size_t neighbour = 0; neighbour < neighbour_indices.size() && neighbour < max_points; ++neighbour)
 			{
-				break;
+				points.push_back(blob_points[neighbour_indices[neighbour]]);
+			}
+
+			if (points.size() >= 2)
+			{
+				tangents[point_index] = Line(point, points);
 			}
 		}
 
-		if (points.size() >= 2)
+		return tangents;
+	}
+
+	std::pair<cv::Point2f, cv::Point2f> WindowedTripletDetector::GetBoundingBox_(const Ellipse& ellipse, const float squared_major_axis, const float squared_minor_axis)
+	{
+		float sin_theta = std::sin(ellipse.theta);
+		float cos_theta = std::cos(ellipse.theta);
+
+		// The half extents of a rotated ellipse, padded by a pixel to absorb rounding differences.
+		float half_width	= std::sqrt(squared_major_axis * cos_theta * cos_theta + squared_minor_axis * sin_theta * sin_theta) + 1;
+		float half_height	= std::sqrt(squared_major_axis * sin_theta * sin_theta + squared_minor_axis * cos_theta * cos_theta) + 1;
+
+		// Ellipses without a finite box fall back towards the entire grid.
+		if (!std::isfinite(half_width) || !std::isfinite(half_height) || !std::isfinite(ellipse.center.x) || !std::isfinite(ellipse.center.y))
 		{
-			return Line(*point.second, points);
+			float infinity = std::numeric_limits<float>::infinity();
+			return { cv::Point2f(-infinity, -infinity), cv::Point2f(infinity, infinity) };
 		}
-		return Line();
+
+		return { cv::Point2f(ellipse.center.x - half_width, ellipse.center.y - half_height), cv::Point2f(ellipse.center.x + half_width, ellipse.center.y + half_height) };
 	}
 
 	void WindowedTripletDetector::CheckValidAccess_(void)
@@ -342,70 +505,61 @@ namespace WSICS::HoughTransform
 		}
 	}
 
-	std::vector<std::pair<size_t, cv::Point2f*>> WindowedTripletDetector::GetPointsFromRadius_(const cv::Point2f& center)
+	void WindowedTripletDetector::GetPointsFromRadius_(const cv::Point2f& center, std::vector<uint32_t>& output)
 	{
-		std::vector<std::pair<size_t, cv::Point2f*>> points_within_radius;
-		for (std::pair<const size_t, std::vector<cv::Point2f*>>& labeled_points : m_labeled_points_)
-		{
-			for (cv::Point2f* point : labeled_points.second)
-			{
-				if (IsPositionedWithinRadius_(center, *point, this->parameters.max_point_distance) && !IsPositionedWithinRadius_(center, *point, this->parameters.min_point_distance))
-				{
-					points_within_radius.push_back({ labeled_points.first, point });
-				}
-			}
-		}
-		return points_within_radius;
+		output.clear();
+		m_point_index_.QueryAnnulus(center, this->parameters.min_point_distance, this->parameters.max_point_distance, output);
 	}
 
-	std::vector<std::pair<size_t, cv::Point2f*>> WindowedTripletDetector::GetPointsFromRadius_(const cv::Point2f& center, const size_t label)
+	void WindowedTripletDetector::GetPointsFromRadius_(const cv::Point2f& center, const size_t label, std::vector<uint32_t>& output)
 	{
-		std::vector<std::pair<size_t, cv::Point2f*>> points_within_radius;
-		for (cv::Point2f* point : m_labeled_points_[label])
-		{
-			if (IsPositionedWithinRadius_(center, *point, this->parameters.max_point_distance) && !IsPositionedWithinRadius_(center, *point, this->parameters.min_point_distance))
-			{
-				points_within_radius.push_back({ label, point });
-			}
-		}
-		return points_within_radius;
+		output.clear();
+		m_point_index_.QueryAnnulus(center, this->parameters.min_point_distance, this->parameters.max_point_distance, label, output);
 	}
 
-	// TODO: Move intoa geometry type namespace.
-	bool WindowedTripletDetector::IsPositionedWithinRadius_(const cv::Point2f& center, cv::Point2f& position, const float radius)
+	void WindowedTripletDetector::ClearWindowInformation_(void)
 	{
-		return std::pow(center.x - position.x, 2) + std::pow(center.y - position.y, 2) < std::pow(radius, 2);
+		m_labeled_blobs_.clear();
+		m_labeled_points_.clear();
+		m_current_labels_.clear();
+		m_altered_labels_.clear();
+		m_point_index_.Clear();
+		m_total_window_points_ = 0;
 	}
 
-	void WindowedTripletDetector::RemoveLabeledPoint_(std::pair<size_t, cv::Point2f*>& labeled_point)
+	void WindowedTripletDetector::RemoveLabeledPoint_(const PointIndex::IndexedPoint& labeled_point)
 	{
-		m_deleted_points_.insert(labeled_point.second);
+		m_point_index_.Remove(labeled_point.id);
+		m_altered_labels_.push_back(labeled_point.label);
 
-		std::vector<cv::Point2f*>& labeled_points_vector(m_labeled_points_.at(labeled_point.first));
-		labeled_points_vector.erase(std::remove(labeled_points_vector.begin(), labeled_points_vector.end(), labeled_point.second), labeled_points_vector.end());
+		std::vector<uint32_t>& labeled_points_vector(m_labeled_points_.at(labeled_point.label));
+		labeled_points_vector.erase(std::remove(labeled_points_vector.begin(), labeled_points_vector.end(), labeled_point.id), labeled_points_vector.end());
 
 		if (labeled_points_vector.empty())
 		{
-			m_labeled_points_.erase(labeled_point.first);
-			m_current_labels_.erase(std::remove(m_current_labels_.begin(), m_current_labels_.end(), labeled_point.first), m_current_labels_.end());
+			m_labeled_points_.erase(labeled_point.label);
+			m_current_labels_.erase(std::remove(m_current_labels_.begin(), m_current_labels_.end(), labeled_point.label), m_current_labels_.end());
 		}
 	}
 
 	void WindowedTripletDetector::UpdateWindowInformation_(void)
 	{
-		// Clears the containers that will need to rebuild their information.
-		m_total_window_points_ = 0;
-		m_deleted_points_.clear();
-		m_labeled_points_.clear();
-		m_current_labels_.clear();
-
-		// Replaces the BLOB container.
-		m_labeled_blobs_ = m_blob_window_.GetWindowBLOBs();
+		// Replaces the random stream, which is keyed on the window index.
+		m_generator_ = Misc::Random::CreateStream(m_seed_, m_blob_window_.GetWindowIndex());
 
 		// Filters BLOBs that don't contain the min amount of points to draw at least the this->parameters.min_point_distance between two points.
+		std::vector<size_t> window_labels(m_blob_window_.GetWindowLabels());
+		window_labels.erase(std::remove_if(window_labels.begin(), window_labels.end(), [this](const size_t label)
+		{
+			return m_blob_window_.GetBLOB(label).Size() < this->parameters.min_point_distance;
+		}),
+		window_labels.end());
+
+		// Removes the BLOBs that left the window, as well as the BLOBs whose points have been removed by Simplify.
 		for (auto it = m_labeled_blobs_.begin(); it != m_labeled_blobs_.end();)
 		{
-			if (it->second->Size() < this->parameters.min_point_distance)
+			if (!std::binary_search(window_labels.begin(), window_labels.end(), it->first) ||
+				std::find(m_altered_labels_.begin(), m_altered_labels_.end(), it->first) != m_altered_labels_.end())
 			{
 				it = m_labeled_blobs_.erase(it);
 			}
@@ -414,24 +568,27 @@ namespace WSICS::HoughTransform
 				++it;
 			}
 		}
+		m_altered_labels_.clear();
 
-		// Initializes the list of labels, which is used by the randomize function to select a random point.
-		m_labeled_points_.reserve(m_labeled_blobs_.size());
-		m_current_labels_.reserve(m_labeled_blobs_.size());
-		for (std::pair<const size_t, WSICS::BLOB_Operations::BLOB*>& labeled_blob : m_labeled_blobs_)
+		// Adds the BLOBs that entered the window, while the BLOBs that remained keep their information.
+		m_total_window_points_ = 0;
+		for (size_t label : window_labels)
 		{
-			m_labeled_points_.insert({ labeled_blob.first, std::vector<cv::Point2f*>() });
-			m_current_labels_.push_back(labeled_blob.first);
-
-			// Inserts pointers towards the blob points into the labeled vectors.
-			std::vector<cv::Point2f>& blob_points(labeled_blob.second->GetPoints());
-			m_labeled_points_[labeled_blob.first].reserve(blob_points.size());
-			for (cv::Point2f& point : blob_points)
+			auto labeled_blob = m_labeled_blobs_.find(label);
+			if (labeled_blob == m_labeled_blobs_.end())
 			{
-				m_labeled_points_[labeled_blob.first].push_back(&point);
+				labeled_blob = m_labeled_blobs_.insert({ label, &m_blob_window_.GetBLOB(label) }).first;
 			}
 
-			m_total_window_points_ += blob_points.size();
+			m_total_window_points_ += labeled_blob->second->Size();
 		}
+
+		// Initializes the list of labels, which is used by the randomize function to select a random point. The labels
+		// are kept in ascending order, which keeps the selection independent of the previously visited windows.
+		m_current_labels_ = std::move(window_labels);
+
+		// The grid cells match the largest query radius, limiting each query to the surrounding 3x3 cells. Every
+		// point receives a new id, which therefore also resets the labeled points.
+		m_point_index_.Build(m_current_labels_, m_labeled_blobs_, this->parameters.max_point_distance, m_labeled_points_);
 	}
 }
\ No newline at end of file
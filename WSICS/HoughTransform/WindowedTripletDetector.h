@@ -1,12 +1,18 @@
 #ifndef __WSICS_HOUGHTRANSFORM_WINDOWEDTRIPLETDETECTOR__
 #define __WSICS_HOUGHTRANSFORM_WINDOWEDTRIPLETDETECTOR__
 
+#include <memory>
+#include <unordered_map>
 #include <vector>
-#include <unordered_set>
+
+#include <boost/random/mersenne_twister.hpp>
 
 #include "../BLOB_Operations/BLOB_Window.h"
+#include "../Misc/ThreadPool.h"
 #include "Ellipse.h"
 #include "PointCollection.h"
+#include "PointIndex.h"
+#include "TripletBatch.h"
 
 namespace WSICS::HoughTransform
 {
@@ -40,6 +46,10 @@ namespace WSICS::HoughTransform
 
 	/// <summary>
 	/// Divides a binary matrix into subwindows and then retrieves triplets on it.
+	///
+	/// The BLOBs and their tangents are immutable once initialized, and are shared between copies of a detector.
+	/// The window information only references the shared BLOBs, which allows a copy to adopt it as is. Copying a
+	/// detector therefore costs no more than copying the state of its current window.
 	/// </summary>
     class WindowedTripletDetector
     {
@@ -84,6 +94,13 @@ namespace WSICS::HoughTransform
 			/// </summary>
 			/// <returns>A PointCollection with three entries, defining a triplet.</returns>
 			PointCollection GetNextTriplet(void);
+			/// <summary>
+			/// Acquires a series of triplets from the current window and adds them to the batch. The point selection is
+			/// resolved once for the entire series, rather than for each triplet.
+			/// </summary>
+			/// <param name="batch">The batch to add the triplets to.</param>
+			/// <param name="count">The amount of triplets to acquire, limited by the capacity of the batch.</param>
+			void GetNextTriplets(TripletBatch& batch, const size_t count);
 			void Clear(void);
 			/// <summary>
 			/// Shifts the window to the next region, updating its information to reflect such.
@@ -95,6 +112,27 @@ namespace WSICS::HoughTransform
 			/// </summary>
 			void Reset(void);
 			/// <summary>
+			/// Places the window at the passed index, updating its internal state to reflect such.
+			/// </summary>
+			/// <param name="window_index">The index of the window, counted in the order in which Next visits them.</param>
+			void MoveTo(const size_t window_index);
+			/// <summary>
+			/// Returns the amount of windows the matrix is divided into.
+			/// </summary>
+			/// <returns>The amount of windows.</returns>
+			size_t GetWindowCount(void) const;
+			/// <summary>
+			/// Sets the seed from which the random stream of each window is derived. Each window acquires its own
+			/// stream based on its index, ensuring the selected triplets don't depend on the order of processing.
+			/// </summary>
+			/// <param name="seed">The seed to derive the window streams from.</param>
+			void SetSeed(const uint64_t seed);
+			/// <summary>
+			/// Sets the pool used to calculate the tangents of the BLOBs during initialization. Without a pool, the tangents are calculated serially.
+			/// </summary>
+			/// <param name="thread_pool">The pool to distribute the BLOBs over, or a nullptr.</param>
+			void SetThreadPool(Misc::ThreadPool* thread_pool);
+			/// <summary>
 			/// Reduces the amount of points around the passed ellipse.
 			/// </summary>
 			/// <param name="ellipse">The elipse around which to search and delete points.</param>
@@ -126,47 +164,97 @@ namespace WSICS::HoughTransform
 			/// <summary>
 			/// Acquires a random labeled point from the current window.
 			/// </summary>
-			/// <returns>A pairing with the BLOB label and a pointer towards the point.</returns>
-			inline std::pair<size_t, cv::Point2f*> GetRandomLabeledPoint$(void);
+			/// <returns>The indexed point, which holds its BLOB label.</returns>
+			inline const PointIndex::IndexedPoint& GetRandomLabeledPoint$(void);
 			/// <summary>
 			/// Acquires a random labeled point from a BLOB within the window.
 			/// </summary>
 			/// <param name="label">The label of the BLOB to select the point from.</param>
-			/// <returns>A pairing with the BLOB label and a pointer towards the point.</returns>
-			inline std::pair<size_t, cv::Point2f*> GetRandomLabeledPoint$(const size_t label);
+			/// <returns>The indexed point, which holds its BLOB label.</returns>
+			inline const PointIndex::IndexedPoint& GetRandomLabeledPoint$(const size_t label);
 
 		private:
-			std::unordered_map<size_t, WSICS::BLOB_Operations::BLOB*>	m_labeled_blobs_;
-			std::unordered_set<cv::Point2f*>							m_deleted_points_;
-			std::unordered_map<size_t, std::vector<cv::Point2f*>>		m_labeled_points_;
-			std::vector<size_t>											m_current_labels_;
+			std::unordered_map<size_t, const WSICS::BLOB_Operations::BLOB*>			m_labeled_blobs_;
+			std::unordered_map<size_t, std::vector<uint32_t>>						m_labeled_points_;
+			std::vector<size_t>														m_current_labels_;
+			std::vector<size_t>														m_altered_labels_;
+			std::shared_ptr<const std::unordered_map<size_t, std::vector<Line>>>	m_blob_tangents_;
+			PointIndex																m_point_index_;
+			std::vector<uint32_t>													m_label_points_within_range_;
+			std::vector<uint32_t>													m_points_within_range_;
+
+			WSICS::BLOB_Operations::BLOB_Window										m_blob_window_;
+			size_t																	m_total_window_points_;
 
-			WSICS::BLOB_Operations::BLOB_Window							m_blob_window_;
-			size_t														m_total_window_points_;
+			uint64_t																m_seed_;
+			boost::mt19937_64														m_generator_;
+			Misc::ThreadPool*														m_thread_pool_;
 
 			/// <summary>
 			/// Acquires a triplet fully randomly.
 			/// </summary>
-			/// <param name="a_from_same_label">Whether or not Alpha should be selected from the origin label.</param>
-			/// <param name="b_from_same_label">Whether or not Bravo should be selected from the origin label.</param>
+			/// <typeparam name="a_from_same_label">Whether or not Alpha should be selected from the origin label.</typeparam>
+			/// <typeparam name="b_from_same_label">Whether or not Bravo should be selected from the origin label.</typeparam>
 			/// <param name="labeled_origin">The origin point for the triplet.</param>
 			/// <returns>A PointCollection with three entries, defining a triplet.</returns>
-			PointCollection AcquireRandomTriplet_(const bool a_from_same_label, const bool b_from_same_label, std::pair<size_t, cv::Point2f*>& labeled_origin);
+			template <bool a_from_same_label, bool b_from_same_label>
+			PointCollection AcquireRandomTriplet_(const PointIndex::IndexedPoint& labeled_origin);
 			/// <summary>
 			/// Acquires a triplet where each point is within the max and min distance of each other.
 			/// </summary>
-			/// <param name="a_from_same_label">Whether or not Alpha should be selected from the origin label.</param>
-			/// <param name="b_from_same_label">Whether or not Bravo should be selected from the origin label.</param>
+			/// <typeparam name="a_from_same_label">Whether or not Alpha should be selected from the origin label.</typeparam>
+			/// <typeparam name="b_from_same_label">Whether or not Bravo should be selected from the origin label.</typeparam>
 			/// <param name="labeled_origin">The origin point for the triplet.</param>
 			/// <returns>A PointCollection with three entries, defining a triplet.</returns>
-			PointCollection AcquireRangeRestrictedTriplet_(const bool a_from_same_label, const bool b_from_same_label, std::pair<size_t, cv::Point2f*>& labeled_origin);
+			template <bool a_from_same_label, bool b_from_same_label>
+			PointCollection AcquireRangeRestrictedTriplet_(const PointIndex::IndexedPoint& labeled_origin);
+			/// <summary>
+			/// Acquires a triplet from the current window, with the point selection resolved at compile time.
+			/// </summary>
+			/// <typeparam name="point_selection">The method used to select the points.</typeparam>
+			/// <returns>A PointCollection with three entries, defining a triplet.</returns>
+			template <PointSelection point_selection>
+			PointCollection GetNextTriplet_(void);
+			/// <summary>
+			/// Acquires a series of triplets from the current window, with the point selection resolved at compile time.
+			/// </summary>
+			/// <typeparam name="point_selection">The method used to select the points.</typeparam>
+			/// <param name="batch">The batch to add the triplets to.</param>
+			/// <param name="count">The amount of triplets to acquire.</param>
+			template <PointSelection point_selection>
+			void GetNextTriplets_(TripletBatch& batch, const size_t count);
 
 			/// <summary>
-			/// Calculates the tangent of a point, based on its member labled BLOB points.
+			/// Clears the information held about the BLOBs within the current window.
+			/// </summary>
+			void ClearWindowInformation_(void);
+			/// <summary>
+			/// Returns the precomputed tangent of a point.
 			/// </summary>
-			/// <param name="point">The point to base the tangent on.</param>
+			/// <param name="indexed_point">The point to acquire the tangent for.</param>
 			/// <returns>The tangent as a line object.</returns>
-			Line CalculateTangent_(std::pair<size_t, cv::Point2f*>& point);
+			Line CalculateTangent_(const PointIndex::IndexedPoint& indexed_point);
+			/// <summary>
+			/// Calculates the tangents of every BLOB that holds enough points to be considered by the windows.
+			/// </summary>
+			void CalculateAllTangents_(void);
+			/// <summary>
+			/// Calculates the tangent of each point of a BLOB, by fitting a line through the first points of the BLOB
+			/// that lie within the tangent search radius. The points are sorted on their y coordinate, which limits
+			/// the search for each point to a band of rows.
+			/// </summary>
+			/// <param name="blob_points">The points of the BLOB.</param>
+			/// <returns>The tangents, in the same order as the points.</returns>
+			std::vector<Line> CalculateBLOBTangents_(const WSICS::BLOB_Operations::PointSpan<const cv::Point2f>& blob_points);
+
+			/// <summary>
+			/// Calculates the axis aligned bounding box of an ellipse, whose axes have been enlarged or shrunk.
+			/// </summary>
+			/// <param name="ellipse">The ellipse to acquire the box for, which provides the center and rotation.</param>
+			/// <param name="squared_major_axis">The squared length of the major axis.</param>
+			/// <param name="squared_minor_axis">The squared length of the minor axis.</param>
+			/// <returns>The top left and bottom right corners of the box.</returns>
+			static std::pair<cv::Point2f, cv::Point2f> GetBoundingBox_(const Ellipse& ellipse, const float squared_major_axis, const float squared_minor_axis);
 
 			/// <summary>
 			/// Checks if the object has been properly initialized, throws an exception on failure.
@@ -177,27 +265,19 @@ namespace WSICS::HoughTransform
 			/// Acquires points within the max radius around center and not within the min.
 			/// </summary>
 			/// <param name="center">The center point around which to project the radii.</param>
-			/// <returns>A vector containing the points that fit the criteria</returns>
-			std::vector<std::pair<size_t, cv::Point2f*>> GetPointsFromRadius_(const cv::Point2f& center);
+			/// <param name="output">The buffer that will hold the ids of the points that fit the criteria, its capacity is reused.</param>
+			void GetPointsFromRadius_(const cv::Point2f& center, std::vector<uint32_t>& output);
 			/// <summary>
 			/// Acquires points from a single label within the max radius around center and not within the min.
 			/// </summary>
 			/// <param name="center">The center point around which to project the radii.</param>
 			/// <param name="label">The label attached to the BLOB from which the points should be selected.</param>
-			/// <returns>A vector containing the points that fit the criteria.</returns>
-			std::vector<std::pair<size_t, cv::Point2f*>> GetPointsFromRadius_(const cv::Point2f& center, const size_t label);
-			/// <summary>
-			/// Returns whether or not the position is located within the radius around the center.
-			/// </summary>
-			/// <param name="center">The center point around which the radius will be projected.</param>
-			/// <param name="position">The position to check against the center radius.</param>
-			/// <param name="radius">The radius to use for the calculation.</param>
-			/// <returns>Whether or not point is within the radius around center.</returns>
-			bool IsPositionedWithinRadius_(const cv::Point2f& center, cv::Point2f& position, const float radius);
-
-			void RemoveLabeledPoint_(std::pair<size_t, cv::Point2f*>& labeled_point);
+			/// <param name="output">The buffer that will hold the ids of the points that fit the criteria, its capacity is reused.</param>
+			void GetPointsFromRadius_(const cv::Point2f& center, const size_t label, std::vector<uint32_t>& output);
+			void RemoveLabeledPoint_(const PointIndex::IndexedPoint& labeled_point);
 			/// <summary>
-			/// Rebuilds the window information based on the current state of the object.
+			/// Updates the window information based on the current state of the object. Only the BLOBs that entered the
+			/// window, or whose points were removed, are processed. The point index and the point ids are rebuilt entirely.
 			/// </summary>
 			void UpdateWindowInformation_(void);
     };
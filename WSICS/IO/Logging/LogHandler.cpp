@@ -73,6 +73,20 @@ namespace WSICS::IO::Logging
 		m_output_level_access_.unlock();
 	}
 
+	void LogHandler::QueueFileLogging(const std::string message, const std::string& line_prefix, const size_t file_id, const LogLevel level)
+	{
+		std::string prefixed_message(line_prefix);
+		for (const char character : message)
+		{
+			prefixed_message += character;
+			if (character == '\n')
+			{
+				prefixed_message += line_prefix;
+			}
+		}
+		QueueFileLogging(prefixed_message, file_id, level);
+	}
+
 	void LogHandler::QueueCommandLineLogging(const std::string message, const LogLevel level)
 	{
 		m_output_level_access_.lock();
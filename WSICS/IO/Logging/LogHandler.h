@@ -71,6 +71,12 @@ namespace WSICS::IO::Logging
 			/// <param name="file_id">The id of the file to write to.</param>
 			/// <param name="level">The level at which this should be written.</param>
 			void QueueFileLogging(const std::string message, const size_t file_id, const LogLevel level);
+			/// <summary>Queue's a message for a log file, inserting a prefix before each of its lines.</summary>
+			/// <param name="message">The message to write to the file.</param>
+			/// <param name="line_prefix">The prefix, which identifies the source of the message when several sources share a file.</param>
+			/// <param name="file_id">The id of the file to write to.</param>
+			/// <param name="level">The level at which this should be written.</param>
+			void QueueFileLogging(const std::string message, const std::string& line_prefix, const size_t file_id, const LogLevel level);
 			/// <summary>Queue's a message for the command line.</summary>
 			/// <param name="message">The message to write to the command line.</param>
 			/// <param name="level">The level at which this should be written.</param>
@@ -1,35 +1,18 @@
 #include "LevelReading.h"
 
+#include <algorithm>
+#include <cmath>
 #include <memory>
+#include <stdexcept>
 
-namespace WSICS::Misc::LevelReading
-{
-	size_t ArrayToMatrix(unsigned char* data, cv::Mat& output, const bool consider_background)
-	{
-		size_t background_count = 0;
-		size_t base_index = 0;
-		for (int row = 0; row < output.rows; ++row)
-		{
-			uchar* row_ptr = output.ptr(row);
-			for (int col = 0; col < output.cols; ++col)
-			{
-				*row_ptr		= data[base_index + 2];
-				*(row_ptr + 1)	= data[base_index + 1];
-				*(row_ptr + 2)	= data[base_index];
-				row_ptr += 3;
+#include "multiresolutionimageinterface/MultiResolutionImageReader.h"
 
-				// Threshold was 230 for mrxs files
-				if (consider_background && ((data[base_index] > 200 && data[base_index + 1] > 200 && data[base_index + 2] > 200) || (data[base_index] == 0 && data[base_index + 1] == 0 && data[base_index + 2] == 0)))
-				{
-					++background_count;
-				}
-
-				base_index += 3;
-			}
-		}
+#include "TileReader.h"
 
-		return background_count;
-	}
+namespace WSICS::Misc::LevelReading
+{
+	// The smallest amount of candidates worth opening an additional image handle for.
+	const size_t minimum_chunk_size = 64;
 
 	std::vector<cv::Point> GetNextLevelCoordinates(std::vector<cv::Point>& current_level_coordinates, uint32_t tile_size, int32_t scale_diff)
 	{
@@ -58,61 +41,151 @@ namespace WSICS::Misc::LevelReading
 		const uint32_t tile_size,
 		const uint32_t level,		
 		const uint32_t skip_factor,
-		const float background_threshold)
+		const float background_threshold,
+		const boost::filesystem::path& input_file,
+		ThreadPool* thread_pool)
+	{
+		std::vector<cv::Point> candidate_coordinates;
+		for (int y = 0; y < y_dimension; y += (tile_size)* skip_factor)
+		{
+			for (int x = 0; x < x_dimension; x += tile_size)
+			{
+				candidate_coordinates.push_back({ x, y });
+			}
+		}
+
+		return FilterTissueTiles(tiled_image, candidate_coordinates, tile_size, level, background_threshold, input_file, thread_pool);
+	}
+
+	std::vector<cv::Point> ReadLevelTiles(
+		MultiResolutionImage& tiled_image,
+		std::vector<cv::Point> current_tile_coordinates,
+		const uint32_t tile_size,
+		const uint32_t level,
+		const uint32_t skip_factor,
+		const int32_t scale_diff,
+		const float background_threshold,
+		const boost::filesystem::path& input_file,
+		ThreadPool* thread_pool,
+		const TissueIndex* tissue_index)
 	{
-		unsigned char* data(nullptr);
+		std::vector<cv::Point> next_level_tile_coordinates(GetNextLevelCoordinates(current_tile_coordinates, tile_size, scale_diff));
 
-		cv::Mat tile_image(cv::Mat::zeros(tile_size, tile_size, CV_8UC3));
+		// Discards candidates whose footprint holds no tissue within the index, which saves reading them. The
+		// footprint is widened by a pixel, to account for tissue that disappeared while downsampling. Faint tissue
+		// spanning a larger area can still average out into background on the indexed level, and is then discarded
+		// even though this level's threshold might have accepted it.
+		const double downsample = tiled_image.getLevelDownsample(level);
+
+		std::vector<cv::Point> candidate_coordinates;
+		candidate_coordinates.reserve(next_level_tile_coordinates.size() / skip_factor + 1);
+		for (int i = 0; i < next_level_tile_coordinates.size(); i += skip_factor)
+		{
+			if (tissue_index)
+			{
+				cv::Rect footprint(tissue_index->ToIndexRegion(next_level_tile_coordinates[i].x, next_level_tile_coordinates[i].y, tile_size, tile_size, downsample));
+				footprint -= cv::Point(1, 1);
+				footprint += cv::Size(2, 2);
+				if (!tissue_index->ContainsTissue(footprint))
+				{
+					continue;
+				}
+			}
+			candidate_coordinates.push_back(next_level_tile_coordinates[i]);
+		}
+
+		return FilterTissueTiles(tiled_image, candidate_coordinates, tile_size, level, background_threshold, input_file, thread_pool);
+	}
+
+	std::vector<cv::Point> SelectIndexedTiles(
+		const TissueIndex& tissue_index,
+		const size_t x_dimension,
+		const size_t y_dimension,
+		const uint32_t tile_size,
+		const uint32_t skip_factor,
+		const float background_threshold)
+	{
+		// Pixels beyond the level count as background, just as the zeroed pixels that are read from beyond the image.
+		const uint64_t tile_area = static_cast<uint64_t>(tile_size) * tile_size;
 
 		std::vector<cv::Point> tile_coordinates;
 		for (int y = 0; y < y_dimension; y += (tile_size)* skip_factor)
 		{
 			for (int x = 0; x < x_dimension; x += tile_size)
 			{
-				tiled_image.getRawRegion(x  *tiled_image.getLevelDownsample(level), y * tiled_image.getLevelDownsample(level), tile_size, tile_size, level, data);
-
-				size_t background_count = ArrayToMatrix(data, tile_image, true);
-				if ((float)background_count / (tile_size * tile_size) < background_threshold)
+				size_t background_count = tile_area - tissue_index.CountTissuePixels(cv::Rect(x, y, tile_size, tile_size));
+				if ((float)background_count / tile_area < background_threshold)
 				{
 					tile_coordinates.push_back({ x, y });
 				}
 			}
 		}
 
-		delete[] data;
-
 		return tile_coordinates;
 	}
 
-	std::vector<cv::Point> ReadLevelTiles(
+	std::vector<cv::Point> FilterTissueTiles(
 		MultiResolutionImage& tiled_image,
-		std::vector<cv::Point> current_tile_coordinates,
+		const std::vector<cv::Point>& candidate_coordinates,
 		const uint32_t tile_size,
 		const uint32_t level,
-		const uint32_t skip_factor,
-		const int32_t scale_diff,
-		const float background_threshold)
+		const float background_threshold,
+		const boost::filesystem::path& input_file,
+		ThreadPool* thread_pool)
 	{
-		unsigned char* data(nullptr);
+		const double downsample = tiled_image.getLevelDownsample(level);
 
-		cv::Mat tile_image(cv::Mat::zeros(tile_size, tile_size, CV_8UC3));
+		// Stores the verdict per candidate, which keeps the order of the results independent of the scheduling.
+		std::vector<unsigned char> contains_tissue(candidate_coordinates.size(), 0);
+		auto process_range = [&](MultiResolutionImage& image, const size_t begin, const size_t end)
+		{
+			TileReader reader(image, tile_size);
+			for (size_t candidate = begin; candidate < end; ++candidate)
+			{
+				reader.Read(candidate_coordinates[candidate].x * downsample, candidate_coordinates[candidate].y * downsample, level);
 
-		std::vector<cv::Point> next_level_tile_coordinates(GetNextLevelCoordinates(current_tile_coordinates, tile_size, scale_diff));
+				size_t background_count = reader.CountBackgroundPixels();
+				contains_tissue[candidate] = (float)background_count / (tile_size * tile_size) < background_threshold;
+			}
+		};
 
-		std::vector<cv::Point> tile_coordinates;
-		for (int i = 0; i < next_level_tile_coordinates.size(); i += skip_factor)
+		// Splits the candidates into contiguous chunks, each read through its own image handle. A few chunks per
+		// thread balance the load, while keeping the amount of opened handles small.
+		size_t chunk_count = 1;
+		if (thread_pool && !input_file.empty())
+		{
+			chunk_count = std::min(candidate_coordinates.size() / minimum_chunk_size, (thread_pool->Size() + 1) * 4);
+		}
+
+		if (chunk_count <= 1)
+		{
+			process_range(tiled_image, 0, candidate_coordinates.size());
+		}
+		else
 		{
-			tiled_image.getRawRegion(next_level_tile_coordinates[i].x * tiled_image.getLevelDownsample(level), next_level_tile_coordinates[i].y * tiled_image.getLevelDownsample(level), tile_size, tile_size, level, data);
+			const size_t chunk_size = (candidate_coordinates.size() + chunk_count - 1) / chunk_count;
+			thread_pool->ParallelFor(chunk_count, [&](const size_t chunk)
+			{
+				MultiResolutionImageReader image_reader;
+				std::unique_ptr<MultiResolutionImage> image(image_reader.open(input_file.string()));
+				if (!image)
+				{
+					throw std::runtime_error("Unable to open file: " + input_file.string());
+				}
 
-			size_t background_count = ArrayToMatrix(data, tile_image, true);
-			if ((float)background_count / (tile_size * tile_size) < background_threshold)
+				process_range(*image, chunk * chunk_size, std::min((chunk + 1) * chunk_size, candidate_coordinates.size()));
+			});
+		}
+
+		std::vector<cv::Point> tile_coordinates;
+		for (size_t candidate = 0; candidate < candidate_coordinates.size(); ++candidate)
+		{
+			if (contains_tissue[candidate])
 			{
-				tile_coordinates.push_back(next_level_tile_coordinates[i]);
+				tile_coordinates.push_back(candidate_coordinates[candidate]);
 			}
 		}
 
-		delete[] data;
-
 		return tile_coordinates;
 	}
 }
\ No newline at end of file
@@ -1,23 +1,19 @@
 #ifndef __WSICS_MISC_LEVELREADING__
 #define __WSICS_MISC_LEVELREADING__
 
+#include <boost/filesystem.hpp>
 #include <opencv2/core/core.hpp>
 
 #include "multiresolutionimageinterface/MultiResolutionImage.h"
 
+#include "ThreadPool.h"
+#include "TissueIndex.h"
+
 /// <summary>
 ///
 /// </summary>
 namespace WSICS::Misc::LevelReading
 {
-	/// <summary>
-	/// Inserts the data from a vector or array into an OpenCV matrix. Assumes the vector or array are at least compareable to the matrix in terms of size.
-	/// </summary>
-	/// <param name="data">The starting element of a vector or array.</param>
-	/// <param name="output">The matrix to transfer the data to.</param>
-	/// <param name="consider_background">Whether or not to make an attempt at background pixel counting.</param>
-	/// <returns>The counted background pixels, if applicable. Otherwise, 0.</returns>
-	size_t ArrayToMatrix(unsigned char* data, cv::Mat& output, const bool consider_background);
 	/// <summary>
 	/// Acquires the tile coordinates for the next level within the pyramid.
 	/// </summary>
@@ -36,6 +32,9 @@ namespace WSICS::Misc::LevelReading
 	/// <param name="level">The level to select the coordinates for.</param>
 	/// <param name="skip_factor">Is added to each iterator of the coordinate search. Enabling reduction in the coherence of coordinate selection.</param>
 	/// <param name="background_threshold">The pixel value to consider background, and thus not include.</param>
+	/// <param name="input_file">The path towards the image, used to open a handle per chunk of tiles. If empty, tiled_image is read serially.</param>
+	/// <param name="thread_pool">The pool to distribute the tiles over, or a nullptr to read serially.</param>
+	/// <param name="tissue_index">An index used to discard candidates without tissue before reading them, or a nullptr to read every candidate. As the index describes a coarser level, it may discard faint tissue that this level's threshold would have accepted.</param>
 	/// <returns>A vector containing the selected tile coordinates.</returns>
 	std::vector<cv::Point> ReadLevelTiles(
 		MultiResolutionImage& tiled_image,
@@ -44,7 +43,10 @@ namespace WSICS::Misc::LevelReading
 		const uint32_t level,
 		const uint32_t skip_factor,
 		const int32_t scale_diff,
-		const float background_threshold);
+		const float background_threshold,
+		const boost::filesystem::path& input_file,
+		ThreadPool* thread_pool,
+		const TissueIndex* tissue_index);
 	/// <summary>
 	/// Acquires the tile coordinates based on the immediate next level.
 	/// </summary>
@@ -55,6 +57,8 @@ namespace WSICS::Misc::LevelReading
 	/// <param name="skip_factor">Is added to each iterator of the coordinate search. Enabling reduction in the coherence of coordinate selection.</param>
 	/// <param name="scale_diff">The scale difference each level.</param>
 	/// <param name="background_threshold">he pixel value to consider background, and thus not include.</param>
+	/// <param name="input_file">The path towards the image, used to open a handle per chunk of tiles. If empty, tiled_image is read serially.</param>
+	/// <param name="thread_pool">The pool to distribute the tiles over, or a nullptr to read serially.</param>
 	/// <returns>A vector containing the selected tile coordinates.</returns>
 	std::vector<cv::Point> ReadLevelTiles(
 		MultiResolutionImage& tiled_image,
@@ -63,6 +67,47 @@ namespace WSICS::Misc::LevelReading
 		const uint32_t tile_size,
 		const uint32_t level,
 		const uint32_t skip_factor,
+		const float background_threshold,
+		const boost::filesystem::path& input_file,
+		ThreadPool* thread_pool);
+	/// <summary>
+	/// Acquires the tile coordinates for the level the tissue index was built from, without reading the image.
+	/// Produces the same selection as ReadLevelTiles would for that level.
+	/// </summary>
+	/// <param name="tissue_index">The index to select the tiles with.</param>
+	/// <param name="x_dimension">The size of the x dimension to search within.</param>
+	/// <param name="y_dimension">The size of the y dimension to search within,</param>
+	/// <param name="tile_size">The size of each tile.</param>
+	/// <param name="skip_factor">Is added to each iterator of the coordinate search. Enabling reduction in the coherence of coordinate selection.</param>
+	/// <param name="background_threshold">The fraction of background pixels from which a tile is rejected.</param>
+	/// <returns>A vector containing the selected tile coordinates.</returns>
+	std::vector<cv::Point> SelectIndexedTiles(
+		const TissueIndex& tissue_index,
+		const size_t x_dimension,
+		const size_t y_dimension,
+		const uint32_t tile_size,
+		const uint32_t skip_factor,
 		const float background_threshold);
+	/// <summary>
+	/// Selects the candidate tiles that contain tissue. The candidates are distributed over the thread pool
+	/// in contiguous chunks, each of which opens its own handle to the image. The selected coordinates
+	/// retain the order of the candidates, regardless of the scheduling.
+	/// </summary>
+	/// <param name="tiled_image">The tiled image to extract pixel information from, when reading serially.</param>
+	/// <param name="candidate_coordinates">The coordinates of the tiles to test.</param>
+	/// <param name="tile_size">The size of each tile.</param>
+	/// <param name="level">The level to read the tiles from.</param>
+	/// <param name="background_threshold">The fraction of background pixels from which a tile is rejected.</param>
+	/// <param name="input_file">The path towards the image, used to open a handle per chunk of tiles. If empty, tiled_image is read serially.</param>
+	/// <param name="thread_pool">The pool to distribute the tiles over, or a nullptr to read serially.</param>
+	/// <returns>A vector containing the selected tile coordinates.</returns>
+	std::vector<cv::Point> FilterTissueTiles(
+		MultiResolutionImage& tiled_image,
+		const std::vector<cv::Point>& candidate_coordinates,
+		const uint32_t tile_size,
+		const uint32_t level,
+		const float background_threshold,
+		const boost::filesystem::path& input_file,
+		ThreadPool* thread_pool);
 };
 #endif //__WSICS_MISC_LEVELREADING__
\ No newline at end of file
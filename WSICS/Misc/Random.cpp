@@ -1,29 +1,37 @@
 #include "Random.h"
 
-#include <algorithm>
-#include <random>
+#include <boost/random/uniform_int_distribution.hpp>
 
 namespace WSICS::Misc::Random
 {
-	std::vector<size_t> CreateListOfRandomIntegers(const size_t size)
+	std::vector<size_t> CreateListOfRandomIntegers(const size_t size, boost::mt19937_64& generator)
 	{
 		std::vector<size_t> random_numbers(size);
 		for (size_t element = 0; element < size; ++element)
 		{
 			random_numbers[element] = element;
 		}
-		std::shuffle(random_numbers.begin(), random_numbers.end(), std::random_device());
+		Shuffle(random_numbers, generator);
 		return random_numbers;
 	}
 
-	std::vector<size_t> CreateListOfRandomIntegers(const size_t size, boost::mt19937_64& generator)
+	uint64_t DeriveSeed(const uint64_t seed, const uint64_t stream_id)
 	{
-		std::vector<size_t> random_numbers(size);
-		for (size_t element = 0; element < size; ++element)
-		{
-			random_numbers[element] = element;
-		}
-		std::shuffle(random_numbers.begin(), random_numbers.end(), generator);
-		return random_numbers;
+		// Applies the SplitMix64 finalizer to the combined values, which maps every
+		// (seed, stream) pair onto a well distributed, uncorrelated seed.
+		uint64_t value = seed ^ ((stream_id + 1) * 0x9E3779B97F4A7C15ULL);
+		value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+		value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+		return value ^ (value >> 31);
+	}
+
+	boost::mt19937_64 CreateStream(const uint64_t seed, const uint64_t stream_id)
+	{
+		return boost::mt19937_64(DeriveSeed(seed, stream_id));
+	}
+
+	size_t RandomIndex(boost::mt19937_64& generator, const size_t size)
+	{
+		return boost::random::uniform_int_distribution<size_t>(0, size - 1)(generator);
 	}
-}
\ No newline at end of file
+}
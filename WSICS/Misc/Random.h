@@ -2,13 +2,67 @@
 #define __WSICS_MISC_RANDOM__
 
 #include <stddef.h>
+#include <stdint.h>
+#include <utility>
 #include <vector>
 
 #include <boost/random/mersenne_twister.hpp>
 
 namespace WSICS::Misc::Random
 {
-	std::vector<size_t> CreateListOfRandomIntegers(const size_t size);
+	/// <summary>
+	/// Identifies the purpose a random stream is derived for. Keeps streams that are derived
+	/// from the same seed independent of each other.
+	/// </summary>
+	enum StreamPurpose : uint64_t
+	{
+		STREAM_TILE_SELECTION		= 1,
+		STREAM_TILE					= 2,
+		STREAM_ELLIPSE_DETECTION	= 3,
+		STREAM_EOSIN_SELECTION		= 4,
+		STREAM_TRAINING_SELECTION	= 5,
+		STREAM_SAMPLE_OUTPUT		= 6
+	};
+
 	std::vector<size_t> CreateListOfRandomIntegers(const size_t size, boost::mt19937_64& generator);
+
+	/// <summary>
+	/// Derives the seed of an independent stream from a parent seed and a stream id. The result only
+	/// depends on the two values, which allows tiles, windows or workers to acquire their own stream
+	/// regardless of the order in which they are processed. Derivations can be chained.
+	/// </summary>
+	/// <param name="seed">The parent seed.</param>
+	/// <param name="stream_id">The id of the stream, such as a purpose, tile or window index.</param>
+	/// <returns>The seed for the derived stream.</returns>
+	uint64_t DeriveSeed(const uint64_t seed, const uint64_t stream_id);
+	/// <summary>
+	/// Creates a generator for the stream identified by the parent seed and stream id.
+	/// </summary>
+	/// <param name="seed">The parent seed.</param>
+	/// <param name="stream_id">The id of the stream, such as a purpose, tile or window index.</param>
+	/// <returns>A generator seeded for the derived stream.</returns>
+	boost::mt19937_64 CreateStream(const uint64_t seed, const uint64_t stream_id);
+	/// <summary>
+	/// Draws a uniformly distributed index within [0, size). The distribution is implementation
+	/// independent, ensuring identical results across platforms.
+	/// </summary>
+	/// <param name="generator">The generator to draw from.</param>
+	/// <param name="size">The amount of elements to select from, must be larger than 0.</param>
+	/// <returns>The selected index.</returns>
+	size_t RandomIndex(boost::mt19937_64& generator, const size_t size);
+	/// <summary>
+	/// Performs a Fisher-Yates shuffle on the passed vector. Unlike std::shuffle, the resulting
+	/// order is identical across standard library implementations.
+	/// </summary>
+	/// <param name="elements">The vector to shuffle.</param>
+	/// <param name="generator">The generator to draw from.</param>
+	template <typename T>
+	void Shuffle(std::vector<T>& elements, boost::mt19937_64& generator)
+	{
+		for (size_t element = elements.size(); element > 1; --element)
+		{
+			std::swap(elements[element - 1], elements[RandomIndex(generator, element)]);
+		}
+	}
 }
-#endif // __WSICS_MISC_RANDOM__
\ No newline at end of file
+#endif // __WSICS_MISC_RANDOM__
@@ -0,0 +1,153 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+
+namespace WSICS::Misc
+{
+	ThreadPool::ThreadPool(const size_t thread_count) : m_stop_(false)
+	{
+		size_t workers = thread_count;
+		if (workers == 0)
+		{
+			workers = std::max<size_t>(1, std::thread::hardware_concurrency());
+		}
+
+		m_workers_.reserve(workers);
+		for (size_t worker = 0; worker < workers; ++worker)
+		{
+			m_workers_.emplace_back(&ThreadPool::ProcessTasks_, this);
+		}
+	}
+
+	ThreadPool::~ThreadPool(void)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_queue_access_);
+			m_stop_ = true;
+		}
+		m_queue_notification_.notify_all();
+
+		for (std::thread& worker : m_workers_)
+		{
+			worker.join();
+		}
+	}
+
+	size_t ThreadPool::Size(void) const
+	{
+		return m_workers_.size();
+	}
+
+	std::future<void> ThreadPool::Submit(std::function<void(void)> task)
+	{
+		std::packaged_task<void()> packaged_task(std::move(task));
+		std::future<void> future(packaged_task.get_future());
+		{
+			std::lock_guard<std::mutex> lock(m_queue_access_);
+			m_tasks_.push(std::move(packaged_task));
+		}
+		m_queue_notification_.notify_one();
+		return future;
+	}
+
+	void ThreadPool::ParallelFor(const size_t count, const std::function<void(const size_t)>& function)
+	{
+		if (count == 0)
+		{
+			return;
+		}
+
+		// Holds the state shared between the caller and the helpers, which may outlive this call.
+		struct SharedState
+		{
+			std::atomic<size_t>		next_index;
+			std::mutex				access;
+			std::condition_variable	finished;
+			size_t					active_helpers;
+			bool					closed;
+			std::exception_ptr		exception;
+		};
+
+		std::shared_ptr<SharedState> state(std::make_shared<SharedState>());
+		state->next_index		= 0;
+		state->active_helpers	= 0;
+		state->closed			= false;
+
+		auto process_indices = [count, &function](SharedState& shared_state)
+		{
+			for (size_t index = shared_state.next_index++; index < count; index = shared_state.next_index++)
+			{
+				try
+				{
+					function(index);
+				}
+				catch (...)
+				{
+					std::lock_guard<std::mutex> lock(shared_state.access);
+					if (!shared_state.exception)
+					{
+						shared_state.exception = std::current_exception();
+					}
+				}
+			}
+		};
+
+		// Helpers that start after the caller finished won't touch the function, which might no longer exist.
+		size_t helpers = std::min(count - 1, m_workers_.size());
+		for (size_t helper = 0; helper < helpers; ++helper)
+		{
+			Submit([state, process_indices]()
+			{
+				{
+					std::lock_guard<std::mutex> lock(state->access);
+					if (state->closed)
+					{
+						return;
+					}
+					++state->active_helpers;
+				}
+
+				process_indices(*state);
+
+				std::lock_guard<std::mutex> lock(state->access);
+				--state->active_helpers;
+				state->finished.notify_all();
+			});
+		}
+
+		process_indices(*state);
+
+		std::unique_lock<std::mutex> lock(state->access);
+		state->closed = true;
+		state->finished.wait(lock, [&state]() { return state->active_helpers == 0; });
+
+		if (state->exception)
+		{
+			std::rethrow_exception(state->exception);
+		}
+	}
+
+	void ThreadPool::ProcessTasks_(void)
+	{
+		while (true)
+		{
+			std::packaged_task<void()> task;
+			{
+				std::unique_lock<std::mutex> lock(m_queue_access_);
+				m_queue_notification_.wait(lock, [this]() { return m_stop_ || !m_tasks_.empty(); });
+
+				if (m_stop_ && m_tasks_.empty())
+				{
+					return;
+				}
+
+				task = std::move(m_tasks_.front());
+				m_tasks_.pop();
+			}
+			task();
+		}
+	}
+}
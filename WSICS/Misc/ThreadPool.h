@@ -0,0 +1,73 @@
+#ifndef __WSICS_MISC_THREADPOOL__
+#define __WSICS_MISC_THREADPOOL__
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace WSICS::Misc
+{
+	/// <summary>
+	/// A fixed size pool of worker threads that processes submitted tasks in FIFO order.
+	/// This class is thread safe.
+	/// </summary>
+	/// <remarks>
+	/// ParallelFor lets the calling thread take part in the work and never waits on helper tasks
+	/// that haven't started yet. This allows tasks that run on the pool to use ParallelFor themselves,
+	/// without risking a deadlock when every worker is occupied.
+	/// </remarks>
+	class ThreadPool
+	{
+		public:
+			/// <summary>
+			/// Constructs the pool and starts its workers.
+			/// </summary>
+			/// <param name="thread_count">The amount of workers, 0 selects the amount of hardware threads.</param>
+			ThreadPool(const size_t thread_count = 0);
+			/// <summary>
+			/// Finishes the queued tasks and joins the workers.
+			/// </summary>
+			~ThreadPool(void);
+
+			ThreadPool(const ThreadPool&)				= delete;
+			ThreadPool(ThreadPool&&)					= delete;
+			ThreadPool& operator=(const ThreadPool&)	= delete;
+			ThreadPool& operator=(ThreadPool&&)			= delete;
+
+			/// <summary>
+			/// Returns the amount of workers held by the pool.
+			/// </summary>
+			/// <returns>The amount of workers.</returns>
+			size_t Size(void) const;
+			/// <summary>
+			/// Queues a task for execution.
+			/// </summary>
+			/// <param name="task">The task to execute.</param>
+			/// <returns>A future that signals completion and rethrows exceptions raised by the task.</returns>
+			std::future<void> Submit(std::function<void(void)> task);
+			/// <summary>
+			/// Executes the function for every index within [0, count), distributing the indices over the
+			/// calling thread and any idle workers. Returns once every index has been processed.
+			/// </summary>
+			/// <param name="count">The amount of indices to process.</param>
+			/// <param name="function">The function to execute for each index.</param>
+			void ParallelFor(const size_t count, const std::function<void(const size_t)>& function);
+
+		private:
+			bool									m_stop_;
+			std::mutex								m_queue_access_;
+			std::condition_variable					m_queue_notification_;
+			std::queue<std::packaged_task<void()>>	m_tasks_;
+			std::vector<std::thread>				m_workers_;
+
+			/// <summary>
+			/// Processes tasks until the pool is destroyed.
+			/// </summary>
+			void ProcessTasks_(void);
+	};
+}
+#endif // __WSICS_MISC_THREADPOOL__
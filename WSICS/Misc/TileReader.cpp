@@ -0,0 +1,91 @@
+#include "TileReader.h"
+
+#include <bitset>
+
+#include <opencv2/imgproc/imgproc.hpp>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define WSICS_TILEREADER_SSE2
+#endif
+
+namespace WSICS::Misc
+{
+	TileReader::TileReader(MultiResolutionImage& tiled_image, const uint32_t tile_size)
+		: m_tiled_image_(tiled_image), m_tile_size_(tile_size), m_buffer_(new unsigned char[tile_size * tile_size * 3])
+	{
+	}
+
+	const unsigned char* TileReader::Read(const int64_t x, const int64_t y, const uint32_t level)
+	{
+		// Depending on the ASAP version, getRawRegion either fills the passed buffer or replaces the
+		// pointer with a newly allocated one. The latter is adopted, which releases the previous buffer.
+		unsigned char* data = m_buffer_.get();
+		m_tiled_image_.getRawRegion(x, y, m_tile_size_, m_tile_size_, level, data);
+		if (data != m_buffer_.get())
+		{
+			m_buffer_.reset(data);
+		}
+
+		return m_buffer_.get();
+	}
+
+	size_t TileReader::CountBackgroundPixels(void) const
+	{
+		return CountBackgroundPixels(m_buffer_.get(), m_tile_size_ * m_tile_size_);
+	}
+
+	cv::Mat TileReader::GetRGB(void) const
+	{
+		return cv::Mat(m_tile_size_, m_tile_size_, CV_8UC3, m_buffer_.get());
+	}
+
+	void TileReader::CopyBGR(cv::Mat& output) const
+	{
+		cv::cvtColor(GetRGB(), output, cv::COLOR_RGB2BGR);
+	}
+
+	size_t TileReader::CountBackgroundPixels(const unsigned char* data, const size_t pixel_count)
+	{
+		// Threshold was 230 for mrxs files
+		size_t background_count = 0;
+		size_t pixel = 0;
+
+#ifdef WSICS_TILEREADER_SSE2
+		// Processes 16 pixels (48 bytes) at once. Each byte is compared against the thresholds, after which
+		// the byte masks are packed into a 48 bit integer. A pixel is counted if all three of its bits are set.
+		const __m128i bright_threshold	= _mm_set1_epi8(static_cast<char>(201));
+		const __m128i zero				= _mm_setzero_si128();
+		const uint64_t first_channel	= 0x249249249249ULL;
+
+		for (; pixel + 16 <= pixel_count; pixel += 16)
+		{
+			uint64_t bright_bits	= 0;
+			uint64_t black_bits		= 0;
+			for (size_t block = 0; block < 3; ++block)
+			{
+				__m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pixel * 3 + block * 16));
+				uint64_t bright	= static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(values, bright_threshold), values)));
+				uint64_t black	= static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(values, zero)));
+				bright_bits	|= bright << (block * 16);
+				black_bits	|= black << (block * 16);
+			}
+
+			uint64_t bright_pixels	= bright_bits & (bright_bits >> 1) & (bright_bits >> 2);
+			uint64_t black_pixels	= black_bits & (black_bits >> 1) & (black_bits >> 2);
+			background_count += std::bitset<64>((bright_pixels | black_pixels) & first_channel).count();
+		}
+#endif
+
+		for (; pixel < pixel_count; ++pixel)
+		{
+			const unsigned char* rgb = data + pixel * 3;
+			if ((rgb[0] > 200 && rgb[1] > 200 && rgb[2] > 200) || (rgb[0] == 0 && rgb[1] == 0 && rgb[2] == 0))
+			{
+				++background_count;
+			}
+		}
+
+		return background_count;
+	}
+}
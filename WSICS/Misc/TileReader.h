@@ -0,0 +1,69 @@
+#ifndef __WSICS_MISC_TILEREADER__
+#define __WSICS_MISC_TILEREADER__
+
+#include <memory>
+
+#include <opencv2/core/core.hpp>
+
+#include "multiresolutionimageinterface/MultiResolutionImage.h"
+
+namespace WSICS::Misc
+{
+	/// <summary>
+	/// Reads square RGB tiles from a WSI into a single buffer, that is reused or replaced by each read.
+	/// This keeps the memory usage flat regardless of the amount of tiles read.
+	///
+	/// Instances aren't thread safe, each thread should construct its own reader.
+	/// </summary>
+	class TileReader
+	{
+		public:
+			/// <summary>
+			/// Constructs the reader and allocates its buffer.
+			/// </summary>
+			/// <param name="tiled_image">The image to read from.</param>
+			/// <param name="tile_size">The width and height of each tile.</param>
+			TileReader(MultiResolutionImage& tiled_image, const uint32_t tile_size);
+
+			TileReader(const TileReader&)				= delete;
+			TileReader& operator=(const TileReader&)	= delete;
+
+			/// <summary>
+			/// Reads a tile into the buffer, invalidating the data of the previous tile.
+			/// </summary>
+			/// <param name="x">The x coordinate of the tile, in base level pixels.</param>
+			/// <param name="y">The y coordinate of the tile, in base level pixels.</param>
+			/// <param name="level">The level to read from.</param>
+			/// <returns>A pointer towards the interleaved RGB data of the tile.</returns>
+			const unsigned char* Read(const int64_t x, const int64_t y, const uint32_t level);
+			/// <summary>
+			/// Counts the background pixels of the last read tile.
+			/// </summary>
+			/// <returns>The amount of background pixels.</returns>
+			size_t CountBackgroundPixels(void) const;
+			/// <summary>
+			/// Wraps the buffer into a matrix without copying. The matrix is invalidated by the next read.
+			/// </summary>
+			/// <returns>A CV_8UC3 matrix with the channels in RGB order.</returns>
+			cv::Mat GetRGB(void) const;
+			/// <summary>
+			/// Copies the last read tile into the output matrix, converted to BGR.
+			/// </summary>
+			/// <param name="output">The matrix to write to, which is reallocated only if its size or type differs.</param>
+			void CopyBGR(cv::Mat& output) const;
+
+			/// <summary>
+			/// Counts the pixels that are either near white or black, within an interleaved RGB array.
+			/// </summary>
+			/// <param name="data">The interleaved RGB array.</param>
+			/// <param name="pixel_count">The amount of pixels in the array.</param>
+			/// <returns>The amount of background pixels.</returns>
+			static size_t CountBackgroundPixels(const unsigned char* data, const size_t pixel_count);
+
+		private:
+			MultiResolutionImage&				m_tiled_image_;
+			uint32_t							m_tile_size_;
+			std::unique_ptr<unsigned char[]>	m_buffer_;
+	};
+}
+#endif // __WSICS_MISC_TILEREADER__
@@ -0,0 +1,290 @@
+#include "TissueIndex.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+
+#include <opencv2/imgproc/imgproc.hpp>
+
+namespace WSICS::Misc
+{
+	// Identifies the persisted index and the version of its layout.
+	const char		index_magic[8]	= { 'W', 'S', 'I', 'C', 'S', 'T', 'I', '\0' };
+	const uint32_t	index_version	= 1;
+
+	TissueIndex::TissueIndex(void) : m_level_(0), m_downsample_(1.0)
+	{
+	}
+
+	void TissueIndex::Build(MultiResolutionImage& tiled_image, const uint32_t level)
+	{
+		m_level_		= level;
+		m_downsample_	= tiled_image.getLevelDownsample(level);
+
+		const std::vector<unsigned long long> dimensions(tiled_image.getLevelDimensions(level));
+		m_size_ = cv::Size(static_cast<int>(dimensions[0]), static_cast<int>(dimensions[1]));
+
+		cv::Mat mask(cv::Mat::zeros(m_size_, CV_8UC1));
+
+		// Reads the level in strips, which bounds the memory required for low resolution levels of large slides.
+		const uint32_t strip_height = 256;
+		std::unique_ptr<unsigned char[]> buffer(new unsigned char[static_cast<size_t>(m_size_.width) * strip_height * 3]);
+		for (int y = 0; y < m_size_.height; y += strip_height)
+		{
+			const int rows = std::min<int>(strip_height, m_size_.height - y);
+
+			// Depending on the ASAP version, getRawRegion either fills the passed buffer or replaces the pointer.
+			unsigned char* data = buffer.get();
+			tiled_image.getRawRegion(0, static_cast<long long>(y * m_downsample_), m_size_.width, rows, level, data);
+			if (data != buffer.get())
+			{
+				buffer.reset(data);
+			}
+
+			// Uses the same criteria as the tile based background counting.
+			for (int row = 0; row < rows; ++row)
+			{
+				const unsigned char* rgb	= buffer.get() + static_cast<size_t>(row) * m_size_.width * 3;
+				unsigned char* mask_row		= mask.ptr<unsigned char>(y + row);
+				for (int col = 0; col < m_size_.width; ++col, rgb += 3)
+				{
+					bool background = (rgb[0] > 200 && rgb[1] > 200 && rgb[2] > 200) || (rgb[0] == 0 && rgb[1] == 0 && rgb[2] == 0);
+					mask_row[col] = !background;
+				}
+			}
+		}
+
+		cv::integral(mask, m_integral_, CV_32S);
+		BuildQuadtree_();
+	}
+
+	bool TissueIndex::Load(const boost::filesystem::path& index_file, const boost::filesystem::path& slide_file, const uint32_t level)
+	{
+		std::ifstream stream(index_file.string(), std::ios::binary);
+		if (!stream)
+		{
+			return false;
+		}
+
+		boost::system::error_code error;
+		uint64_t slide_size = boost::filesystem::file_size(slide_file, error);
+		int64_t slide_modification_time = static_cast<int64_t>(boost::filesystem::last_write_time(slide_file, error));
+		if (error)
+		{
+			return false;
+		}
+
+		char magic[8];
+		uint32_t version, stored_level;
+		uint64_t stored_size, node_count;
+		int64_t stored_modification_time;
+		int32_t width, height;
+		double downsample;
+
+		stream.read(magic, sizeof(magic));
+		stream.read(reinterpret_cast<char*>(&version), sizeof(version));
+		stream.read(reinterpret_cast<char*>(&stored_size), sizeof(stored_size));
+		stream.read(reinterpret_cast<char*>(&stored_modification_time), sizeof(stored_modification_time));
+		stream.read(reinterpret_cast<char*>(&stored_level), sizeof(stored_level));
+		stream.read(reinterpret_cast<char*>(&downsample), sizeof(downsample));
+		stream.read(reinterpret_cast<char*>(&width), sizeof(width));
+		stream.read(reinterpret_cast<char*>(&height), sizeof(height));
+		stream.read(reinterpret_cast<char*>(&node_count), sizeof(node_count));
+
+		if (!stream || std::memcmp(magic, index_magic, sizeof(magic)) != 0 || version != index_version ||
+			stored_size != slide_size || stored_modification_time != slide_modification_time || stored_level != level ||
+			width <= 0 || height <= 0 || node_count == 0)
+		{
+			return false;
+		}
+
+		std::vector<uint8_t> states(node_count);
+		stream.read(reinterpret_cast<char*>(states.data()), node_count);
+		if (!stream)
+		{
+			return false;
+		}
+
+		m_level_		= stored_level;
+		m_downsample_	= downsample;
+		m_size_			= cv::Size(width, height);
+
+		// The states are stored in breadth-first order, which allows the geometry of each node to be derived.
+		m_nodes_.clear();
+		m_nodes_.push_back({ 0, 0, GetRootSize_(), NODE_GLASS, 0 });
+		for (size_t node = 0; node < m_nodes_.size(); ++node)
+		{
+			if (node >= states.size() || states[node] > NODE_SPLIT || (states[node] == NODE_SPLIT && m_nodes_[node].size == 1))
+			{
+				m_nodes_.clear();
+				return false;
+			}
+
+			m_nodes_[node].state = states[node];
+			if (states[node] == NODE_SPLIT)
+			{
+				const QuadtreeNode parent(m_nodes_[node]);
+				const uint32_t half = parent.size / 2;
+
+				m_nodes_[node].first_child = static_cast<uint32_t>(m_nodes_.size());
+				m_nodes_.push_back({ parent.x, parent.y, half, NODE_GLASS, 0 });
+				m_nodes_.push_back({ parent.x + half, parent.y, half, NODE_GLASS, 0 });
+				m_nodes_.push_back({ parent.x, parent.y + half, half, NODE_GLASS, 0 });
+				m_nodes_.push_back({ parent.x + half, parent.y + half, half, NODE_GLASS, 0 });
+			}
+		}
+
+		if (m_nodes_.size() != states.size())
+		{
+			m_nodes_.clear();
+			return false;
+		}
+
+		PaintQuadtree_();
+		return true;
+	}
+
+	void TissueIndex::Save(const boost::filesystem::path& index_file, const boost::filesystem::path& slide_file) const
+	{
+		uint64_t slide_size = boost::filesystem::file_size(slide_file);
+		int64_t slide_modification_time = static_cast<int64_t>(boost::filesystem::last_write_time(slide_file));
+		int32_t width = m_size_.width;
+		int32_t height = m_size_.height;
+		uint64_t node_count = m_nodes_.size();
+
+		// Writes towards a temporary file first, so that an interruption never leaves a partial index behind.
+		boost::filesystem::path temporary_file(index_file.string() + ".tmp");
+		{
+			std::ofstream stream(temporary_file.string(), std::ios::binary | std::ios::trunc);
+			stream.write(index_magic, sizeof(index_magic));
+			stream.write(reinterpret_cast<const char*>(&index_version), sizeof(index_version));
+			stream.write(reinterpret_cast<const char*>(&slide_size), sizeof(slide_size));
+			stream.write(reinterpret_cast<const char*>(&slide_modification_time), sizeof(slide_modification_time));
+			stream.write(reinterpret_cast<const char*>(&m_level_), sizeof(m_level_));
+			stream.write(reinterpret_cast<const char*>(&m_downsample_), sizeof(m_downsample_));
+			stream.write(reinterpret_cast<const char*>(&width), sizeof(width));
+			stream.write(reinterpret_cast<const char*>(&height), sizeof(height));
+			stream.write(reinterpret_cast<const char*>(&node_count), sizeof(node_count));
+			for (const QuadtreeNode& node : m_nodes_)
+			{
+				stream.put(static_cast<char>(node.state));
+			}
+
+			stream.flush();
+			if (!stream)
+			{
+				throw std::runtime_error("Unable to write the tissue index to: " + temporary_file.string());
+			}
+		}
+		boost::filesystem::rename(temporary_file, index_file);
+	}
+
+	boost::filesystem::path TissueIndex::GetIndexPath(const boost::filesystem::path& slide_file)
+	{
+		return boost::filesystem::path(slide_file.string() + ".tissue");
+	}
+
+	bool TissueIndex::IsEmpty(void) const
+	{
+		return m_nodes_.empty();
+	}
+
+	uint32_t TissueIndex::GetLevel(void) const
+	{
+		return m_level_;
+	}
+
+	cv::Size TissueIndex::GetSize(void) const
+	{
+		return m_size_;
+	}
+
+	cv::Rect TissueIndex::ToIndexRegion(const double x, const double y, const double width, const double height, const double level_downsample) const
+	{
+		const double scale = level_downsample / m_downsample_;
+		const int x_start	= static_cast<int>(std::floor(x * scale));
+		const int y_start	= static_cast<int>(std::floor(y * scale));
+		const int x_end		= static_cast<int>(std::ceil((x + width) * scale));
+		const int y_end		= static_cast<int>(std::ceil((y + height) * scale));
+		return cv::Rect(x_start, y_start, std::max(x_end - x_start, 1), std::max(y_end - y_start, 1));
+	}
+
+	uint64_t TissueIndex::CountTissuePixels(const cv::Rect& region) const
+	{
+		cv::Rect clipped(region & cv::Rect(0, 0, m_size_.width, m_size_.height));
+		if (clipped.empty())
+		{
+			return 0;
+		}
+
+		return static_cast<uint64_t>(
+			m_integral_.at<int32_t>(clipped.y + clipped.height, clipped.x + clipped.width) -
+			m_integral_.at<int32_t>(clipped.y, clipped.x + clipped.width) -
+			m_integral_.at<int32_t>(clipped.y + clipped.height, clipped.x) +
+			m_integral_.at<int32_t>(clipped.y, clipped.x));
+	}
+
+	bool TissueIndex::ContainsTissue(const cv::Rect& region) const
+	{
+		return CountTissuePixels(region) > 0;
+	}
+
+	void TissueIndex::BuildQuadtree_(void)
+	{
+		// Subdivides breadth-first, which places the children of each node next to each other.
+		m_nodes_.clear();
+		m_nodes_.push_back({ 0, 0, GetRootSize_(), NODE_GLASS, 0 });
+		for (size_t node = 0; node < m_nodes_.size(); ++node)
+		{
+			const QuadtreeNode current(m_nodes_[node]);
+			const uint64_t tissue_pixels = CountTissuePixels(cv::Rect(current.x, current.y, current.size, current.size));
+
+			if (tissue_pixels == 0)
+			{
+				m_nodes_[node].state = NODE_GLASS;
+			}
+			else if (tissue_pixels == static_cast<uint64_t>(current.size) * current.size)
+			{
+				m_nodes_[node].state = NODE_TISSUE;
+			}
+			else
+			{
+				const uint32_t half = current.size / 2;
+
+				m_nodes_[node].state		= NODE_SPLIT;
+				m_nodes_[node].first_child	= static_cast<uint32_t>(m_nodes_.size());
+				m_nodes_.push_back({ current.x, current.y, half, NODE_GLASS, 0 });
+				m_nodes_.push_back({ current.x + half, current.y, half, NODE_GLASS, 0 });
+				m_nodes_.push_back({ current.x, current.y + half, half, NODE_GLASS, 0 });
+				m_nodes_.push_back({ current.x + half, current.y + half, half, NODE_GLASS, 0 });
+			}
+		}
+	}
+
+	void TissueIndex::PaintQuadtree_(void)
+	{
+		cv::Mat mask(cv::Mat::zeros(m_size_, CV_8UC1));
+		for (const QuadtreeNode& node : m_nodes_)
+		{
+			if (node.state == NODE_TISSUE)
+			{
+				mask(cv::Rect(node.x, node.y, node.size, node.size) & cv::Rect(0, 0, m_size_.width, m_size_.height)).setTo(1);
+			}
+		}
+
+		cv::integral(mask, m_integral_, CV_32S);
+	}
+
+	uint32_t TissueIndex::GetRootSize_(void) const
+	{
+		uint32_t root_size = 1;
+		while (root_size < static_cast<uint32_t>(std::max(m_size_.width, m_size_.height)))
+		{
+			root_size *= 2;
+		}
+		return root_size;
+	}
+}
@@ -0,0 +1,135 @@
+#ifndef __WSICS_MISC_TISSUEINDEX__
+#define __WSICS_MISC_TISSUEINDEX__
+
+#include <vector>
+
+#include <boost/filesystem.hpp>
+#include <opencv2/core/core.hpp>
+
+#include "multiresolutionimageinterface/MultiResolutionImage.h"
+
+namespace WSICS::Misc
+{
+	/// <summary>
+	/// Describes the tissue coverage of a WSI, based on a single pass over one of its low resolution levels.
+	///
+	/// Each pixel of the level is thresholded into a tissue mask, using the same criteria as the tile based
+	/// background counting. An integral image over the mask offers the amount of tissue pixels for any region
+	/// in constant time, while a region quadtree describes the mask compactly. The quadtree is lossless, which
+	/// allows it to be persisted in place of the mask.
+	///
+	/// The mask only describes the indexed level. Faint tissue can average out into background while downsampling,
+	/// which means that pruning the regions of finer levels through the index can discard tissue that the level by
+	/// level tile thresholds would have kept.
+	/// </summary>
+	class TissueIndex
+	{
+		public:
+			/// <summary>
+			/// Constructs an empty index.
+			/// </summary>
+			TissueIndex(void);
+
+			/// <summary>
+			/// Builds the index by reading the passed level of the image, in strips.
+			/// </summary>
+			/// <param name="tiled_image">The image to index.</param>
+			/// <param name="level">The level to read, which should be one of the lowest resolution levels.</param>
+			void Build(MultiResolutionImage& tiled_image, const uint32_t level);
+			/// <summary>
+			/// Attempts to read a persisted index.
+			/// </summary>
+			/// <param name="index_file">The path towards the persisted index.</param>
+			/// <param name="slide_file">The slide the index should describe, whose size and modification time have to match.</param>
+			/// <param name="level">The level the index should have been built from.</param>
+			/// <returns>Whether or not the index was read.</returns>
+			bool Load(const boost::filesystem::path& index_file, const boost::filesystem::path& slide_file, const uint32_t level);
+			/// <summary>
+			/// Persists the quadtree of the index, through a temporary file that replaces the index file.
+			/// </summary>
+			/// <param name="index_file">The path to write the index to.</param>
+			/// <param name="slide_file">The slide the index describes.</param>
+			void Save(const boost::filesystem::path& index_file, const boost::filesystem::path& slide_file) const;
+			/// <summary>
+			/// Returns the default location of the persisted index, next to the slide.
+			/// </summary>
+			/// <param name="slide_file">The path towards the slide.</param>
+			/// <returns>The path towards the index file.</returns>
+			static boost::filesystem::path GetIndexPath(const boost::filesystem::path& slide_file);
+
+			/// <summary>
+			/// Returns whether the index has been built or loaded.
+			/// </summary>
+			/// <returns>Whether or not the index is empty.</returns>
+			bool IsEmpty(void) const;
+			/// <summary>
+			/// Returns the level the index was built from.
+			/// </summary>
+			/// <returns>The level of the index.</returns>
+			uint32_t GetLevel(void) const;
+			/// <summary>
+			/// Returns the size of the tissue mask.
+			/// </summary>
+			/// <returns>The width and height of the indexed level.</returns>
+			cv::Size GetSize(void) const;
+
+			/// <summary>
+			/// Maps a region on another level towards the index, rounding outwards.
+			/// </summary>
+			/// <param name="x">The x coordinate of the region, in pixels of its level.</param>
+			/// <param name="y">The y coordinate of the region, in pixels of its level.</param>
+			/// <param name="width">The width of the region, in pixels of its level.</param>
+			/// <param name="height">The height of the region, in pixels of its level.</param>
+			/// <param name="level_downsample">The downsample of the level the region is defined on.</param>
+			/// <returns>The region in index pixels, which may extend beyond the mask.</returns>
+			cv::Rect ToIndexRegion(const double x, const double y, const double width, const double height, const double level_downsample) const;
+			/// <summary>
+			/// Counts the tissue pixels within a region of the index. Parts outside of the mask contain no tissue.
+			/// </summary>
+			/// <param name="region">The region in index pixels.</param>
+			/// <returns>The amount of tissue pixels.</returns>
+			uint64_t CountTissuePixels(const cv::Rect& region) const;
+			/// <summary>
+			/// Checks whether a region of the index contains any tissue.
+			/// </summary>
+			/// <param name="region">The region in index pixels.</param>
+			/// <returns>Whether or not the region contains tissue.</returns>
+			bool ContainsTissue(const cv::Rect& region) const;
+
+		private:
+			/// <summary>
+			/// Describes a square section of the mask. Leaves are either fully tissue or fully glass.
+			/// </summary>
+			struct QuadtreeNode
+			{
+				uint32_t	x;
+				uint32_t	y;
+				uint32_t	size;
+				uint8_t		state;
+				uint32_t	first_child;
+			};
+
+			enum NodeState : uint8_t { NODE_GLASS, NODE_TISSUE, NODE_SPLIT };
+
+			uint32_t					m_level_;
+			double						m_downsample_;
+			cv::Size					m_size_;
+			cv::Mat						m_integral_;
+			std::vector<QuadtreeNode>	m_nodes_;
+
+			/// <summary>
+			/// Builds the quadtree from the integral image.
+			/// </summary>
+			void BuildQuadtree_(void);
+			/// <summary>
+			/// Recreates the integral image from the quadtree.
+			/// </summary>
+			void PaintQuadtree_(void);
+			/// <summary>
+			/// Returns the side of the root node, the smallest power of two that covers the mask.
+			/// </summary>
+			/// <returns>The side of the root node.</returns>
+			uint32_t GetRootSize_(void) const;
+	};
+}
+#endif // __WSICS_MISC_TISSUEINDEX__
@@ -0,0 +1,255 @@
+#include "BatchManifest.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/property_tree/ptree.hpp>
+
+#include "../IO/Logging/LogHandler.h"
+
+namespace WSICS::Normalization
+{
+	BatchManifest::BatchManifest(const boost::filesystem::path& manifest_file) : m_manifest_file_(manifest_file)
+	{
+		Load_();
+	}
+
+	bool BatchManifest::IsComplete(const BatchJob& job, const std::string& parameters)
+	{
+		std::lock_guard<std::mutex> lock(m_access_);
+
+		auto entry_iterator = std::find_if(m_entries_.begin(), m_entries_.end(), [&job](const ManifestEntry& entry) { return entry.input_file == job.input_file; });
+		if (entry_iterator == m_entries_.end() || !entry_iterator->completed || entry_iterator->parameters != parameters)
+		{
+			return false;
+		}
+
+		// The outputs must match the requested ones and still be present.
+		const ManifestEntry& entry(*entry_iterator);
+		const std::vector<std::pair<boost::filesystem::path, boost::filesystem::path>> outputs
+		{
+			{ job.image_output_file, entry.image_output_file },
+			{ job.lut_output_file, entry.lut_output_file },
+			{ job.template_output_file, entry.template_output_file }
+		};
+		for (const std::pair<boost::filesystem::path, boost::filesystem::path>& output : outputs)
+		{
+			if (output.first != output.second || (!output.first.empty() && !boost::filesystem::is_regular_file(output.first)))
+			{
+				return false;
+			}
+		}
+
+		// Compares the cheap properties first, the hash requires reading the file.
+		boost::system::error_code error;
+		uint64_t size = boost::filesystem::file_size(job.input_file, error);
+		if (error || size != entry.input_size || static_cast<int64_t>(boost::filesystem::last_write_time(job.input_file, error)) != entry.input_modification_time || error)
+		{
+			return false;
+		}
+		return HashFile(job.input_file) == entry.input_hash;
+	}
+
+	void BatchManifest::Record(const ManifestEntry& entry)
+	{
+		std::lock_guard<std::mutex> lock(m_access_);
+
+		auto entry_iterator = std::find_if(m_entries_.begin(), m_entries_.end(), [&entry](const ManifestEntry& existing_entry) { return existing_entry.input_file == entry.input_file; });
+		if (entry_iterator == m_entries_.end())
+		{
+			m_entries_.push_back(entry);
+		}
+		else
+		{
+			*entry_iterator = entry;
+		}
+
+		Save_();
+	}
+
+	ManifestEntry BatchManifest::CreateEntry(const BatchJob& job, const std::string& parameters)
+	{
+		ManifestEntry entry{ job.input_file, 0, 0, 0, parameters, job.image_output_file, job.lut_output_file, job.template_output_file, {}, 0.0, false, "" };
+
+		boost::system::error_code error;
+		entry.input_size = boost::filesystem::file_size(job.input_file, error);
+		if (error)
+		{
+			entry.input_size = 0;
+		}
+		entry.input_modification_time	= static_cast<int64_t>(boost::filesystem::last_write_time(job.input_file, error));
+		entry.input_hash				= HashFile(job.input_file);
+
+		return entry;
+	}
+
+	std::string BatchManifest::DescribeParameters(const WSICS_Parameters& parameters, const boost::filesystem::path& template_input)
+	{
+		std::stringstream description;
+		description << "minimum_ellipses=" << parameters.minimum_ellipses
+			<< ";min_training_size=" << parameters.min_training_size
+			<< ";max_training_size=" << parameters.max_training_size
+			<< ";seed=" << parameters.seed
+			<< ";hema_percentile=" << parameters.hema_percentile
+			<< ";eosin_percentile=" << parameters.eosin_percentile
+			<< ";background_threshold=" << parameters.background_threshold
+			<< ";consider_ink=" << parameters.consider_ink
+			<< ";convergence_trials=" << parameters.convergence_trials
+			<< ";nucleus_detection=" << parameters.nucleus_detection
+			<< ";detection_downsample=" << parameters.detection_downsample
+			<< ";refine_detections=" << parameters.refine_detections
+			<< ";knn_voxel_resolution=" << parameters.knn_voxel_resolution
+			<< ";tile_triage=" << parameters.tile_triage
+			<< ";template_input=" << template_input.string();
+
+		if (!template_input.empty())
+		{
+			description << ";template_hash=" << HashFile(template_input);
+		}
+
+		return description.str();
+	}
+
+	uint64_t BatchManifest::HashFile(const boost::filesystem::path& filepath)
+	{
+		const uint64_t fnv_offset	= 14695981039346656037ULL;
+		const uint64_t fnv_prime	= 1099511628211ULL;
+		const std::streamoff sample_size = 1024 * 1024;
+
+		std::ifstream stream(filepath.string(), std::ios::binary);
+		if (!stream)
+		{
+			return 0;
+		}
+
+		stream.seekg(0, std::ios::end);
+		std::streamoff file_size = stream.tellg();
+
+		uint64_t hash = fnv_offset;
+		for (size_t byte = 0; byte < sizeof(file_size); ++byte)
+		{
+			hash = (hash ^ ((static_cast<uint64_t>(file_size) >> (byte * 8)) & 0xFF)) * fnv_prime;
+		}
+
+		// Hashes the first and last megabyte, or the entire file if it's smaller than two.
+		std::vector<char> buffer(static_cast<size_t>(sample_size));
+		std::vector<std::pair<std::streamoff, std::streamoff>> ranges{ { 0, std::min(sample_size, file_size) } };
+		if (file_size > sample_size)
+		{
+			std::streamoff tail_start = std::max(sample_size, file_size - sample_size);
+			ranges.push_back({ tail_start, file_size - tail_start });
+		}
+
+		for (const std::pair<std::streamoff, std::streamoff>& range : ranges)
+		{
+			stream.seekg(range.first, std::ios::beg);
+			stream.read(buffer.data(), range.second);
+			for (std::streamsize byte = 0; byte < stream.gcount(); ++byte)
+			{
+				hash = (hash ^ static_cast<unsigned char>(buffer[byte])) * fnv_prime;
+			}
+		}
+
+		return hash;
+	}
+
+	void BatchManifest::Load_(void)
+	{
+		if (!boost::filesystem::is_regular_file(m_manifest_file_))
+		{
+			return;
+		}
+
+		boost::property_tree::ptree root;
+		try
+		{
+			boost::property_tree::read_json(m_manifest_file_.string(), root);
+		}
+		catch (const boost::property_tree::json_parser_error&)
+		{
+			IO::Logging::LogHandler::GetInstance()->QueueCommandLineLogging("Unable to read the manifest at: " + m_manifest_file_.string() + ", every slide will be processed.", IO::Logging::NORMAL);
+			return;
+		}
+
+		for (const std::pair<const std::string, boost::property_tree::ptree>& slide : root.get_child("slides", boost::property_tree::ptree()))
+		{
+			const boost::property_tree::ptree& node(slide.second);
+
+			ManifestEntry entry;
+			entry.input_file				= node.get<std::string>("input_file", "");
+			entry.input_size				= node.get<uint64_t>("input_size", 0);
+			entry.input_modification_time	= node.get<int64_t>("input_modification_time", 0);
+			entry.input_hash				= node.get<uint64_t>("input_hash", 0);
+			entry.parameters				= node.get<std::string>("parameters", "");
+			entry.image_output_file			= node.get<std::string>("image_output_file", "");
+			entry.lut_output_file			= node.get<std::string>("lut_output_file", "");
+			entry.template_output_file		= node.get<std::string>("template_output_file", "");
+			entry.seconds					= node.get<double>("seconds", 0.0);
+			entry.completed					= node.get<std::string>("status", "") == "completed";
+			entry.error						= node.get<std::string>("error", "");
+
+			for (const std::pair<const std::string, boost::property_tree::ptree>& stage : node.get_child("stage_timings", boost::property_tree::ptree()))
+			{
+				entry.stage_timings.push_back({ stage.second.get<std::string>("stage", ""), stage.second.get<double>("seconds", 0.0) });
+			}
+
+			m_entries_.push_back(entry);
+		}
+	}
+
+	void BatchManifest::Save_(void)
+	{
+		boost::property_tree::ptree slides;
+		for (const ManifestEntry& entry : m_entries_)
+		{
+			boost::property_tree::ptree node;
+			node.put("input_file", entry.input_file.string());
+			node.put("input_size", entry.input_size);
+			node.put("input_modification_time", entry.input_modification_time);
+			node.put("input_hash", entry.input_hash);
+			node.put("parameters", entry.parameters);
+			node.put("image_output_file", entry.image_output_file.string());
+			node.put("lut_output_file", entry.lut_output_file.string());
+			node.put("template_output_file", entry.template_output_file.string());
+			node.put("status", entry.completed ? "completed" : "failed");
+			node.put("error", entry.error);
+			node.put("seconds", entry.seconds);
+			node.put("megabytes_per_second", entry.seconds > 0.0 ? entry.input_size / (1024.0 * 1024.0) / entry.seconds : 0.0);
+
+			boost::property_tree::ptree stage_timings;
+			for (const StageTiming& timing : entry.stage_timings)
+			{
+				boost::property_tree::ptree stage;
+				stage.put("stage", timing.stage);
+				stage.put("seconds", timing.seconds);
+				stage_timings.push_back({ "", stage });
+			}
+			node.add_child("stage_timings", stage_timings);
+
+			slides.push_back({ "", node });
+		}
+
+		boost::property_tree::ptree root;
+		root.put("version", 1);
+		root.add_child("slides", slides);
+
+		// Writes towards a temporary file first, so that an interruption never leaves a partial manifest behind.
+		boost::filesystem::path temporary_file(m_manifest_file_.string() + ".tmp");
+		{
+			std::ofstream stream(temporary_file.string(), std::ios::trunc);
+			if (!stream)
+			{
+				throw std::runtime_error("Unable to write the manifest to: " + temporary_file.string());
+			}
+			boost::property_tree::write_json(stream, root);
+			stream.flush();
+			if (!stream)
+			{
+				throw std::runtime_error("Unable to write the manifest to: " + temporary_file.string());
+			}
+		}
+		boost::filesystem::rename(temporary_file, m_manifest_file_);
+	}
+}
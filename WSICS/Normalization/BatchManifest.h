@@ -0,0 +1,101 @@
+#ifndef __WSICS_NORMALIZATION_BATCHMANIFEST__
+#define __WSICS_NORMALIZATION_BATCHMANIFEST__
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+#include "BatchScheduler.h"
+#include "WSICS_Algorithm.h"
+#include "WSICS_Parameters.h"
+
+namespace WSICS::Normalization
+{
+	/// <summary>
+	/// Records the processing of a single slide within a batch.
+	/// </summary>
+	struct ManifestEntry
+	{
+		boost::filesystem::path		input_file;
+		uint64_t					input_size;
+		int64_t						input_modification_time;
+		uint64_t					input_hash;
+		std::string					parameters;
+		boost::filesystem::path		image_output_file;
+		boost::filesystem::path		lut_output_file;
+		boost::filesystem::path		template_output_file;
+		std::vector<StageTiming>	stage_timings;
+		double						seconds;
+		bool						completed;
+		std::string					error;
+	};
+
+	/// <summary>
+	/// Keeps a JSON record of the slides processed by a batch, which allows an interrupted batch to be
+	/// resumed. The file is rewritten after each recorded slide, through a temporary file that replaces
+	/// the original. This ensures the manifest on disk is always complete.
+	/// This class is thread safe.
+	/// </summary>
+	class BatchManifest
+	{
+		public:
+			/// <summary>
+			/// Constructs the manifest, loading the existing entries if the file is present.
+			/// </summary>
+			/// <param name="manifest_file">The path towards the manifest file.</param>
+			BatchManifest(const boost::filesystem::path& manifest_file);
+
+			/// <summary>
+			/// Checks whether the job has been completed with the same input, parameters and outputs,
+			/// and whether those outputs are still present.
+			/// </summary>
+			/// <param name="job">The job to check.</param>
+			/// <param name="parameters">The parameter description the job would be executed with.</param>
+			/// <returns>Whether or not the job can be skipped.</returns>
+			bool IsComplete(const BatchJob& job, const std::string& parameters);
+			/// <summary>
+			/// Replaces or adds the entry for the input file and writes the manifest to disk.
+			/// </summary>
+			/// <param name="entry">The entry to record.</param>
+			void Record(const ManifestEntry& entry);
+
+			/// <summary>
+			/// Creates an entry for the job, filled with the current state of its input file.
+			/// </summary>
+			/// <param name="job">The job to create the entry for.</param>
+			/// <param name="parameters">The parameter description the job is executed with.</param>
+			/// <returns>An entry that hasn't been marked as completed.</returns>
+			static ManifestEntry CreateEntry(const BatchJob& job, const std::string& parameters);
+			/// <summary>
+			/// Describes the parameters as a single string, which changes whenever the results would.
+			/// </summary>
+			/// <param name="parameters">The parameters to describe.</param>
+			/// <param name="template_input">The template the normalization is performed with.</param>
+			/// <returns>A description of the parameters.</returns>
+			static std::string DescribeParameters(const WSICS_Parameters& parameters, const boost::filesystem::path& template_input);
+			/// <summary>
+			/// Calculates a FNV-1a hash over the size of the file and its first and last megabyte. This detects
+			/// replaced slides without reading several gigabytes per slide.
+			/// </summary>
+			/// <param name="filepath">The file to hash.</param>
+			/// <returns>The hash of the file.</returns>
+			static uint64_t HashFile(const boost::filesystem::path& filepath);
+
+		private:
+			boost::filesystem::path		m_manifest_file_;
+			std::mutex					m_access_;
+			std::vector<ManifestEntry>	m_entries_;
+
+			/// <summary>
+			/// Reads the entries from the manifest file.
+			/// </summary>
+			void Load_(void);
+			/// <summary>
+			/// Writes the entries towards a temporary file, which then replaces the manifest file.
+			/// </summary>
+			void Save_(void);
+	};
+}
+#endif // __WSICS_NORMALIZATION_BATCHMANIFEST__
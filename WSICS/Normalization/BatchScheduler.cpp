@@ -0,0 +1,140 @@
+#include "BatchScheduler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <sstream>
+
+#include "../IO/Logging/LogHandler.h"
+
+namespace WSICS::Normalization
+{
+	BatchScheduler::BatchScheduler(Misc::ThreadPool& thread_pool, const size_t max_concurrent_jobs, const uint64_t memory_budget)
+		: m_max_concurrent_jobs_(max_concurrent_jobs == 0 ? thread_pool.Size() : max_concurrent_jobs), m_memory_budget_(memory_budget)
+	{
+	}
+
+	std::vector<BatchJobSummary> BatchScheduler::Execute(std::vector<BatchJob> jobs, const std::function<void(const BatchJob&)>& job_function)
+	{
+		IO::Logging::LogHandler* logging_instance(IO::Logging::LogHandler::GetInstance());
+
+		// Orders the jobs largest-first, the original order breaks ties to keep the schedule deterministic.
+		std::stable_sort(jobs.begin(), jobs.end(), [](const BatchJob& a, const BatchJob& b) { return a.size > b.size; });
+
+		std::mutex							state_access;
+		std::condition_variable				job_finished;
+		size_t								running_jobs = 0;
+		uint64_t							reserved_memory = 0;
+		std::vector<BatchJobSummary>		summaries;
+		std::vector<std::future<void>>		futures;
+		std::vector<bool>					started(jobs.size(), false);
+
+		summaries.reserve(jobs.size());
+		futures.reserve(jobs.size());
+
+		for (size_t started_jobs = 0; started_jobs < jobs.size(); ++started_jobs)
+		{
+			size_t selected_job = jobs.size();
+			size_t summary_index;
+			size_t concurrent_jobs;
+			{
+				std::unique_lock<std::mutex> lock(state_access);
+				job_finished.wait(lock, [&]()
+				{
+					if (running_jobs >= m_max_concurrent_jobs_)
+					{
+						return false;
+					}
+
+					// Selects the largest pending job that fits the remaining budget, or the largest overall if nothing is running.
+					for (size_t job = 0; job < jobs.size(); ++job)
+					{
+						if (!started[job] && (m_memory_budget_ == 0 || running_jobs == 0 || reserved_memory + jobs[job].estimated_memory <= m_memory_budget_))
+						{
+							selected_job = job;
+							return true;
+						}
+					}
+					return false;
+				});
+
+				started[selected_job] = true;
+				concurrent_jobs = ++running_jobs;
+				reserved_memory += jobs[selected_job].estimated_memory;
+
+				summary_index = summaries.size();
+				summaries.push_back({ jobs[selected_job].input_file, false, "", 0.0 });
+			}
+
+			logging_instance->QueueCommandLineLogging("Starting: " + jobs[selected_job].input_file.string() + " (" + std::to_string(concurrent_jobs) + " running)", IO::Logging::NORMAL);
+
+			// Runs the job on its own thread, leaving the pool to the work distributed by the job.
+			const BatchJob& job(jobs[selected_job]);
+			futures.push_back(std::async(std::launch::async, [&, summary_index]()
+			{
+				std::chrono::steady_clock::time_point start(std::chrono::steady_clock::now());
+
+				bool succeeded = true;
+				std::string error;
+				try
+				{
+					job_function(job);
+				}
+				catch (const std::exception& e)
+				{
+					succeeded	= false;
+					error		= e.what();
+				}
+				catch (...)
+				{
+					succeeded	= false;
+					error		= "Unknown error.";
+				}
+
+				double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+				std::lock_guard<std::mutex> lock(state_access);
+				summaries[summary_index].succeeded	= succeeded;
+				summaries[summary_index].error		= error;
+				summaries[summary_index].seconds	= seconds;
+
+				--running_jobs;
+				reserved_memory -= job.estimated_memory;
+				job_finished.notify_all();
+			}));
+		}
+
+		for (std::future<void>& future : futures)
+		{
+			future.get();
+		}
+
+		return summaries;
+	}
+
+	void BatchScheduler::LogSummary(const std::vector<BatchJobSummary>& summaries, const double wall_seconds, const size_t log_file_id)
+	{
+		IO::Logging::LogHandler* logging_instance(IO::Logging::LogHandler::GetInstance());
+
+		double total_seconds = 0.0;
+		size_t failed_jobs = 0;
+
+		std::stringstream summary_stream;
+		summary_stream << "=============================\nBatch summary\n=============================";
+		for (const BatchJobSummary& summary : summaries)
+		{
+			summary_stream << "\n" << summary.input_file.filename().string() << ": " << summary.seconds << "s";
+			if (!summary.succeeded)
+			{
+				summary_stream << " - FAILED: " << summary.error;
+				++failed_jobs;
+			}
+			total_seconds += summary.seconds;
+		}
+		summary_stream << "\nSlides: " << summaries.size() << ", failed: " << failed_jobs << ", cumulative slide time: " << total_seconds << "s, wall time: " << wall_seconds << "s";
+
+		logging_instance->QueueCommandLineLogging(summary_stream.str(), IO::Logging::NORMAL);
+		logging_instance->QueueFileLogging(summary_stream.str(), log_file_id, IO::Logging::NORMAL);
+	}
+}
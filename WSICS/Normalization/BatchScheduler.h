@@ -0,0 +1,83 @@
+#ifndef __WSICS_NORMALIZATION_BATCHSCHEDULER__
+#define __WSICS_NORMALIZATION_BATCHSCHEDULER__
+
+#include <functional>
+#include <future>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+#include "../Misc/ThreadPool.h"
+
+namespace WSICS::Normalization
+{
+	/// <summary>
+	/// Describes the normalization of a single slide.
+	/// </summary>
+	struct BatchJob
+	{
+		boost::filesystem::path	input_file;
+		boost::filesystem::path	image_output_file;
+		boost::filesystem::path	lut_output_file;
+		boost::filesystem::path	template_output_file;
+		boost::filesystem::path	debug_directory;
+		uint64_t				size;
+		uint64_t				estimated_memory;
+	};
+
+	/// <summary>
+	/// Holds the outcome of a single BatchJob.
+	/// </summary>
+	struct BatchJobSummary
+	{
+		boost::filesystem::path	input_file;
+		bool					succeeded;
+		std::string				error;
+		double					seconds;
+	};
+
+	/// <summary>
+	/// Runs several slide normalizations concurrently under a global memory and thread budget.
+	///
+	/// Jobs are started largest-first to shorten the total runtime. Whenever a job doesn't fit
+	/// within the remaining memory budget, smaller jobs that do fit are started instead. A job
+	/// that exceeds the budget on its own is only started when no other job is running.
+	///
+	/// Each job runs on a dedicated thread rather than on the pool. The workers of the pool are
+	/// therefore always available to the ParallelFor calls made within the jobs, which would
+	/// otherwise queue behind the other jobs and leave each slide to run on a single thread.
+	/// </summary>
+	class BatchScheduler
+	{
+		public:
+			/// <summary>
+			/// Constructs the scheduler.
+			/// </summary>
+			/// <param name="thread_pool">The pool the jobs distribute their work over, whose size bounds the amount of concurrent jobs.</param>
+			/// <param name="max_concurrent_jobs">The maximum amount of jobs that may run at once, 0 uses the pool size.</param>
+			/// <param name="memory_budget">The amount of bytes the running jobs may claim together, 0 disables the limit.</param>
+			BatchScheduler(Misc::ThreadPool& thread_pool, const size_t max_concurrent_jobs, const uint64_t memory_budget);
+
+			/// <summary>
+			/// Executes the jobs, returning once every job has finished. Exceptions are caught and reported through the summaries.
+			/// </summary>
+			/// <param name="jobs">The jobs to execute.</param>
+			/// <param name="job_function">The function that performs a job.</param>
+			/// <returns>A summary for each job, in the order in which they were started.</returns>
+			std::vector<BatchJobSummary> Execute(std::vector<BatchJob> jobs, const std::function<void(const BatchJob&)>& job_function);
+
+			/// <summary>
+			/// Writes a per slide timing summary to the command line and the log file.
+			/// </summary>
+			/// <param name="summaries">The summaries to write.</param>
+			/// <param name="wall_seconds">The elapsed time for the entire batch.</param>
+			/// <param name="log_file_id">The id of the log file to write towards.</param>
+			static void LogSummary(const std::vector<BatchJobSummary>& summaries, const double wall_seconds, const size_t log_file_id);
+
+		private:
+			size_t		m_max_concurrent_jobs_;
+			uint64_t	m_memory_budget_;
+	};
+}
+#endif // __WSICS_NORMALIZATION_BATCHSCHEDULER__
@@ -1,7 +1,11 @@
 #include "CLI.h"
 
+#include <algorithm>
+#include <chrono>
 #include <unordered_set>
-#include "../Misc/MT_Singleton.hpp"
+
+#include "BatchManifest.h"
+#include "BatchScheduler.h"
 
 namespace WSICS::Normalization
 {
@@ -22,6 +26,9 @@ namespace WSICS::Normalization
 		boost::filesystem::path template_output;
 		boost::filesystem::path debug_dir;
 		bool input_is_directory;
+		size_t thread_budget;
+		uint64_t memory_budget;
+		bool resume;
 
 		AcquireAndSanitizeInput_(
 			variables,
@@ -34,7 +41,10 @@ namespace WSICS::Normalization
 			template_input,
 			template_output,
 			debug_dir,
-			input_is_directory);
+			input_is_directory,
+			thread_budget,
+			memory_budget,
+			resume);
 
 		bool succesfully_created_directories = true;
 		try
@@ -49,9 +59,6 @@ namespace WSICS::Normalization
 			logging_instance->QueueCommandLineLogging("Unable to create directories, ending execution.", IO::Logging::SILENT);
 		}
 
-		// Sets the seed for deterministic processing.
-		Misc::MT_Singleton::SetSeed(parameters.seed);
-
 		// Attempts to utilize one of the output paths as path for the log file.
 		boost::filesystem::path log_path;
 		if (!image_output.empty())
@@ -69,22 +76,20 @@ namespace WSICS::Normalization
 
 		if (succesfully_created_directories && !log_path.empty())
 		{
-			std::string log_file;
-			if (input_is_directory)
-			{
-				log_file = log_path.string() + "/log.txt";
-			}
-			else
-			{
-				log_path = log_path.parent_path().string() + "/log.txt";
-			}
+			boost::filesystem::path log_directory(input_is_directory ? log_path : log_path.parent_path());
+			std::string log_file(log_directory.string() + "/log.txt");
 
+			Misc::ThreadPool thread_pool(thread_budget);
 			WSICS_Algorithm wsics(log_file, template_input, parameters);
+			wsics.SetThreadPool(&thread_pool);
+
+			// The manifest records every processed slide, allowing an interrupted batch to be resumed.
+			BatchManifest manifest(log_directory / "manifest.json");
+			std::string parameter_description(BatchManifest::DescribeParameters(parameters, template_input));
+
+			std::vector<BatchJob> jobs;
 			for (const boost::filesystem::path& filepath : files_to_process)
 			{
-				std::string extension(filepath.extension().string());
-				std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
-
 				boost::filesystem::path image_output_file;
 				boost::filesystem::path lut_output_file;
 				boost::filesystem::path template_output_file;
@@ -103,7 +108,68 @@ namespace WSICS::Normalization
 					template_output_file = SetOutputPath(template_output, "csv", "");
 				}
 
-				wsics.Normalize(filepath, image_output_file, lut_output_file, template_output_file, file_debug_dir);
+				BatchJob job{ filepath, image_output_file, lut_output_file, template_output_file, file_debug_dir, GetSlideSize_(filepath), 0 };
+				if (resume && manifest.IsComplete(job, parameter_description))
+				{
+					IO::Logging::LogHandler::GetInstance()->QueueCommandLineLogging("Skipping: " + filepath.string() + ", already completed.", IO::Logging::NORMAL);
+					continue;
+				}
+
+				// Only the pending slides are opened to estimate their memory.
+				job.estimated_memory = WSICS_Algorithm::EstimatePeakMemory(filepath, parameters);
+				jobs.push_back(job);
+			}
+
+			if (jobs.empty())
+			{
+				IO::Logging::LogHandler::GetInstance()->QueueCommandLineLogging("Every slide has already been completed.", IO::Logging::NORMAL);
+				return;
+			}
+
+			// Runs the slides concurrently, within the thread and memory budget.
+			std::chrono::steady_clock::time_point batch_start(std::chrono::steady_clock::now());
+
+			BatchScheduler scheduler(thread_pool, 0, memory_budget);
+			std::vector<BatchJobSummary> summaries(scheduler.Execute(jobs, [&wsics, &manifest, &parameter_description](const BatchJob& job)
+			{
+				ManifestEntry entry(BatchManifest::CreateEntry(job, parameter_description));
+				std::chrono::steady_clock::time_point start(std::chrono::steady_clock::now());
+				try
+				{
+					entry.stage_timings = wsics.Normalize(job.input_file, job.image_output_file, job.lut_output_file, job.template_output_file, job.debug_directory);
+					entry.completed		= true;
+				}
+				catch (const std::exception& e)
+				{
+					entry.error = e.what();
+				}
+				entry.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+				// A manifest that can't be updated only affects resuming, the outcome of the slide is decided by the normalization.
+				try
+				{
+					manifest.Record(entry);
+				}
+				catch (const std::exception& e)
+				{
+					std::string log_text("Unable to record " + job.input_file.string() + " in the manifest: " + e.what());
+					IO::Logging::LogHandler::GetInstance()->QueueCommandLineLogging(log_text, IO::Logging::NORMAL);
+					IO::Logging::LogHandler::GetInstance()->QueueFileLogging(log_text, wsics.GetLogFileId(), IO::Logging::NORMAL);
+				}
+
+				if (!entry.completed)
+				{
+					throw std::runtime_error(entry.error);
+				}
+			}));
+
+			if (input_is_directory)
+			{
+				BatchScheduler::LogSummary(summaries, std::chrono::duration<double>(std::chrono::steady_clock::now() - batch_start).count(), wsics.GetLogFileId());
+			}
+			else if (!summaries[0].succeeded)
+			{
+				throw std::runtime_error(summaries[0].error);
 			}
 		}
 	}
@@ -125,7 +191,16 @@ namespace WSICS::Normalization
 			("eosin_percentile", boost::program_options::value<float>()->default_value(0.2f), "Defines how conservative the algorithm is with its red pixel classification.")
 			("background_threshold", boost::program_options::value<float>()->default_value(0.9f), "Defines the threshold between tissue and background pixels.")
 			("min_ellipses", boost::program_options::value<int32_t>()->default_value(0), "Allows for a custom value for the amount of ellipses on a tile.")
-			("seed,s", boost::program_options::value<uint64_t>()->default_value(1000), "Defines the seed used for random processing.");
+			("convergence_trials", boost::program_options::value<uint32_t>()->default_value(0), "Ends an ellipse detection epoch once this many consecutive triplets fail to approach an accumulator threshold. Trades a little recall for speed on busy tiles, 0 disables the criterion.")
+			("nucleus_detector", boost::program_options::value<std::string>()->default_value("hough"), "The method used to detect the nuclei. Either hough, which applies a randomized Hough transform onto the density edges, or contour, which fits ellipses onto the thresholded density. The latter is faster and deterministic, but separates touching nuclei less reliably.")
+			("detection_downsample", boost::program_options::value<uint32_t>()->default_value(1), "Detects the nuclei on a density downsampled by this factor, with the nucleus radii scaled to match. A factor of 2 reduces the detection work roughly fourfold.")
+			("refine_detections", boost::program_options::value<bool>()->default_value(false)->implicit_value(true), "Refines the nuclei detected on a downsampled density by fitting them onto the full resolution edges around each of them.")
+			("knn_voxels", boost::program_options::value<uint32_t>()->default_value(0), "Classifies the tile pixels through a table of votes over a voxel grid with this many voxels along each of the Cx, Cy and density axes, instead of a K-NN search per pixel. At most 128, 0 disables the table.")
+			("no_triage", boost::program_options::value<bool>()->default_value(false)->implicit_value(true), "Disables the triage that skips tiles with too little tissue, ink, too few edges or an almost uniform density before their nuclei are detected.")
+			("seed,s", boost::program_options::value<uint64_t>()->default_value(1000), "Defines the seed used for random processing.")
+			("threads", boost::program_options::value<uint32_t>()->default_value(0), "The amount of threads shared by all slides. 0 uses the amount of hardware threads.")
+			("memory_budget", boost::program_options::value<uint32_t>()->default_value(0), "The amount of memory in MB that concurrently processed slides may claim together. 0 disables the limit, restricting concurrency by the thread count only.")
+			("resume", boost::program_options::value<bool>()->default_value(false)->implicit_value(true), "Skips slides that the manifest next to the log file lists as completed, as long as their input, parameters and outputs are unchanged.");
 	}
 
 	void CLI::Setup$(void)
@@ -143,7 +218,10 @@ namespace WSICS::Normalization
 		boost::filesystem::path& template_input,
 		boost::filesystem::path& template_output,
 		boost::filesystem::path& debug_dir,
-		bool& input_is_directory)
+		bool& input_is_directory,
+		size_t& thread_budget,
+		uint64_t& memory_budget,
+		bool& resume)
 	{
 		parameters.consider_ink = variables["ink"].as<bool>();
 		input_is_directory = boost::filesystem::is_directory(variables["input"].as<std::string>());
@@ -178,6 +256,10 @@ namespace WSICS::Normalization
 
 		parameters.seed = variables["seed"].as<uint64_t>();
 
+		thread_budget = variables["threads"].as<uint32_t>();
+		memory_budget = static_cast<uint64_t>(variables["memory_budget"].as<uint32_t>()) * 1024 * 1024;
+		resume = variables["resume"].as<bool>();
+
 		prefix = variables["prefix"].as<std::string>();
 		postfix = variables["postfix"].as<std::string>();
 
@@ -235,6 +317,26 @@ namespace WSICS::Normalization
 		parameters.eosin_percentile		= variables["eosin_percentile"].as<float>();
 		parameters.background_threshold = variables["background_threshold"].as<float>();
 		parameters.minimum_ellipses		= variables["min_ellipses"].as<int32_t>();
+		parameters.convergence_trials	= variables["convergence_trials"].as<uint32_t>();
+
+		parameters.detection_downsample	= std::max<uint32_t>(variables["detection_downsample"].as<uint32_t>(), 1);
+		parameters.refine_detections	= variables["refine_detections"].as<bool>();
+		parameters.knn_voxel_resolution	= std::min<uint32_t>(variables["knn_voxels"].as<uint32_t>(), 128);
+		parameters.tile_triage			= !variables["no_triage"].as<bool>();
+
+		std::string nucleus_detector(variables["nucleus_detector"].as<std::string>());
+		if (nucleus_detector == "hough")
+		{
+			parameters.nucleus_detection = HE_Staining::NUCLEUS_DETECTION_HOUGH;
+		}
+		else if (nucleus_detector == "contour")
+		{
+			parameters.nucleus_detection = HE_Staining::NUCLEUS_DETECTION_CONTOUR;
+		}
+		else
+		{
+			throw std::runtime_error("Unknown nucleus detector: " + nucleus_detector + ". Use either hough or contour.");
+		}
 
 		if (parameters.hema_percentile > 1.0f)
 		{
@@ -336,9 +438,38 @@ namespace WSICS::Normalization
 			}
 		}
 
+		std::sort(files.begin(), files.end());
 		return files;
 	}
 
+	uint64_t CLI::GetSlideSize_(const boost::filesystem::path& filepath)
+	{
+		boost::system::error_code error;
+		uint64_t size = boost::filesystem::file_size(filepath, error);
+		if (error)
+		{
+			size = 0;
+		}
+
+		// Formats such as MRXS store their data within a directory next to the index file.
+		boost::filesystem::path data_directory(filepath.parent_path() / filepath.stem());
+		if (boost::filesystem::is_directory(data_directory, error))
+		{
+			boost::filesystem::directory_iterator begin(data_directory, error), end;
+			for (; !error && begin != end; begin.increment(error))
+			{
+				uint64_t file_size = boost::filesystem::file_size(begin->path(), error);
+				if (!error)
+				{
+					size += file_size;
+				}
+				error.clear();
+			}
+		}
+
+		return size;
+	}
+
 	boost::filesystem::path CLI::SetOutputPath(boost::filesystem::path path, const std::string extension, const std::string filename)
 	{
 		if (!path.empty())
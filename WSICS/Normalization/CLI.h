@@ -50,6 +50,9 @@ namespace WSICS::Normalization
 			/// <param name="template_output">The file or directory path to where the template output should occur.</param>
 			/// <param name="debug_dir">The directory where debug data should be written to.</param>
 			/// <param name="input_is_directory">Whether or not a file or directory path has been offered.</param>
+			/// <param name="thread_budget">The amount of threads shared by all slides.</param>
+			/// <param name="memory_budget">The amount of bytes concurrently processed slides may claim together.</param>
+			/// <param name="resume">Whether or not slides that have already been completed should be skipped.</param>
 			void AcquireAndSanitizeInput_(
 				const boost::program_options::variables_map& variables,
 				WSICS_Parameters& parameters,
@@ -61,7 +64,10 @@ namespace WSICS::Normalization
 				boost::filesystem::path& template_input,
 				boost::filesystem::path& template_output,
 				boost::filesystem::path& debug_dir,
-				bool& input_is_directory);
+				bool& input_is_directory,
+				size_t& thread_budget,
+				uint64_t& memory_budget,
+				bool& resume);
 
 
 			/// <summary>
@@ -88,6 +94,12 @@ namespace WSICS::Normalization
 			/// <param name="input_path">A path pointing either towards an image file, or a directory containing image files.</param>
 			/// <returns>A vector holding all the eligble image files.</returns>
 			std::vector<boost::filesystem::path> GatherImageFilenames_(const boost::filesystem::path input_path);
+			/// <summary>
+			/// Returns the size of a slide on disk, including a potential data directory next to it.
+			/// </summary>
+			/// <param name="filepath">The path towards the slide.</param>
+			/// <returns>The size of the slide in bytes.</returns>
+			uint64_t GetSlideSize_(const boost::filesystem::path& filepath);
 
 
 			/// <summary>
@@ -16,6 +16,7 @@ namespace WSICS::Normalization::NormalizedLutCreation
 		const HSD::HSD_Model& lut_hsd,
 		const TrainingSampleInformation& training_samples,
 		const uint32_t max_training_size,
+		const std::string& log_prefix,
 		const size_t log_file_id)
 	{
 		IO::Logging::LogHandler* logging_instance(IO::Logging::LogHandler::GetInstance());
@@ -24,7 +25,7 @@ namespace WSICS::Normalization::NormalizedLutCreation
 		//	Transforming Cx and Cy distributions - Initialization 1
 		//  Extracting all the parameters needed for applying the transformation
 		//===========================================================================
-		logging_instance->QueueFileLogging("Defining variables for transformation...", log_file_id, IO::Logging::NORMAL);
+		logging_instance->QueueFileLogging("Defining variables for transformation...", log_prefix, log_file_id, IO::Logging::NORMAL);
 
 		TransformCxCyDensity::ClassAnnotatedCxCy train_data(TransformCxCyDensity::ClassCxCyGenerator(training_samples.class_data, training_samples.training_data_cx_cy));
 
@@ -46,7 +47,7 @@ namespace WSICS::Normalization::NormalizedLutCreation
 
 		TransformCxCyDensity::ClassDensityRanges class_density_ranges(TransformCxCyDensity::GetDensityRanges(training_samples.class_data, training_samples.training_data_density, class_pixel_indices));
 
-		logging_instance->QueueFileLogging("Finished computing tranformation parameters for the current image", log_file_id, IO::Logging::NORMAL);
+		logging_instance->QueueFileLogging("Finished computing tranformation parameters for the current image", log_prefix, log_file_id, IO::Logging::NORMAL);
 
 		//===========================================================================
 		//	Prepares the weight generation.
@@ -66,10 +67,10 @@ namespace WSICS::Normalization::NormalizedLutCreation
 			downsample = 30;
 		}
 
-		logging_instance->QueueFileLogging("Down sampling the data for constructing NB classifier", log_file_id, IO::Logging::NORMAL);
+		logging_instance->QueueFileLogging("Down sampling the data for constructing NB classifier", log_prefix, log_file_id, IO::Logging::NORMAL);
 		TrainingSampleInformation sample_info_downsampled(DownsampleforNbClassifier(training_samples, downsample, max_training_size));
 
-		logging_instance->QueueFileLogging("Generating weights with NB classifier", log_file_id, IO::Logging::NORMAL);
+		logging_instance->QueueFileLogging("Generating weights with NB classifier", log_prefix, log_file_id, IO::Logging::NORMAL);
 		logging_instance->QueueCommandLineLogging("Generating the weights, Setting dataset of size " + std::to_string(sample_info_downsampled.class_data.rows * sample_info_downsampled.class_data.cols), IO::Logging::NORMAL);
 
 		ML::NaiveBayesClassifier classifier(CxCyWeights::CreateNaiveBayesClassifier(sample_info_downsampled.training_data_cx_cy.col(0), sample_info_downsampled.training_data_cx_cy.col(1), sample_info_downsampled.training_data_density, sample_info_downsampled.class_data));
@@ -90,13 +91,13 @@ namespace WSICS::Normalization::NormalizedLutCreation
 			throw std::runtime_error(std::string("Unable to generate LUT weights. Following error was detected:\n") + std::string(e.what()));
 		}
 		logging_instance->QueueCommandLineLogging("All weights created...", IO::Logging::NORMAL);
-		logging_instance->QueueFileLogging("Weights generated", log_file_id, IO::Logging::NORMAL);
+		logging_instance->QueueFileLogging("Weights generated", log_prefix, log_file_id, IO::Logging::NORMAL);
 
 		//===========================================================================
 		//	Defining Template Parameters
 		//===========================================================================
 		TransformationParameters calculated_transform_parameters{ hema_rotation_info, eosin_rotation_info, background_rotation_info, hema_scale_parameters, eosin_scale_parameters, class_density_ranges };
-		TransformationParameters lut_transform_parameters(HandleParameterization(calculated_transform_parameters, template_file, template_output, log_file_id)); // Copies the calculated_transform_parameters or reads a new set from the offered filepath.
+		TransformationParameters lut_transform_parameters(HandleParameterization(calculated_transform_parameters, template_file, template_output, log_prefix, log_file_id)); // Copies the calculated_transform_parameters or reads a new set from the offered filepath.
 
 		if (!generate_lut)
 		{
@@ -107,7 +108,7 @@ namespace WSICS::Normalization::NormalizedLutCreation
 		//	Transforming Cx and Cy distributions - Initialization
 		//===========================================================================
 		logging_instance->QueueCommandLineLogging("Transformation started...", IO::Logging::NORMAL);
-		logging_instance->QueueFileLogging("Transformation started...", log_file_id, IO::Logging::NORMAL);
+		logging_instance->QueueFileLogging("Transformation started...", log_prefix, log_file_id, IO::Logging::NORMAL);
 
 		cv::Mat lut_cx_cy;
 		cv::hconcat(std::vector<cv::Mat>{ lut_hsd.c_x, lut_hsd.c_y }, lut_cx_cy);
@@ -116,20 +117,20 @@ namespace WSICS::Normalization::NormalizedLutCreation
 		//===========================================================================
 		//	Generating the weights for each class
 		//===========================================================================
-		logging_instance->QueueFileLogging("Applying weights...", log_file_id, IO::Logging::NORMAL);
+		logging_instance->QueueFileLogging("Applying weights...", log_prefix, log_file_id, IO::Logging::NORMAL);
 
 		cv::Mat cx_cy_normalized(CxCyWeights::ApplyWeights(lut_transformation_results[0], lut_transformation_results[1], lut_transformation_results[2], weights));
 
 		//===========================================================================
 		//	Density scaling
 		//===========================================================================
-		logging_instance->QueueFileLogging("Density transformation...", log_file_id, IO::Logging::NORMAL);
+		logging_instance->QueueFileLogging("Density transformation...", log_prefix, log_file_id, IO::Logging::NORMAL);
 		cv::Mat density_scaling(TransformCxCyDensity::DensityNormalizationThreeScales(calculated_transform_parameters.class_density_ranges, lut_transform_parameters.class_density_ranges, lut_hsd.density, weights));
 
 		//===========================================================================
 		//	HSD reverse
 		//===========================================================================
-		logging_instance->QueueFileLogging("HSD reverse...", log_file_id, IO::Logging::NORMAL);
+		logging_instance->QueueFileLogging("HSD reverse...", log_prefix, log_file_id, IO::Logging::NORMAL);
 		cv::Mat normalized_image_rgb;
 		HSD::CxCyToRGB(cx_cy_normalized, normalized_image_rgb, density_scaling);
 		return normalized_image_rgb;
@@ -155,20 +156,20 @@ namespace WSICS::Normalization::NormalizedLutCreation
 		return sample_info_downsampled;
 	}
 
-	TransformationParameters HandleParameterization(const TransformationParameters& calc_params, const boost::filesystem::path& template_file, const boost::filesystem::path& template_output, const size_t log_file_id)
+	TransformationParameters HandleParameterization(const TransformationParameters& calc_params, const boost::filesystem::path& template_file, const boost::filesystem::path& template_output, const std::string& log_prefix, const size_t log_file_id)
 	{
 		IO::Logging::LogHandler* logging_instance(IO::Logging::LogHandler::GetInstance());
 
 		TransformationParameters lut_params = calc_params;
 		if (!template_file.empty())
 		{
-			logging_instance->QueueFileLogging("Loading Template parameters...", log_file_id, IO::Logging::NORMAL);
+			logging_instance->QueueFileLogging("Loading Template parameters...", log_prefix, log_file_id, IO::Logging::NORMAL);
 			std::ifstream csv_input_stream;
 			csv_input_stream.open(template_file.string());
 			if (!csv_input_stream)
 			{
 				logging_instance->QueueCommandLineLogging("Could not read CSV file!", IO::Logging::NORMAL);
-				logging_instance->QueueFileLogging("Could not read template CSV file!", log_file_id, IO::Logging::NORMAL);
+				logging_instance->QueueFileLogging("Could not read template CSV file!", log_prefix, log_file_id, IO::Logging::NORMAL);
 
 				throw std::runtime_error("Could not read CSV file.");
 			}
@@ -181,7 +182,7 @@ namespace WSICS::Normalization::NormalizedLutCreation
 
 		if (!template_output.empty())
 		{
-			logging_instance->QueueFileLogging("Saving Template parameters...", log_file_id, IO::Logging::NORMAL);
+			logging_instance->QueueFileLogging("Saving Template parameters...", log_prefix, log_file_id, IO::Logging::NORMAL);
 			std::ofstream csv_output_stream;
 			csv_output_stream.open(template_output.string());
 			if (csv_output_stream)
@@ -190,12 +191,12 @@ namespace WSICS::Normalization::NormalizedLutCreation
 				csv_output_stream.close();
 
 				logging_instance->QueueCommandLineLogging("Done", IO::Logging::NORMAL);
-				logging_instance->QueueFileLogging("Template Parameters written to: " + template_output.string(), log_file_id, IO::Logging::NORMAL);
+				logging_instance->QueueFileLogging("Template Parameters written to: " + template_output.string(), log_prefix, log_file_id, IO::Logging::NORMAL);
 			}
 			else
 			{
 				logging_instance->QueueCommandLineLogging("Could not write template CSV file!", IO::Logging::NORMAL);
-				logging_instance->QueueFileLogging("Could not write template CSV file!", log_file_id, IO::Logging::NORMAL);
+				logging_instance->QueueFileLogging("Could not write template CSV file!", log_prefix, log_file_id, IO::Logging::NORMAL);
 			}
 		}
 
@@ -38,10 +38,11 @@ namespace WSICS::Normalization::NormalizedLutCreation
 		const HSD::HSD_Model& lut_hsd,
 		const TrainingSampleInformation& training_sample,
 		const uint32_t max_training_size,
+		const std::string& log_prefix,
 		const size_t log_file_id);
 
 	TrainingSampleInformation DownsampleforNbClassifier(const TrainingSampleInformation& training_samples, const uint32_t downsample, const uint32_t max_training_size);
-	TransformationParameters HandleParameterization(const TransformationParameters& calc_params, const boost::filesystem::path& template_file, const boost::filesystem::path& template_output, const size_t log_file_id);
+	TransformationParameters HandleParameterization(const TransformationParameters& calc_params, const boost::filesystem::path& template_file, const boost::filesystem::path& template_output, const std::string& log_prefix, const size_t log_file_id);
 	std::vector<cv::Mat> InitializeTransformation(
 		const cv::Mat& training_cx_cy,
 		const cv::Mat& lut_cx_cy,
@@ -1,13 +1,16 @@
 #include "NormalizedOutput.h"
 
+#include <algorithm>
+#include <cmath>
+#include <memory>
+
 #include "multiresolutionimageinterface/MultiResolutionImageReader.h"
 #include "multiresolutionimageinterface/MultiResolutionImageWriter.h"
 #include <opencv2/highgui.hpp>
 
 #include "../IO/Logging/LogHandler.h"
-#include "../Misc/LevelReading.h"
+#include "../Misc/TileReader.h"
 #include "../Misc/Random.h"
-#include "../Misc/MT_Singleton.hpp"
 
 namespace WSICS::Normalization
 {
@@ -57,18 +60,25 @@ namespace WSICS::Normalization
 		}
 	}
 
-	void WriteNormalizedWSI(const boost::filesystem::path& input_file, const boost::filesystem::path& output_file, const cv::Mat& normalized_lut, const uint32_t tile_size)
+	void WriteNormalizedWSI(const boost::filesystem::path& input_file, const boost::filesystem::path& output_file, const cv::Mat& normalized_lut, const uint32_t tile_size, WriteJournal& journal)
 	{
 		IO::Logging::LogHandler* logging_instance(IO::Logging::LogHandler::GetInstance());
 
 		MultiResolutionImageReader reader;
-		MultiResolutionImage* tiled_image = reader.open(input_file.string());
+		std::unique_ptr<MultiResolutionImage> tiled_image(reader.open(input_file.string()));
+		if (!tiled_image)
+		{
+			throw std::runtime_error("Unable to open file: " + input_file.string());
+		}
 		const std::vector<unsigned long long> dimensions = tiled_image->getLevelDimensions(0);
 
 		logging_instance->QueueCommandLineLogging("X and Y dimensions for lowest level: " + std::to_string(dimensions[0]) + " " + std::to_string(dimensions[1]), IO::Logging::NORMAL);
 
+		// The image is written towards the partial file, which only replaces the output once it's complete.
+		boost::filesystem::path partial_file(journal.GetPartialFile());
+
 		MultiResolutionImageWriter image_writer;
-		image_writer.openFile(output_file.string());
+		image_writer.openFile(partial_file.string());
 		image_writer.setTileSize(tile_size);
 		image_writer.setCompression(pathology::Compression::LZW);
 		image_writer.setDataType(pathology::UChar);
@@ -77,48 +87,82 @@ namespace WSICS::Normalization
 
 		uint64_t x_amount_of_tiles = std::ceil((float)dimensions[0] / (float)tile_size);
 		uint64_t y_amount_of_tiles = std::ceil((float)dimensions[1] / (float)tile_size);
-		uint64_t total_amount_of_tiles = x_amount_of_tiles * y_amount_of_tiles;
 
-		std::vector<uint64_t> x_values, y_values;
+		std::vector<cv::Mat> lut_bgr;
+		cv::split(normalized_lut, lut_bgr);
+
+		Misc::TileReader tile_reader(*tiled_image, tile_size);
+
+		// Stacks the tiles of a row vertically, so that each tile occupies a contiguous block of memory.
+		const size_t tile_bytes = tile_size * tile_size * 3;
+		cv::Mat row_tiles(tile_size * x_amount_of_tiles, tile_size, CV_8UC3);
 
-		for (uint64_t x_tile = 0; x_tile < x_amount_of_tiles; ++x_tile)
+		// Tiles are written in row-major order, which is the order in which TIFF stores them.
+		uint64_t completed_rows = std::min(journal.GetCompletedRows(), y_amount_of_tiles);
+		if (completed_rows > 0)
 		{
-			for (uint64_t y_tile = 0; y_tile < y_amount_of_tiles; ++y_tile)
-			{
-				y_values.push_back(tile_size*y_tile);
-				x_values.push_back(tile_size*x_tile);
-			}
+			logging_instance->QueueCommandLineLogging("Continuing from row " + std::to_string(completed_rows) + " of " + std::to_string(y_amount_of_tiles) + ".", IO::Logging::NORMAL);
 		}
 
-		std::vector<cv::Mat> lut_bgr;
-		cv::split(normalized_lut, lut_bgr);
-
-		size_t response_integer = total_amount_of_tiles / 20;
-		for (uint64_t tile = 0; tile < total_amount_of_tiles; ++tile)
+		size_t response_integer = std::max<uint64_t>(y_amount_of_tiles / 20, 1);
+		for (uint64_t y_tile = 0; y_tile < y_amount_of_tiles; ++y_tile)
 		{
-			if (tile % response_integer == 0)
+			if (y_tile % response_integer == 0)
+			{
+				logging_instance->QueueCommandLineLogging("Completed: " + std::to_string((y_tile * 100) / y_amount_of_tiles) + "%", IO::Logging::NORMAL);
+			}
+
+			// Replays the spooled row, falling back to the source image if the row is unreadable.
+			if (y_tile < completed_rows)
 			{
-				logging_instance->QueueCommandLineLogging("Completed: " + std::to_string((tile / response_integer) * 5) + "%", IO::Logging::NORMAL);
+				cv::Mat spooled_row(cv::imread(journal.GetRowFile(y_tile).string(), cv::IMREAD_UNCHANGED));
+				if (spooled_row.size() == row_tiles.size() && spooled_row.type() == row_tiles.type() && spooled_row.isContinuous())
+				{
+					for (uint64_t x_tile = 0; x_tile < x_amount_of_tiles; ++x_tile)
+					{
+						image_writer.writeBaseImagePart((void*)(spooled_row.data + x_tile * tile_bytes));
+					}
+					continue;
+				}
+
+				logging_instance->QueueCommandLineLogging("Unable to read the spooled row " + std::to_string(y_tile) + ", continuing from the source image.", IO::Logging::NORMAL);
+				completed_rows = y_tile;
 			}
 
-			uchar* data = nullptr;
-			tiled_image->getRawRegion(x_values[tile] * tiled_image->getLevelDownsample(0), y_values[tile] * tiled_image->getLevelDownsample(0), tile_size, tile_size, 0, data);
+			for (uint64_t x_tile = 0; x_tile < x_amount_of_tiles; ++x_tile)
+			{
+				const uchar* data = tile_reader.Read(x_tile * tile_size * tiled_image->getLevelDownsample(0), y_tile * tile_size * tiled_image->getLevelDownsample(0), 0);
 
-			ApplyLUT(data, data, lut_bgr[0], lut_bgr[1], lut_bgr[2], tile_size);
-			image_writer.writeBaseImagePart((void*)data);
-			delete[] data;
+				uchar* tile = row_tiles.data + x_tile * tile_bytes;
+				ApplyLUT(data, tile, lut_bgr[0], lut_bgr[1], lut_bgr[2], tile_size);
+				image_writer.writeBaseImagePart((void*)tile);
+			}
+
+			std::vector<int> png_parameters{ cv::IMWRITE_PNG_COMPRESSION, 1 };
+			if (!cv::imwrite(journal.GetRowFile(y_tile).string(), row_tiles, png_parameters))
+			{
+				throw std::runtime_error("Unable to spool row " + std::to_string(y_tile) + " to: " + journal.GetRowFile(y_tile).string());
+			}
+			journal.SetCompletedRows(++completed_rows);
 		}
-		
 
 		logging_instance->QueueCommandLineLogging("Finalizing images", IO::Logging::NORMAL);
 		image_writer.finishImage();
+		tiled_image.reset();
+
+		boost::filesystem::rename(partial_file, output_file);
+		journal.Remove();
 	}
 
 	void WriteNormalizedWSI(const cv::Mat& static_image, const boost::filesystem::path& output_file, const cv::Mat& normalized_lut)
 	{
 		cv::Mat normalized_image;
 		ApplyLUT(static_image, normalized_image, normalized_lut);
-		cv::imwrite(output_file.string(), normalized_image);
+
+		// Writes towards a partial file first, so that an interruption never leaves a truncated image behind.
+		boost::filesystem::path partial_file(output_file.parent_path() / (output_file.stem().string() + ".partial" + output_file.extension().string()));
+		cv::imwrite(partial_file.string(), normalized_image);
+		boost::filesystem::rename(partial_file, output_file);
 
 		IO::Logging::LogHandler* logging_instance(IO::Logging::LogHandler::GetInstance());
 		logging_instance->QueueCommandLineLogging("Normalized image written to: " + output_file.string(), IO::Logging::NORMAL);
@@ -139,23 +183,23 @@ namespace WSICS::Normalization
 		const cv::Mat& normalized_lut,
 		MultiResolutionImage& tiled_image,
 		const std::vector<cv::Point>& tile_coordinates,
-		const uint32_t tile_size)
+		const uint32_t tile_size,
+		const uint64_t seed)
 	{
 		IO::Logging::LogHandler* logging_instance(IO::Logging::LogHandler::GetInstance());
 
 		logging_instance->QueueCommandLineLogging("Writing sample standardized images in: " + output_directory.string(), IO::Logging::NORMAL);
 
-		std::vector<size_t> random_integers(Misc::Random::CreateListOfRandomIntegers(tile_coordinates.size(), Misc::MT_Singleton::GetGenerator()));
+		boost::mt19937_64 generator(Misc::Random::CreateStream(seed, Misc::Random::STREAM_SAMPLE_OUTPUT));
+		std::vector<size_t> random_integers(Misc::Random::CreateListOfRandomIntegers(tile_coordinates.size(), generator));
 
 		size_t num_to_write = 20 > tile_coordinates.size() ? tile_coordinates.size() : 20;
-		cv::Mat tile_image(cv::Mat::zeros(tile_size, tile_size, CV_8UC3));
+		Misc::TileReader tile_reader(tiled_image, tile_size);
+		cv::Mat tile_image;
 		for (size_t tile = 0; tile < num_to_write; ++tile)
 		{
-			unsigned char* data = nullptr;
-			tiled_image.getRawRegion(tile_coordinates[random_integers[tile]].x * tiled_image.getLevelDownsample(0), tile_coordinates[random_integers[tile]].y * tiled_image.getLevelDownsample(0), tile_size, tile_size, 0, data);
-			cv::Mat tile_image = cv::Mat::zeros(tile_size, tile_size, CV_8UC3);
-			Misc::LevelReading::ArrayToMatrix(data, tile_image, 0);
-			delete[] data;
+			tile_reader.Read(tile_coordinates[random_integers[tile]].x * tiled_image.getLevelDownsample(0), tile_coordinates[random_integers[tile]].y * tiled_image.getLevelDownsample(0), 0);
+			tile_reader.CopyBGR(tile_image);
 
 			ApplyLUT(tile_image, tile_image, normalized_lut);
 			std::string filename_lut(output_directory.string() + "/" + "tile_" + std::to_string(random_integers[tile]) + "_normalized.tif");
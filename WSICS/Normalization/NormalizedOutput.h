@@ -10,6 +10,8 @@
 #include "multiresolutionimageinterface/MultiResolutionImageReader.h"
 #include "multiresolutionimageinterface/MultiResolutionImageWriter.h"
 
+#include "WriteJournal.h"
+
 namespace WSICS::Normalization
 {
 	/// <summary>
@@ -37,13 +39,15 @@ namespace WSICS::Normalization
 	void ApplyLUT(const unsigned char* source, unsigned char* destination, const cv::Mat& blue_lut, const cv::Mat& green_lut, const cv::Mat& red_lut, const size_t tile_size);
 
 	/// <summary>
-	/// Writes a normalized WSI to the passed file path.
+	/// Writes a normalized WSI to the passed file path. The image is written towards a partial file that
+	/// replaces the output once finished. Continues from the rows the journal lists as completed.
 	/// </summary>
 	/// <param name="input_file">The original WSI file path.</param>
 	/// <param name="output_file">The file path for the resulting output WSI.</param>
 	/// <param name="normalized_lut">The LUT to use for the normalization of the WSI.</param>
 	/// <param name="tile_size">The tile size of the original WSI.</param>
-	void WriteNormalizedWSI(const boost::filesystem::path& input_file, const boost::filesystem::path& output_file, const cv::Mat& normalized_lut, const uint32_t tile_size);
+	/// <param name="journal">The journal that tracks the progress, which is removed once the output is finalized.</param>
+	void WriteNormalizedWSI(const boost::filesystem::path& input_file, const boost::filesystem::path& output_file, const cv::Mat& normalized_lut, const uint32_t tile_size, WriteJournal& journal);
 	/// <summary>
 	/// Writes a normalized WSI to the passed file path.
 	/// </summary>
@@ -68,6 +72,7 @@ namespace WSICS::Normalization
 	/// <param name="tiled_image">The image to select the samples from.</param>
 	/// <param name="tile_coordinates">The coordinates for each tile within the image.</param>
 	/// <param name="tile_size">The size of each tile.</param>
-	void WriteNormalizedSamples(const boost::filesystem::path& output_directory, const cv::Mat& lut_image, MultiResolutionImage& tiled_image, const std::vector<cv::Point>& tile_coordinates, const uint32_t tile_size);
+	/// <param name="seed">The seed from which the stream used for selecting the samples is derived.</param>
+	void WriteNormalizedSamples(const boost::filesystem::path& output_directory, const cv::Mat& lut_image, MultiResolutionImage& tiled_image, const std::vector<cv::Point>& tile_coordinates, const uint32_t tile_size, const uint64_t seed);
 };
 #endif // __WSICS_NORMALIZATION_NORMALIZEDOUTPUT__
\ No newline at end of file
@@ -1,19 +1,26 @@
 #include "PixelClassificationHE.h"
 
+#include <algorithm>
+#include <memory>
+
 #include <boost/filesystem.hpp>
 #include <opencv2/highgui.hpp>
 
+#include "../HE_Staining/ContourNucleusDetector.h"
+#include "../HE_Staining/HoughNucleusDetector.h"
+#include "../HE_Staining/MultiScaleNucleusDetector.h"
+#include "../HE_Staining/TileTriage.h"
 #include "../HSD/BackgroundMask.h"
 #include "../IO/Logging/LogHandler.h"
-#include "../Misc/LevelReading.h"
+#include "../Misc/TileReader.h"
 #include "../Misc/Random.h"
-#include "../Misc/MT_Singleton.hpp"
 
 // TODO: Improve structure and refactor InsertTrainingData_
 
 namespace WSICS::Normalization
 {
-	PixelClassificationHE::PixelClassificationHE(const bool consider_ink, const size_t log_file_id, const std::string debug_dir) : m_consider_ink_(consider_ink), m_log_file_id_(log_file_id), m_debug_dir_(debug_dir)
+	PixelClassificationHE::PixelClassificationHE(const bool consider_ink, const size_t log_file_id, const std::string log_prefix, const std::string debug_dir, Misc::ThreadPool* thread_pool)
+		: m_consider_ink_(consider_ink), m_log_file_id_(log_file_id), m_log_prefix_(log_prefix), m_debug_dir_(debug_dir), m_thread_pool_(thread_pool)
 	{
 	}
 
@@ -45,12 +52,24 @@ namespace WSICS::Normalization
 
 		TrainingSampleInformation sample_information{ cv::Mat::zeros(parameters.max_training_size, 2, CV_32FC1), cv::Mat::zeros(parameters.max_training_size, 1, CV_32FC1), cv::Mat::zeros(parameters.max_training_size, 1, CV_32FC1) };
 
+		// The triage rejects tiles that can't provide enough Hematoxylin and Eosin samples, before the full resolution work is performed.
+		HE_Staining::TileTriageParameters triage_parameters(HE_Staining::TileTriage::GetStandardParameters());
+		triage_parameters.min_tissue_pixels		= min_training_size / 2;
+		triage_parameters.min_nuclei			= GetMinimumEllipses_(tile_size, parameters.minimum_ellipses, spacing);
+		triage_parameters.min_nucleus_radius	= floor(1.94 / spacing[0]);
+		std::vector<size_t> triage_counts(HE_Staining::TRIAGE_RESULT_COUNT, 0);
+
+		// Each tile acquires its own random stream, keyed on its index. Which keeps the results of a tile independent of the processing order.
 		size_t selected_images_count = 0;
-		std::vector<size_t> random_numbers(Misc::Random::CreateListOfRandomIntegers(tile_coordinates.size(), Misc::MT_Singleton::GetGenerator()));
+		Misc::TileReader tile_reader(tiled_image, tile_size);
+		boost::mt19937_64 selection_generator(Misc::Random::CreateStream(parameters.seed, Misc::Random::STREAM_TILE_SELECTION));
+		std::vector<size_t> random_numbers(Misc::Random::CreateListOfRandomIntegers(tile_coordinates.size(), selection_generator));
 		for (size_t current_tile = 0; current_tile < tile_coordinates.size(); ++current_tile)
 		{
+			uint64_t tile_seed(Misc::Random::DeriveSeed(Misc::Random::DeriveSeed(parameters.seed, Misc::Random::STREAM_TILE), random_numbers[current_tile]));
+
 			logging_instance->QueueCommandLineLogging(std::to_string(current_tile + 1) + " images taken as examples!", IO::Logging::NORMAL);
-			logging_instance->QueueFileLogging("=============================\nRandom Tile " + std::to_string(random_numbers[current_tile] + 1) + "\n=============================", m_log_file_id_, IO::Logging::NORMAL);
+			logging_instance->QueueFileLogging("=============================\nRandom Tile " + std::to_string(random_numbers[current_tile] + 1) + "\n=============================", m_log_prefix_, m_log_file_id_, IO::Logging::NORMAL);
 
 			//===========================================================================
 			//	HSD / CxCy Color Model
@@ -58,20 +77,31 @@ namespace WSICS::Normalization
 			HSD::HSD_Model hsd_image;
 			if (is_multiresolution_image)
 			{
-				unsigned char* data(nullptr);
-
-				tiled_image.getRawRegion(tile_coordinates[random_numbers[current_tile]].x * tiled_image.getLevelDownsample(0),
+				tile_reader.Read(tile_coordinates[random_numbers[current_tile]].x * tiled_image.getLevelDownsample(0),
 					tile_coordinates[random_numbers[current_tile]].y * tiled_image.getLevelDownsample(0),
-					tile_size, tile_size, min_level, data);
-
-				cv::Mat raw_image = cv::Mat::zeros(tile_size, tile_size, CV_8UC3);
-				Misc::LevelReading::ArrayToMatrix(data, raw_image, false);
+					min_level);
 				if (IO::Logging::LogHandler::GetInstance()->GetOutputLevel() == IO::Logging::DEBUG && !m_debug_dir_.empty())
 				{
+					cv::Mat raw_image;
+					tile_reader.CopyBGR(raw_image);
+
 					std::string original_name(m_debug_dir_ + "/tile_" + std::to_string(random_numbers[current_tile]) + "_raw.tif");
 					cv::imwrite(original_name, raw_image);
 				}
-				hsd_image = HSD::HSD_Model(raw_image, HSD::BGR);
+
+				if (parameters.tile_triage)
+				{
+					HE_Staining::TileTriageResult triage_result(HE_Staining::TileTriage::Evaluate(tile_reader.GetRGB(), triage_parameters));
+					++triage_counts[triage_result];
+					if (triage_result != HE_Staining::TRIAGE_ACCEPTED)
+					{
+						logging_instance->QueueFileLogging("Skipped by triage - " + HE_Staining::TileTriage::GetResultName(triage_result) + ".", m_log_prefix_, m_log_file_id_, IO::Logging::NORMAL);
+						continue;
+					}
+				}
+
+				// The HSD model copies the channels out of the buffer, which allows it to be wrapped without conversion.
+				hsd_image = HSD::HSD_Model(tile_reader.GetRGB(), HSD::RGB);
 			}
 			else
 			{
@@ -90,8 +120,13 @@ namespace WSICS::Normalization
 			std::pair<HematoxylinMaskInformation, EosinMaskInformation> he_masks(Create_HE_Masks_(hsd_image,
 				background_mask,
 				random_numbers[current_tile],
+				tile_seed,
 				min_training_size,
 				parameters.minimum_ellipses,
+				parameters.convergence_trials,
+				parameters.nucleus_detection,
+				parameters.detection_downsample,
+				parameters.refine_detections,
 				parameters.hema_percentile,
 				parameters.eosin_percentile,
 				spacing,
@@ -101,6 +136,9 @@ namespace WSICS::Normalization
 				he_masks.second.full_mask.size() != cv::Size(0, 0))
 			{
 				HE_Staining::HE_Classifier he_classifier;
+				he_classifier.voxel_resolution	= parameters.knn_voxel_resolution;
+				he_classifier.agreement_samples	= logging_instance->GetOutputLevel() == IO::Logging::DEBUG ? 10000 : 0;
+				he_classifier.SetThreadPool(m_thread_pool_);
 				HE_Staining::ClassificationResults classification_results;
 				try
 				{
@@ -111,6 +149,15 @@ namespace WSICS::Normalization
 					throw std::runtime_error("Unable to classify HE stained tissue.");
 				}
 
+				logging_instance->QueueFileLogging("KNN: indexed " + std::to_string(classification_results.index_samples) + " of " + std::to_string(classification_results.train_and_class_data.train_data.rows) +
+					" samples in " + std::to_string(classification_results.index_seconds) + "s, searched " + std::to_string(classification_results.train_and_class_data.test_data.rows) +
+					" pixels in " + std::to_string(classification_results.search_seconds) + "s.", m_log_prefix_, m_log_file_id_, IO::Logging::DEBUG);
+				if (classification_results.voxel_agreement >= 0)
+				{
+					logging_instance->QueueFileLogging("KNN: classified through " + std::to_string(classification_results.voxel_count) + " occupied voxels, agreeing with exact K-NN on " +
+						std::to_string(classification_results.voxel_agreement * 100) + "% of the sampled pixels.", m_log_prefix_, m_log_file_id_, IO::Logging::DEBUG);
+				}
+
 				// Wanna keep?
 				// Randomly pick samples and Fill in Cx-Cy-D major sample vectors	
 				if (classification_results.train_and_class_data.train_data.rows >= min_training_size)
@@ -132,7 +179,8 @@ namespace WSICS::Normalization
 						cv::imwrite(m_debug_dir_ + "/tile_" + std::to_string(random_numbers[current_tile]) + "_classes.tif", classes);
 					}
 
-					InsertTrainingData_(hsd_image, classification_results, sample_information, total_hema_count, total_eosin_count, total_background_count, parameters.max_training_size);
+					boost::mt19937_64 training_generator(Misc::Random::CreateStream(tile_seed, Misc::Random::STREAM_TRAINING_SELECTION));
+					InsertTrainingData_(hsd_image, classification_results, sample_information, total_hema_count, total_eosin_count, total_background_count, parameters.max_training_size, training_generator);
 					++selected_images_count;
 
 					size_t hema_count_real = total_hema_count				> parameters.max_training_size * 9 / 20 ? hema_count_real = parameters.max_training_size * 9 / 20 : total_hema_count;
@@ -140,8 +188,8 @@ namespace WSICS::Normalization
 					size_t background_count_real = total_background_count	> parameters.max_training_size * 1 / 10 ? background_count_real = parameters.max_training_size * 1 / 10 : total_background_count;
 
 					logging_instance->QueueCommandLineLogging(std::to_string(hema_count_real + eosin_count_real + background_count_real) + " training samples are filled, out of " + std::to_string(parameters.max_training_size) + " required.", IO::Logging::NORMAL);
-					logging_instance->QueueFileLogging("Filled: " + std::to_string(hema_count_real + eosin_count_real + background_count_real) + " / " + std::to_string(parameters.max_training_size), m_log_file_id_, IO::Logging::NORMAL);
-					logging_instance->QueueFileLogging("Hema: " + std::to_string(hema_count_real) + ", Eos: " + std::to_string(eosin_count_real) + ", BG: " + std::to_string(background_count_real), m_log_file_id_, IO::Logging::NORMAL);
+					logging_instance->QueueFileLogging("Filled: " + std::to_string(hema_count_real + eosin_count_real + background_count_real) + " / " + std::to_string(parameters.max_training_size), m_log_prefix_, m_log_file_id_, IO::Logging::NORMAL);
+					logging_instance->QueueFileLogging("Hema: " + std::to_string(hema_count_real) + ", Eos: " + std::to_string(eosin_count_real) + ", BG: " + std::to_string(background_count_real), m_log_prefix_, m_log_file_id_, IO::Logging::NORMAL);
 				}
 
 				if (total_hema_count >= parameters.max_training_size * 9 / 20 && total_eosin_count >= parameters.max_training_size * 9 / 20 && total_background_count >= parameters.max_training_size / 10)
@@ -151,6 +199,24 @@ namespace WSICS::Normalization
 			}		
 		}
 
+		if (is_multiresolution_image && parameters.tile_triage)
+		{
+			size_t evaluated_tiles = 0;
+			std::string rejection_text;
+			for (size_t result = 0; result < triage_counts.size(); ++result)
+			{
+				evaluated_tiles += triage_counts[result];
+				if (result != HE_Staining::TRIAGE_ACCEPTED)
+				{
+					rejection_text += ", " + HE_Staining::TileTriage::GetResultName(static_cast<HE_Staining::TileTriageResult>(result)) + ": " + std::to_string(triage_counts[result]);
+				}
+			}
+
+			std::string log_text("Triage rejected " + std::to_string(evaluated_tiles - triage_counts[HE_Staining::TRIAGE_ACCEPTED]) + " out of " + std::to_string(evaluated_tiles) + " tiles" + rejection_text);
+			logging_instance->QueueCommandLineLogging(log_text, IO::Logging::NORMAL);
+			logging_instance->QueueFileLogging(log_text, m_log_prefix_, m_log_file_id_, IO::Logging::NORMAL);
+		}
+
 		if ((total_hema_count < parameters.max_training_size * 9 / 20 || total_eosin_count < parameters.max_training_size * 9 / 20 || total_background_count < parameters.max_training_size / 10))
 		{
 			size_t non_zero_class_pixels = cv::countNonZero(sample_information.class_data);
@@ -159,7 +225,7 @@ namespace WSICS::Normalization
 			{
 				std::string log_text("Could not fill all the " + std::to_string(parameters.max_training_size) + " samples required. Continuing with what is left...");
 				logging_instance->QueueCommandLineLogging(log_text, IO::Logging::NORMAL);
-				logging_instance->QueueFileLogging(log_text, m_log_file_id_, IO::Logging::NORMAL);
+				logging_instance->QueueFileLogging(log_text, m_log_prefix_, m_log_file_id_, IO::Logging::NORMAL);
 
 				sample_information = PatchTestData_(non_zero_class_pixels, sample_information);
 			}
@@ -172,8 +238,13 @@ namespace WSICS::Normalization
 		const HSD::HSD_Model& hsd_image,
 		const cv::Mat& background_mask,
 		const uint32_t tile_id,
+		const uint64_t tile_seed,
 		const uint32_t min_training_size,
 		const int32_t min_ellipses,
+		const uint32_t convergence_trials,
+		const HE_Staining::NucleusDetection nucleus_detection,
+		const uint32_t detection_downsample,
+		const bool refine_detections,
 		const float hema_percentile,
 		const float eosin_percentile,
 		const std::vector<double>& spacing,
@@ -185,6 +256,8 @@ namespace WSICS::Normalization
 		parameters.max_ellipse_radius = ceil(4.86 / spacing[0]);
 		parameters.epoch_size = 3;
 		parameters.count_threshold = 4;
+		parameters.convergence_trials = convergence_trials;
+		parameters.seed = Misc::Random::DeriveSeed(tile_seed, Misc::Random::STREAM_ELLIPSE_DETECTION);
 
 		int sigma			= 4;
 		int low_threshold	= 45;
@@ -207,23 +280,59 @@ namespace WSICS::Normalization
 			cv::imwrite(m_debug_dir_ + "/tile_" + std::to_string(tile_id) + "_binary.tif", temporary_matrix);
 		}
 
-		// Attempts to detect ellispes. Applies a blur and canny edge operation on the density matrix before detecting ellipses through a randomized Hough transform.
-		std::vector<HoughTransform::Ellipse> detected_ellipses(HE_Staining::MaskGeneration::DetectEllipses(hsd_image.density, sigma, low_threshold, high_threshold, parameters));
+		// When the detection is performed on a downsampled density, the parameters that are expressed in pixels are scaled to match.
+		uint32_t downsample = std::max<uint32_t>(detection_downsample, 1);
+		HoughTransform::RandomizedHoughTransformParameters coarse_parameters(parameters);
+		coarse_parameters.min_ellipse_radius			/= downsample;
+		coarse_parameters.max_ellipse_radius			/= downsample;
+		coarse_parameters.ellipse_position_threshold	/= downsample;
+		coarse_parameters.ellipse_radii_threshold		/= downsample;
+
+		HoughTransform::WindowedTripletDetectorParameters triplet_parameters(HoughTransform::WindowedTripletDetector::GetStandardParameters());
+		triplet_parameters.min_point_distance		/= downsample;
+		triplet_parameters.max_point_distance		/= downsample;
+		triplet_parameters.tangent_search_radius	/= downsample;
+		triplet_parameters.window_size				/= downsample;
+
+		int coarse_sigma = std::max(sigma / static_cast<int>(downsample), 1);
+
+		// Attempts to detect ellispes, either through a randomized Hough transform on the edges of the blurred density or by fitting them onto its thresholded contours.
+		std::unique_ptr<HE_Staining::INucleusDetector> nucleus_detector;
+		if (nucleus_detection == HE_Staining::NUCLEUS_DETECTION_CONTOUR)
+		{
+			nucleus_detector.reset(new HE_Staining::ContourNucleusDetector(coarse_sigma, coarse_parameters.min_ellipse_radius, coarse_parameters.max_ellipse_radius));
+		}
+		else
+		{
+			nucleus_detector.reset(new HE_Staining::HoughNucleusDetector(coarse_sigma, low_threshold, high_threshold, coarse_parameters, triplet_parameters, m_thread_pool_));
+		}
+		if (downsample > 1)
+		{
+			nucleus_detector.reset(new HE_Staining::MultiScaleNucleusDetector(std::move(nucleus_detector),
+				downsample,
+				refine_detections,
+				sigma,
+				low_threshold,
+				high_threshold,
+				parameters.min_ellipse_radius,
+				parameters.max_ellipse_radius));
+		}
+		std::vector<HoughTransform::Ellipse> detected_ellipses(nucleus_detector->Detect(hsd_image.density));
 
 		logging_instance->QueueCommandLineLogging("Number of ellipses is: " + std::to_string(detected_ellipses.size()), IO::Logging::NORMAL);
 
 		std::pair<HE_Staining::HematoxylinMaskInformation, HE_Staining::EosinMaskInformation> mask_acquisition_results;
 
 		// If the min_ellipses variable has been set as positive, prefer it over a calculation.
-		double min_detected_ellipses = min_ellipses == 0 ? hsd_image.red_density.rows * hsd_image.red_density.rows * spacing[0] * spacing[0] * (150 / 247700.0) : min_ellipses;
+		double min_detected_ellipses = GetMinimumEllipses_(hsd_image.red_density.rows, min_ellipses, spacing);
 		if (detected_ellipses.size() > min_detected_ellipses || (detected_ellipses.size() > 10 && !is_multiresolution))
 		{
-			logging_instance->QueueFileLogging("Passed step 1: Number of nuclei " + std::to_string(detected_ellipses.size()), m_log_file_id_, IO::Logging::NORMAL);
+			logging_instance->QueueFileLogging("Passed step 1: Number of nuclei " + std::to_string(detected_ellipses.size()), m_log_prefix_, m_log_file_id_, IO::Logging::NORMAL);
 
 			std::pair<bool, HE_Staining::HematoxylinMaskInformation> hema_mask_acquisition_result;
 			if (!(hema_mask_acquisition_result = HE_Staining::MaskGeneration::GenerateHematoxylinMasks(hsd_image, background_mask, detected_ellipses, hema_percentile)).first || !m_consider_ink_)
 			{
-				logging_instance->QueueFileLogging("Skipped - May contain INK.", m_log_file_id_, IO::Logging::NORMAL);
+				logging_instance->QueueFileLogging("Skipped - May contain INK.", m_log_prefix_, m_log_file_id_, IO::Logging::NORMAL);
 			}
 
 			// Creates a reference of the hema mask information, for ease of use. And copies the results into the result pairing.
@@ -235,16 +344,19 @@ namespace WSICS::Normalization
 			{
 				logging_instance->QueueFileLogging(
 					"Passed step 2: Amount of Hema samples " + std::to_string(hema_mask_info.training_pixels) + ", more than the threshold of " + std::to_string(min_training_size / 2),
+					m_log_prefix_,
 					m_log_file_id_,
 					IO::Logging::NORMAL);
 
-				HE_Staining::EosinMaskInformation eosin_mask_info(HE_Staining::MaskGeneration::GenerateEosinMasks(hsd_image, background_mask, hema_mask_info, eosin_percentile));
+				boost::mt19937_64 eosin_generator(Misc::Random::CreateStream(tile_seed, Misc::Random::STREAM_EOSIN_SELECTION));
+				HE_Staining::EosinMaskInformation eosin_mask_info(HE_Staining::MaskGeneration::GenerateEosinMasks(hsd_image, background_mask, hema_mask_info, eosin_generator, eosin_percentile));
 				if (eosin_mask_info.training_pixels > min_training_size / 2)
 				{
 					mask_acquisition_results.second = eosin_mask_info;
 
 					IO::Logging::LogHandler::GetInstance()->QueueFileLogging(
 						"Passed step 3: Amount of Eosin samples " + std::to_string(eosin_mask_info.training_pixels) + ", more than the threshold of " + std::to_string(min_training_size / 2),
+						m_log_prefix_,
 						m_log_file_id_,
 						IO::Logging::NORMAL);
 				}
@@ -266,7 +378,7 @@ namespace WSICS::Normalization
 		if (!failure_log_message.empty())
 		{
 			logging_instance->QueueCommandLineLogging(failure_log_message, IO::Logging::NORMAL);
-			logging_instance->QueueFileLogging(failure_log_message, m_log_file_id_, IO::Logging::NORMAL);
+			logging_instance->QueueFileLogging(failure_log_message, m_log_prefix_, m_log_file_id_, IO::Logging::NORMAL);
 		}
 
 		return mask_acquisition_results;
@@ -279,12 +391,13 @@ namespace WSICS::Normalization
 		size_t& total_hema_count,
 		size_t& total_eosin_count,
 		size_t& total_background_count,
-		const uint32_t max_training_size)
+		const uint32_t max_training_size,
+		boost::mt19937_64& generator)
 	{
 		// Creates a list of random values, ranging from 0 to the amount of class pixels - 1.
-		std::vector<size_t> hema_random_numbers(Misc::Random::CreateListOfRandomIntegers(classification_results.hema_pixels, Misc::MT_Singleton::GetGenerator()));
-		std::vector<size_t> eosin_random_numbers(Misc::Random::CreateListOfRandomIntegers(classification_results.eosin_pixels, Misc::MT_Singleton::GetGenerator()));
-		std::vector<size_t> background_random_numbers(Misc::Random::CreateListOfRandomIntegers(classification_results.background_pixels, Misc::MT_Singleton::GetGenerator()));
+		std::vector<size_t> hema_random_numbers(Misc::Random::CreateListOfRandomIntegers(classification_results.hema_pixels, generator));
+		std::vector<size_t> eosin_random_numbers(Misc::Random::CreateListOfRandomIntegers(classification_results.eosin_pixels, generator));
+		std::vector<size_t> background_random_numbers(Misc::Random::CreateListOfRandomIntegers(classification_results.background_pixels, generator));
 
 		// Tracks the amount of class specific sample counts. And the matrices which will hold information for each pixel classified as their own.
 		size_t local_hema_count = 0;
@@ -367,6 +480,11 @@ namespace WSICS::Normalization
 		return sample_information;
 	}
 
+	double PixelClassificationHE::GetMinimumEllipses_(const uint32_t tile_size, const int32_t min_ellipses, const std::vector<double>& spacing) const
+	{
+		return min_ellipses == 0 ? tile_size * tile_size * spacing[0] * spacing[0] * (150 / 247700.0) : min_ellipses;
+	}
+
 	TrainingSampleInformation PixelClassificationHE::PatchTestData_(const size_t non_zero_count, const TrainingSampleInformation& current_sample_information)
 	{
 		TrainingSampleInformation new_sample_information{ cv::Mat::zeros(non_zero_count, 2, CV_32FC1), cv::Mat::zeros(non_zero_count, 1, CV_32FC1),	cv::Mat::zeros(non_zero_count, 1, CV_32FC1) };
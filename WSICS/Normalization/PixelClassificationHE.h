@@ -1,6 +1,7 @@
 #ifndef __WSICS_NORMALIZATION_PIXELCLASSIFICATIONHE__
 #define __WSICS_NORMALIZATION_PIXELCLASSIFICATIONHE__
 
+#include <boost/random/mersenne_twister.hpp>
 #include <multiresolutionimageinterface/MultiResolutionImage.h>
 #include <opencv2/core/core.hpp>
 
@@ -26,7 +27,7 @@ namespace WSICS::Normalization
 	class PixelClassificationHE
 	{
 		public:
-			PixelClassificationHE(bool consider_ink, size_t log_file_id, std::string debug_dir);
+			PixelClassificationHE(bool consider_ink, size_t log_file_id, std::string log_prefix, std::string debug_dir, Misc::ThreadPool* thread_pool);
 
 			TrainingSampleInformation GenerateCxCyDSamples(
 				MultiResolutionImage& tiled_image,
@@ -41,14 +42,21 @@ namespace WSICS::Normalization
 		private:
 			bool		m_consider_ink_;
 			size_t		m_log_file_id_;
+			std::string m_log_prefix_;
 			std::string m_debug_dir_;
+			Misc::ThreadPool*	m_thread_pool_;
 
 			std::pair<HematoxylinMaskInformation, EosinMaskInformation> Create_HE_Masks_(
 				const HSD::HSD_Model& hsd_image,
 				const cv::Mat& background_mask,
 				const uint32_t tile_id,
+				const uint64_t tile_seed,
 				const uint32_t max_training_size,
 				const int32_t min_ellipses,
+				const uint32_t convergence_trials,
+				const HE_Staining::NucleusDetection nucleus_detection,
+				const uint32_t detection_downsample,
+				const bool refine_detections,
 				const float hema_percentile,
 				const float eosin_percentile,
 				const std::vector<double>& spacing,
@@ -65,7 +73,17 @@ namespace WSICS::Normalization
 				size_t& total_hema_count,
 				size_t& total_eosin_count,
 				size_t& total_background_count,
-				const uint32_t max_training_size);
+				const uint32_t max_training_size,
+				boost::mt19937_64& generator);
+
+			/// <summary>
+			/// Returns the amount of ellipses a tile requires, which is derived from the tile surface unless set explicitly.
+			/// </summary>
+			/// <param name="tile_size">The width and height of the tile.</param>
+			/// <param name="min_ellipses">The configured minimum, where zero requests the derived amount.</param>
+			/// <param name="spacing">The spacing of the tile.</param>
+			/// <returns>The minimum amount of ellipses.</returns>
+			double GetMinimumEllipses_(const uint32_t tile_size, const int32_t min_ellipses, const std::vector<double>& spacing) const;
 
 			TrainingSampleInformation PatchTestData_(const size_t non_zero_count, const TrainingSampleInformation& current_sample_information);
 	};
@@ -3,12 +3,16 @@
 #include <multiresolutionimageinterface/MultiResolutionImageReader.h>
 #include <multiresolutionimageinterface/MultiResolutionImageFactory.h>
 #include <boost/filesystem.hpp>
+#include <chrono>
+#include <memory>
 #include <stdexcept>
 #include <core/filetools.h>
 
+#include "BatchManifest.h"
 #include "CxCyWeights.h"
 #include "NormalizedLutCreation.h"
 #include "NormalizedOutput.h"
+#include "WriteJournal.h"
 #include "../HSD/BackgroundMask.h"
 #include "../HSD/Transformations.h"
 #include "../IO/Logging/LogHandler.h"
@@ -20,23 +24,65 @@
 namespace WSICS::Normalization
 {
 	WSICS_Algorithm::WSICS_Algorithm(std::string log_directory, const boost::filesystem::path& template_file)
-		: m_log_file_id_(0), m_template_file_(template_file), m_debug_directory_(), m_parameters_(GetStandardParameters()), m_is_multiresolution_image_(false)
+		: m_log_file_id_(0), m_template_file_(template_file), m_parameters_(GetStandardParameters()), m_thread_pool_(nullptr)
 	{
 		this->SetLogDirectory(log_directory);
 	}
 
 	WSICS_Algorithm::WSICS_Algorithm(std::string log_directory, const boost::filesystem::path& template_file, const WSICS_Parameters& parameters)
-		: m_log_file_id_(0), m_template_file_(template_file), m_debug_directory_(), m_parameters_(parameters), m_is_multiresolution_image_(false)
+		: m_log_file_id_(0), m_template_file_(template_file), m_parameters_(parameters), m_thread_pool_(nullptr)
 	{
 		this->SetLogDirectory(log_directory);
 	}
 
 	WSICS_Parameters WSICS_Algorithm::GetStandardParameters(void)
 	{
-		return { -1, 200000, 20000000, 2000, 0.1f, 0.2f, 0.9f, false };
+		return { -1, 200000, 20000000, 2000, 0.1f, 0.2f, 0.9f, false, 0, HE_Staining::NUCLEUS_DETECTION_HOUGH, 1, false, 0, true };
 	}
 
-	void WSICS_Algorithm::Normalize(
+	uint64_t WSICS_Algorithm::EstimatePeakMemory(const boost::filesystem::path& input_file, const WSICS_Parameters& parameters)
+	{
+		// The LUT normalization holds roughly fourteen floats per LUT entry, the training stage holds
+		// several copies of the cx, cy, density and class values per sample.
+		const uint64_t lut_entries = 256 * 256 * 256;
+		uint64_t peak_memory = lut_entries * 14 * sizeof(float) + static_cast<uint64_t>(parameters.max_training_size) * 4 * sizeof(float) * 3;
+
+		MultiResolutionImageReader reader;
+		std::unique_ptr<MultiResolutionImage> tiled_image(reader.open(input_file.string()));
+		if (!tiled_image)
+		{
+			// Normalize reports the unreadable file, which leaves only the stages that don't depend on the slide.
+			return peak_memory;
+		}
+
+		// A HSD model holds six float channels, next to the RGB values and several byte masks.
+		const uint64_t bytes_per_pixel = 3 + 6 * sizeof(float) + 4;
+		const std::vector<unsigned long long> dimensions(tiled_image->getLevelDimensions(0));
+		if (tiled_image->getNumberOfLevels() > 1)
+		{
+			// The training tiles are processed one at a time, while the tissue index integrates a mask of the lowest resolution level.
+			const uint64_t training_tile_size = 2048;
+			const std::vector<unsigned long long> index_dimensions(tiled_image->getLevelDimensions(tiled_image->getNumberOfLevels() - 1));
+			peak_memory += training_tile_size * training_tile_size * bytes_per_pixel;
+			peak_memory += index_dimensions[0] * index_dimensions[1] * (sizeof(uint8_t) + sizeof(int32_t));
+
+			// Each tissue tile holds its coordinates and a selection index, while the writer buffers and spools a full row of tiles.
+			const uint64_t tile_size = 512;
+			const uint64_t x_amount_of_tiles = (dimensions[0] + tile_size - 1) / tile_size;
+			const uint64_t y_amount_of_tiles = (dimensions[1] + tile_size - 1) / tile_size;
+			peak_memory += x_amount_of_tiles * y_amount_of_tiles * (sizeof(cv::Point) + sizeof(size_t));
+			peak_memory += x_amount_of_tiles * tile_size * tile_size * 3 * 2;
+		}
+		else
+		{
+			// Static images are converted as a whole, and normalized into a second copy.
+			peak_memory += dimensions[0] * dimensions[1] * (bytes_per_pixel + 3);
+		}
+
+		return peak_memory;
+	}
+
+	std::vector<StageTiming> WSICS_Algorithm::Normalize(
 		const boost::filesystem::path& input_file,
 		const boost::filesystem::path& image_output_file,
 		const boost::filesystem::path& lut_output_file,
@@ -48,15 +94,27 @@ namespace WSICS::Normalization
 		//===========================================================================
 
 		IO::Logging::LogHandler* logging_instance(IO::Logging::LogHandler::GetInstance());
-		m_debug_directory_ = debug_directory;
+
+		// Slides may be normalized concurrently, which requires each line of the shared log to identify its slide.
+		const std::string log_prefix("[" + input_file.stem().string() + "] ");
+
+		// Records the duration of each stage, starting the next stage once the current is finished.
+		std::vector<StageTiming> stage_timings;
+		std::chrono::steady_clock::time_point stage_start(std::chrono::steady_clock::now());
+		auto finish_stage = [&stage_timings, &stage_start](const std::string stage)
+		{
+			std::chrono::steady_clock::time_point stage_end(std::chrono::steady_clock::now());
+			stage_timings.push_back({ stage, std::chrono::duration<double>(stage_end - stage_start).count() });
+			stage_start = stage_end;
+		};
 
 		//===========================================================================
 		//	Reading the image:: Identifying the tiles containing tissue using multiple magnifications
 		//===========================================================================
-		logging_instance->QueueFileLogging("=============================\n\nReading image...", m_log_file_id_, IO::Logging::NORMAL);
+		logging_instance->QueueFileLogging("=============================\n\nReading image...", log_prefix, m_log_file_id_, IO::Logging::NORMAL);
 
 		MultiResolutionImageReader reader;
-		MultiResolutionImage* tiled_image = reader.open(input_file.string());
+		std::unique_ptr<MultiResolutionImage> tiled_image(reader.open(input_file.string()));
 
 		if (!tiled_image)
 		{
@@ -73,12 +131,13 @@ namespace WSICS::Normalization
 		// Acquires the type of image, the spacing and the minimum level to select tiles from.
 		std::vector<double> spacing;
 		uint32_t min_level = 0;
+		bool is_multiresolution_image = false;
 
 		// Scopes the pair so that it can be moved into more clearly defined variables.
 		{
-			std::pair<bool, std::vector<double>> resolution_and_spacing(GetResolutionTypeAndSpacing(*tiled_image));
+			std::pair<bool, std::vector<double>> resolution_and_spacing(GetResolutionTypeAndSpacing(*tiled_image, log_prefix));
 
-			m_is_multiresolution_image_ = resolution_and_spacing.first;
+			is_multiresolution_image = resolution_and_spacing.first;
 			spacing.swap(resolution_and_spacing.second);
 		}
 
@@ -88,14 +147,38 @@ namespace WSICS::Normalization
 			min_level = 1;
 		}
 
-		logging_instance->QueueFileLogging("Pixel spacing = " + std::to_string(spacing[0]), m_log_file_id_, IO::Logging::NORMAL);
+		logging_instance->QueueFileLogging("Pixel spacing = " + std::to_string(spacing[0]), log_prefix, m_log_file_id_, IO::Logging::NORMAL);
 
 		uint32_t tile_size = 512;
+
+		// Continues an interrupted write of the normalized WSI, reusing the persisted LUT.
+		WriteJournal journal(image_output_file);
+		std::string parameter_description;
+		uint64_t input_hash = 0;
+		if (!image_output_file.empty() && is_multiresolution_image)
+		{
+			parameter_description	= BatchManifest::DescribeParameters(m_parameters_, m_template_file_);
+			input_hash				= BatchManifest::HashFile(input_file);
+
+			cv::Mat normalized_lut;
+			if (journal.Load(input_hash, parameter_description, tile_size) && !(normalized_lut = journal.LoadLUT()).empty())
+			{
+				logging_instance->QueueFileLogging("Continuing the interrupted write of: " + image_output_file.string(), log_prefix, m_log_file_id_, IO::Logging::NORMAL);
+				logging_instance->QueueCommandLineLogging("Continuing the interrupted write of: " + image_output_file.string(), IO::Logging::NORMAL);
+
+				// Closes the image, which the writer reopens.
+				tiled_image.reset();
+				WriteNormalizedWSI(input_file, image_output_file, normalized_lut, tile_size, journal);
+				finish_stage("image_writing");
+				return stage_timings;
+			}
+		}
+
 		cv::Mat static_image;
 		std::vector<cv::Point> tile_coordinates;
-		if (m_is_multiresolution_image_)
+		if (is_multiresolution_image)
 		{
-			tile_coordinates = std::move(GetTileCoordinates_(*tiled_image, spacing, tile_size, min_level));
+			tile_coordinates = std::move(GetTileCoordinates_(input_file, *tiled_image, spacing, tile_size, min_level, log_prefix));
 		}
 		else
 		{
@@ -108,32 +191,34 @@ namespace WSICS::Normalization
 		{
 			throw std::runtime_error("Unable to acquire tiles with tissue. (Try changing the background threshold parameter)");
 		}
+		finish_stage("tissue_detection");
 
-		TrainingSampleInformation training_samples(CollectTrainingSamples_(input_file, tile_size, *tiled_image, static_image, tile_coordinates, spacing, min_level));
+		TrainingSampleInformation training_samples(CollectTrainingSamples_(input_file, tile_size, *tiled_image, static_image, tile_coordinates, spacing, min_level, debug_directory, is_multiresolution_image, log_prefix));
 
 		logging_instance->QueueCommandLineLogging("sampling done!", IO::Logging::NORMAL);
-		logging_instance->QueueFileLogging("=============================\nSampling done!", m_log_file_id_, IO::Logging::NORMAL);
+		logging_instance->QueueFileLogging("=============================\nSampling done!", log_prefix, m_log_file_id_, IO::Logging::NORMAL);
+		finish_stage("training_sampling");
 
 		//===========================================================================
 		//	Generating LUT Raw Matrix
 		//===========================================================================
-		logging_instance->QueueFileLogging("Defining LUT\nLUT HSD", m_log_file_id_, IO::Logging::NORMAL);
+		logging_instance->QueueFileLogging("Defining LUT\nLUT HSD", log_prefix, m_log_file_id_, IO::Logging::NORMAL);
 
-		HSD::HSD_Model lut_hsd(CalculateLutRawMat_(), HSD::BGR);
-
-		logging_instance->QueueFileLogging("LUT BG calculation", m_log_file_id_, IO::Logging::NORMAL);
-		cv::Mat background_mask(HSD::BackgroundMask::CreateBackgroundMask(lut_hsd, 0.24, 0.22));
+		std::shared_ptr<const HSD::HSD_Model> lut_hsd_pointer(AcquireLutHSD_());
+		const HSD::HSD_Model& lut_hsd(*lut_hsd_pointer);
 
 		//===========================================================================
 		//	Normalizes the LUT.
 		//===========================================================================
-		cv::Mat normalized_lut(NormalizedLutCreation::Create(!image_output_file.empty() || !lut_output_file.empty(), m_template_file_, template_output_file, lut_hsd, training_samples, m_parameters_.max_training_size, m_log_file_id_));
+		cv::Mat normalized_lut(NormalizedLutCreation::Create(!image_output_file.empty() || !lut_output_file.empty(), m_template_file_, template_output_file, lut_hsd, training_samples, m_parameters_.max_training_size, log_prefix, m_log_file_id_));
+		finish_stage("lut_creation");
 
 		if (!lut_output_file.empty())
 		{
-			logging_instance->QueueFileLogging("Writing LUT to: " + lut_output_file.string() + " (this might take some time).", m_log_file_id_, IO::Logging::NORMAL);
+			logging_instance->QueueFileLogging("Writing LUT to: " + lut_output_file.string() + " (this might take some time).", log_prefix, m_log_file_id_, IO::Logging::NORMAL);
 			logging_instance->QueueCommandLineLogging("Writing LUT to: " + lut_output_file.string() + " (this might take some time).", IO::Logging::NORMAL);
 			cv::imwrite(lut_output_file.string(), normalized_lut);
+			finish_stage("lut_writing");
 		}
 
 		//===========================================================================
@@ -141,45 +226,44 @@ namespace WSICS::Normalization
 		//===========================================================================
 		if (!image_output_file.empty())
 		{
-			logging_instance->QueueFileLogging("Writing the standardized WSI in progress...", m_log_file_id_, IO::Logging::NORMAL);
+			logging_instance->QueueFileLogging("Writing the standardized WSI in progress...", log_prefix, m_log_file_id_, IO::Logging::NORMAL);
 			logging_instance->QueueCommandLineLogging("Writing the standardized WSI in progress...", IO::Logging::NORMAL);
 
-			if (m_is_multiresolution_image_)
+			if (is_multiresolution_image)
 			{
-				WriteNormalizedWSI(input_file, image_output_file, normalized_lut, tile_size);
+				journal.Start(input_hash, parameter_description, tile_size, normalized_lut);
+				WriteNormalizedWSI(input_file, image_output_file, normalized_lut, tile_size, journal);
 			}
 			else
 			{
 				WriteNormalizedWSI(static_image, image_output_file, normalized_lut);
 			}
-			logging_instance->QueueFileLogging("Finished writing the image.", m_log_file_id_, IO::Logging::NORMAL);
+			logging_instance->QueueFileLogging("Finished writing the image.", log_prefix, m_log_file_id_, IO::Logging::NORMAL);
 			logging_instance->QueueCommandLineLogging("Finished writing the image.", IO::Logging::NORMAL);
+			finish_stage("image_writing");
 		}
 
 		//===========================================================================
 		//	Write sample images to Harddisk For testing
 		//===========================================================================
 		// Don't remove! usable for looking at samples of standardization
-		if (logging_instance->GetOutputLevel() == IO::Logging::DEBUG && !m_debug_directory_.empty() && normalized_lut.size() != cv::Size(0, 0))
+		if (logging_instance->GetOutputLevel() == IO::Logging::DEBUG && !debug_directory.empty() && normalized_lut.size() != cv::Size(0, 0))
 		{
-			logging_instance->QueueFileLogging("Writing sample standardized images to: " + m_debug_directory_.string(), m_log_file_id_, IO::Logging::NORMAL);
+			logging_instance->QueueFileLogging("Writing sample standardized images to: " + debug_directory.string(), log_prefix, m_log_file_id_, IO::Logging::NORMAL);
 
-			if (m_is_multiresolution_image_)
+			if (is_multiresolution_image)
 			{
-				WriteNormalizedSamples(boost::filesystem::path(m_debug_directory_.string()), normalized_lut, *tiled_image, tile_coordinates, tile_size);
+				WriteNormalizedSamples(boost::filesystem::path(debug_directory.string()), normalized_lut, *tiled_image, tile_coordinates, tile_size, m_parameters_.seed);
 			}
 			else
 			{
-				boost::filesystem::path output_filepath(m_debug_directory_.string() + "/" + input_file.stem().string() + ".tif");
+				boost::filesystem::path output_filepath(debug_directory.string() + "/" + input_file.stem().string() + ".tif");
 				WriteNormalizedSample(output_filepath.string(), normalized_lut, static_image, tile_size);
 			}
+			finish_stage("debug_samples");
 		}
 
-		//===========================================================================
-		//	Cleans execution variables
-		//===========================================================================
-		m_debug_directory_ = "";
-		delete tiled_image;
+		return stage_timings;
 	}
 
 	void WSICS_Algorithm::SetLogDirectory(std::string& filepath)
@@ -195,6 +279,27 @@ namespace WSICS::Normalization
 		m_log_file_id_ = logging_instance->OpenFile(filepath, false);
 	}
 
+	size_t WSICS_Algorithm::GetLogFileId(void) const
+	{
+		return m_log_file_id_;
+	}
+
+	void WSICS_Algorithm::SetThreadPool(Misc::ThreadPool* thread_pool)
+	{
+		m_thread_pool_ = thread_pool;
+	}
+
+	std::shared_ptr<const HSD::HSD_Model> WSICS_Algorithm::AcquireLutHSD_(void)
+	{
+		// Concurrent calls wait for the first one to finish the model, rather than creating their own.
+		std::lock_guard<std::mutex> lock(m_lut_access_);
+		if (!m_lut_hsd_)
+		{
+			m_lut_hsd_ = std::make_shared<const HSD::HSD_Model>(CalculateLutRawMat_(), HSD::BGR);
+		}
+		return m_lut_hsd_;
+	}
+
 	cv::Mat WSICS_Algorithm::CalculateLutRawMat_(void)
 	{
 		cv::Mat raw_lut(cv::Mat::zeros(256 * 256 * 256, 1, CV_8UC3));//16387064
@@ -220,7 +325,10 @@ namespace WSICS::Normalization
 		cv::Mat static_image,
 		const std::vector<cv::Point>& tile_coordinates,
 		const std::vector<double>& spacing,
-		const uint32_t min_level)
+		const uint32_t min_level,
+		const boost::filesystem::path& debug_directory,
+		const bool is_multiresolution_image,
+		const std::string& log_prefix)
 	{
 		IO::Logging::LogHandler* logging_instance(IO::Logging::LogHandler::GetInstance());
 
@@ -229,9 +337,9 @@ namespace WSICS::Normalization
 		//===========================================================================
 		std::string log_text = "Number of available tiles for stain sampling: " + std::to_string(tile_coordinates.size());
 		logging_instance->QueueCommandLineLogging(log_text, IO::Logging::NORMAL);
-		logging_instance->QueueFileLogging(log_text, m_log_file_id_, IO::Logging::NORMAL);
+		logging_instance->QueueFileLogging(log_text, log_prefix, m_log_file_id_, IO::Logging::NORMAL);
 
-		PixelClassificationHE pixel_classification_he(m_parameters_.consider_ink, m_log_file_id_, m_debug_directory_.string());
+		PixelClassificationHE pixel_classification_he(m_parameters_.consider_ink, m_log_file_id_, log_prefix, debug_directory.string(), m_thread_pool_);
 		tile_size = 2048;
 
 		return pixel_classification_he.GenerateCxCyDSamples(
@@ -242,10 +350,10 @@ namespace WSICS::Normalization
 			spacing,
 			tile_size,
 			min_level,
-			m_is_multiresolution_image_);
+			is_multiresolution_image);
 	}
 
-	std::pair<bool, std::vector<double>> WSICS_Algorithm::GetResolutionTypeAndSpacing(MultiResolutionImage& tiled_image)
+	std::pair<bool, std::vector<double>> WSICS_Algorithm::GetResolutionTypeAndSpacing(MultiResolutionImage& tiled_image, const std::string& log_prefix)
 	{
 		IO::Logging::LogHandler* logging_instance(IO::Logging::LogHandler::GetInstance());
 		std::pair<bool, std::vector<double>> resolution_and_spacing((tiled_image.getNumberOfLevels() > 1), tiled_image.getSpacing());
@@ -255,11 +363,11 @@ namespace WSICS::Normalization
 			if (resolution_and_spacing.second[0] > 1)
 			{
 				resolution_and_spacing.second.clear();
-				logging_instance->QueueFileLogging("Image is static", m_log_file_id_, IO::Logging::NORMAL);
+				logging_instance->QueueFileLogging("Image is static", log_prefix, m_log_file_id_, IO::Logging::NORMAL);
 			}
 			else
 			{
-				logging_instance->QueueFileLogging("Image is multi-resolution", m_log_file_id_, IO::Logging::NORMAL);
+				logging_instance->QueueFileLogging("Image is multi-resolution", log_prefix, m_log_file_id_, IO::Logging::NORMAL);
 			}
 		}
 
@@ -267,13 +375,41 @@ namespace WSICS::Normalization
 		{
 			logging_instance->QueueCommandLineLogging("The image does not have spacing information. Continuing with the default 0.24.", IO::Logging::NORMAL);
 			resolution_and_spacing.second.push_back(0.243);
-			logging_instance->QueueFileLogging("The image does not have spacing information. Continuing with the default 0.24. Pixel spacing set to default = " + std::to_string(resolution_and_spacing.second[0]), m_log_file_id_, IO::Logging::NORMAL);
+			logging_instance->QueueFileLogging("The image does not have spacing information. Continuing with the default 0.24. Pixel spacing set to default = " + std::to_string(resolution_and_spacing.second[0]), log_prefix, m_log_file_id_, IO::Logging::NORMAL);
 		}
 
 		return resolution_and_spacing;
 	}
 
-	std::vector<cv::Point> WSICS_Algorithm::GetTileCoordinates_(MultiResolutionImage& tiled_image, const std::vector<double>& spacing, const uint32_t tile_size, const uint32_t min_level)
+	Misc::TissueIndex WSICS_Algorithm::AcquireTissueIndex_(const boost::filesystem::path& input_file, MultiResolutionImage& tiled_image, const uint32_t level, const std::string& log_prefix)
+	{
+		IO::Logging::LogHandler* logging_instance(IO::Logging::LogHandler::GetInstance());
+
+		Misc::TissueIndex tissue_index;
+		boost::filesystem::path index_file(Misc::TissueIndex::GetIndexPath(input_file));
+		if (tissue_index.Load(index_file, input_file, level))
+		{
+			logging_instance->QueueFileLogging("Loaded the tissue index from: " + index_file.string(), log_prefix, m_log_file_id_, IO::Logging::NORMAL);
+			return tissue_index;
+		}
+
+		tissue_index.Build(tiled_image, level);
+
+		// The slide might reside within a read-only location, in which case the index is rebuilt on each run.
+		try
+		{
+			tissue_index.Save(index_file, input_file);
+			logging_instance->QueueFileLogging("Stored the tissue index at: " + index_file.string(), log_prefix, m_log_file_id_, IO::Logging::NORMAL);
+		}
+		catch (const std::exception& e)
+		{
+			logging_instance->QueueFileLogging("Unable to store the tissue index: " + std::string(e.what()), log_prefix, m_log_file_id_, IO::Logging::NORMAL);
+		}
+
+		return tissue_index;
+	}
+
+	std::vector<cv::Point> WSICS_Algorithm::GetTileCoordinates_(const boost::filesystem::path& input_file, MultiResolutionImage& tiled_image, const std::vector<double>& spacing, const uint32_t tile_size, const uint32_t min_level, const std::string& log_prefix)
 	{
 		IO::Logging::LogHandler* logging_instance(IO::Logging::LogHandler::GetInstance());
 
@@ -283,9 +419,9 @@ namespace WSICS::Normalization
 			number_of_levels = 5;
 		}
 
-		logging_instance->QueueFileLogging("Number of levels available = " + std::to_string(number_of_levels), m_log_file_id_, IO::Logging::NORMAL);
+		logging_instance->QueueFileLogging("Number of levels available = " + std::to_string(number_of_levels), log_prefix, m_log_file_id_, IO::Logging::NORMAL);
 		logging_instance->QueueCommandLineLogging("detecting tissue regions...", IO::Logging::NORMAL);
-		logging_instance->QueueFileLogging("Detecting tissue", m_log_file_id_, IO::Logging::NORMAL);
+		logging_instance->QueueFileLogging("Detecting tissue", log_prefix, m_log_file_id_, IO::Logging::NORMAL);
 
 		// Attempts to acquire the tile coordinates for the lowest level / highest magnification.
 		const std::vector<unsigned long long> dimensions = tiled_image.getLevelDimensions(number_of_levels - 1);
@@ -293,6 +429,17 @@ namespace WSICS::Normalization
 		float background_tissue_threshold = m_parameters_.background_threshold;
 		uint32_t level_scale_difference = 1;
 
+		// Logs the duration of each level, restarting the timer afterwards.
+		std::chrono::steady_clock::time_point level_start(std::chrono::steady_clock::now());
+		auto log_level_timing = [this, logging_instance, &level_start](const int32_t level, const size_t tile_count)
+		{
+			std::chrono::steady_clock::time_point level_end(std::chrono::steady_clock::now());
+			std::string log_text = "Level " + std::to_string(level) + " analyzed in " + std::to_string(std::chrono::duration<double>(level_end - level_start).count()) + "s, tiles containing tissue: " + std::to_string(tile_count);
+			logging_instance->QueueCommandLineLogging(log_text, IO::Logging::NORMAL);
+			logging_instance->QueueFileLogging(log_text, log_prefix, m_log_file_id_, IO::Logging::NORMAL);
+			level_start = level_end;
+		};
+
 		std::vector<cv::Point> tile_coordinates;
 		if (number_of_levels > 1)
 		{
@@ -301,8 +448,13 @@ namespace WSICS::Normalization
 			const std::vector<unsigned long long> next_level_dimensions = tiled_image.getLevelDimensions(number_of_levels - 2);
 			level_scale_difference = std::pow(std::round(next_level_dimensions[0] / next_level_dimensions[0]), 2);
 
+			// Indexes the tissue of the lowest magnification in a single pass, which answers the first level and
+			// discards glass on the higher magnifications before it's read.
+			Misc::TissueIndex tissue_index(AcquireTissueIndex_(input_file, tiled_image, number_of_levels - 1, log_prefix));
+
 			// Loops through each level, acquiring coordinates for each and reusing them to calculate the set of coordinates for a higher magnification.
-			tile_coordinates = std::move(Misc::LevelReading::ReadLevelTiles(tiled_image, dimensions[0], dimensions[1], tile_size, number_of_levels - 1, skip_factor, background_tissue_threshold));
+			tile_coordinates = std::move(Misc::LevelReading::SelectIndexedTiles(tissue_index, dimensions[0], dimensions[1], tile_size, skip_factor, background_tissue_threshold));
+			log_level_timing(number_of_levels - 1, tile_coordinates.size());
 			for (char level_number = number_of_levels - 2; level_number >= 0; --level_number)
 			{
 				if (level_number != 0)
@@ -316,15 +468,17 @@ namespace WSICS::Normalization
 
 				std::string log_text = "Analyzing level: " + std::to_string(level_number) + " - Tiles containing tissue: " + std::to_string(tile_coordinates.size());
 				logging_instance->QueueCommandLineLogging(log_text, IO::Logging::NORMAL);
-				logging_instance->QueueFileLogging(log_text, m_log_file_id_, IO::Logging::NORMAL);
+				logging_instance->QueueFileLogging(log_text, log_prefix, m_log_file_id_, IO::Logging::NORMAL);
 
 				background_tissue_threshold -= 0.1;
-				tile_coordinates = std::move(Misc::LevelReading::ReadLevelTiles(tiled_image, tile_coordinates, tile_size, level_number, skip_factor, level_scale_difference, background_tissue_threshold));
+				tile_coordinates = std::move(Misc::LevelReading::ReadLevelTiles(tiled_image, tile_coordinates, tile_size, level_number, skip_factor, level_scale_difference, background_tissue_threshold, input_file, m_thread_pool_, &tissue_index));
+				log_level_timing(level_number, tile_coordinates.size());
 			}
 		}
 		else
 		{
-			tile_coordinates = std::move(Misc::LevelReading::ReadLevelTiles(tiled_image, dimensions[0], dimensions[1], tile_size, number_of_levels - 1, 0.9, skip_factor));
+			tile_coordinates = std::move(Misc::LevelReading::ReadLevelTiles(tiled_image, dimensions[0], dimensions[1], tile_size, number_of_levels - 1, skip_factor, 0.9f, input_file, m_thread_pool_));
+			log_level_timing(number_of_levels - 1, tile_coordinates.size());
 		}
 
 		return tile_coordinates;
@@ -1,15 +1,35 @@
 #ifndef __WSICS_NORMALIZATION_WSICSALGORITHM__
 #define __WSICS_NORMALIZATION_WSICSALGORITHM__
 
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
 #include <opencv2/core/core.hpp>
 #include <boost/filesystem.hpp>
 
 #include "PixelClassificationHE.h"
 #include "WSICS_Parameters.h"
 #include "TransformCxCyDensity.h"
+#include "../Misc/ThreadPool.h"
+#include "../Misc/TissueIndex.h"
 
 namespace WSICS::Normalization
 {
+	/// <summary>
+	/// Holds the time spent on a single stage of the normalization.
+	/// </summary>
+	struct StageTiming
+	{
+		std::string	stage;
+		double		seconds;
+	};
+
+	/// <summary>
+	/// Normalizes the stains of WSIs. Normalize may be called concurrently from multiple threads,
+	/// in which case the raw LUT model is shared between the calls.
+	/// </summary>
 	class WSICS_Algorithm
 	{
 		public:
@@ -17,25 +37,68 @@ namespace WSICS::Normalization
 			WSICS_Algorithm(std::string log_directory, const boost::filesystem::path& template_file, const WSICS_Parameters& parameters);
 
 			static WSICS_Parameters GetStandardParameters(void);
-			void Normalize(
+			/// <summary>
+			/// Estimates the peak amount of memory a single Normalize call claims beyond the shared raw LUT model, based on
+			/// the dimensions of the slide and the amount of tiles it's divided into.
+			/// </summary>
+			/// <param name="input_file">The WSI that will be normalized.</param>
+			/// <param name="parameters">The parameters the normalization will be performed with.</param>
+			/// <returns>The estimated amount of bytes.</returns>
+			static uint64_t EstimatePeakMemory(const boost::filesystem::path& input_file, const WSICS_Parameters& parameters);
+			/// <summary>
+			/// Normalizes a single WSI, writing the requested outputs.
+			/// </summary>
+			/// <param name="input_file">The WSI to normalize.</param>
+			/// <param name="image_output_file">The path for the normalized WSI, or empty if it shouldn't be written.</param>
+			/// <param name="lut_output_file">The path for the LUT, or empty if it shouldn't be written.</param>
+			/// <param name="template_output_file">The path for the template parameters, or empty if they shouldn't be written.</param>
+			/// <param name="debug_directory">The directory for debug output.</param>
+			/// <returns>The time spent on each stage of the normalization.</returns>
+			std::vector<StageTiming> Normalize(
 				const boost::filesystem::path& input_file,
 				const boost::filesystem::path& image_output_file,
 				const boost::filesystem::path& lut_output_file,
 				const boost::filesystem::path& template_output_file,
 				const boost::filesystem::path& debug_directory);
 			void SetLogDirectory(std::string& log_directory);
+			/// <summary>
+			/// Returns the id of the log file this object writes towards.
+			/// </summary>
+			/// <returns>The id of the log file.</returns>
+			size_t GetLogFileId(void) const;
+			/// <summary>
+			/// Sets the pool over which the tissue detection is distributed. The pool may be shared with the callers of Normalize.
+			/// </summary>
+			/// <param name="thread_pool">The pool to use, or a nullptr to process serially.</param>
+			void SetThreadPool(Misc::ThreadPool* thread_pool);
 
 		private:
 			size_t							m_log_file_id_;
-			boost::filesystem::path			m_debug_directory_;
 			const boost::filesystem::path&	m_template_file_;
 
 			WSICS_Parameters				m_parameters_;
-			bool							m_is_multiresolution_image_;
+			Misc::ThreadPool*				m_thread_pool_;
+
+			std::mutex								m_lut_access_;
+			std::shared_ptr<const HSD::HSD_Model>	m_lut_hsd_;
 
+			/// <summary>
+			/// Returns the HSD model of the raw LUT, which is identical for every slide. Creates it on first access.
+			/// </summary>
+			/// <returns>A pointer towards the shared HSD model of the raw LUT.</returns>
+			std::shared_ptr<const HSD::HSD_Model>	AcquireLutHSD_(void);
 			cv::Mat									CalculateLutRawMat_(void);
-			std::pair<bool, std::vector<double>>	GetResolutionTypeAndSpacing(MultiResolutionImage& tiled_image);
-			std::vector<cv::Point>					GetTileCoordinates_(MultiResolutionImage& tiled_image, const std::vector<double>& spacing, const uint32_t tile_size, const uint32_t min_level);
+			std::pair<bool, std::vector<double>>	GetResolutionTypeAndSpacing(MultiResolutionImage& tiled_image, const std::string& log_prefix);
+			/// <summary>
+			/// Loads the persisted tissue index of the slide, or builds and persists it if it's absent or outdated.
+			/// </summary>
+			/// <param name="input_file">The path towards the slide.</param>
+			/// <param name="tiled_image">The opened slide.</param>
+			/// <param name="level">The level to index.</param>
+			/// <param name="log_prefix">The prefix that identifies the slide within the log.</param>
+			/// <returns>The tissue index of the slide.</returns>
+			Misc::TissueIndex						AcquireTissueIndex_(const boost::filesystem::path& input_file, MultiResolutionImage& tiled_image, const uint32_t level, const std::string& log_prefix);
+			std::vector<cv::Point>					GetTileCoordinates_(const boost::filesystem::path& input_file, MultiResolutionImage& tiled_image, const std::vector<double>& spacing, const uint32_t tile_size, const uint32_t min_level, const std::string& log_prefix);
 
 			TrainingSampleInformation CollectTrainingSamples_(
 				const boost::filesystem::path& input_file,
@@ -44,7 +107,10 @@ namespace WSICS::Normalization
 				cv::Mat static_image,
 				const std::vector<cv::Point>& tile_coordinates,
 				const std::vector<double>& spacing,
-				const uint32_t min_level);
+				const uint32_t min_level,
+				const boost::filesystem::path& debug_directory,
+				const bool is_multiresolution_image,
+				const std::string& log_prefix);
 	};
 }
 #endif // __WSICS_NORMALIZATION_WSICSALGORITHM__
\ No newline at end of file
@@ -3,6 +3,8 @@
 
 #include <cstdint>
 
+#include "../HE_Staining/INucleusDetector.h"
+
 namespace WSICS::Normalization
 {
 	/// <summary>
@@ -18,6 +20,12 @@ namespace WSICS::Normalization
 		float		eosin_percentile;
 		float		background_threshold;
 		bool		consider_ink;
+		uint32_t	convergence_trials;
+		HE_Staining::NucleusDetection	nucleus_detection;
+		uint32_t	detection_downsample;
+		bool		refine_detections;
+		uint32_t	knn_voxel_resolution;
+		bool		tile_triage;
 	};
 }
 #endif // __WSICS_NORMALIZATION_WSICSPARAMETERS__
\ No newline at end of file
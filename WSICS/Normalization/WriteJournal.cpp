@@ -0,0 +1,128 @@
+#include "WriteJournal.h"
+
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/property_tree/ptree.hpp>
+#include <opencv2/highgui.hpp>
+
+namespace WSICS::Normalization
+{
+	WriteJournal::WriteJournal(const boost::filesystem::path& output_file)
+		: m_output_file_(output_file),
+		m_journal_file_(output_file.string() + ".journal"),
+		m_lut_file_(output_file.parent_path() / (output_file.stem().string() + ".journal_lut.tif")),
+		m_spool_directory_(output_file.string() + ".rows"),
+		m_input_hash_(0),
+		m_tile_size_(0),
+		m_completed_rows_(0)
+	{
+	}
+
+	bool WriteJournal::Load(const uint64_t input_hash, const std::string& parameters, const uint32_t tile_size)
+	{
+		if (!boost::filesystem::is_regular_file(m_journal_file_) || !boost::filesystem::is_regular_file(m_lut_file_))
+		{
+			return false;
+		}
+
+		boost::property_tree::ptree root;
+		try
+		{
+			boost::property_tree::read_json(m_journal_file_.string(), root);
+		}
+		catch (const boost::property_tree::json_parser_error&)
+		{
+			return false;
+		}
+
+		if (root.get<uint64_t>("input_hash", 0) != input_hash || root.get<std::string>("parameters", "") != parameters || root.get<uint32_t>("tile_size", 0) != tile_size)
+		{
+			return false;
+		}
+
+		m_input_hash_		= input_hash;
+		m_parameters_		= parameters;
+		m_tile_size_		= tile_size;
+		m_completed_rows_	= root.get<uint64_t>("completed_rows", 0);
+		return true;
+	}
+
+	void WriteJournal::Start(const uint64_t input_hash, const std::string& parameters, const uint32_t tile_size, const cv::Mat& normalized_lut)
+	{
+		Remove();
+
+		m_input_hash_		= input_hash;
+		m_parameters_		= parameters;
+		m_tile_size_		= tile_size;
+		m_completed_rows_	= 0;
+
+		boost::filesystem::create_directories(m_spool_directory_);
+		if (!cv::imwrite(m_lut_file_.string(), normalized_lut))
+		{
+			throw std::runtime_error("Unable to persist the LUT to: " + m_lut_file_.string());
+		}
+		Save_();
+	}
+
+	void WriteJournal::SetCompletedRows(const uint64_t completed_rows)
+	{
+		m_completed_rows_ = completed_rows;
+		Save_();
+	}
+
+	void WriteJournal::Remove(void)
+	{
+		boost::system::error_code error;
+		boost::filesystem::remove(m_journal_file_, error);
+		boost::filesystem::remove(m_lut_file_, error);
+		boost::filesystem::remove_all(m_spool_directory_, error);
+	}
+
+	uint64_t WriteJournal::GetCompletedRows(void) const
+	{
+		return m_completed_rows_;
+	}
+
+	cv::Mat WriteJournal::LoadLUT(void) const
+	{
+		return cv::imread(m_lut_file_.string(), cv::IMREAD_UNCHANGED);
+	}
+
+	boost::filesystem::path WriteJournal::GetPartialFile(void) const
+	{
+		return m_output_file_.parent_path() / (m_output_file_.stem().string() + ".partial" + m_output_file_.extension().string());
+	}
+
+	boost::filesystem::path WriteJournal::GetRowFile(const uint64_t row) const
+	{
+		std::stringstream filename;
+		filename << "row_" << std::setw(6) << std::setfill('0') << row << ".png";
+		return m_spool_directory_ / filename.str();
+	}
+
+	void WriteJournal::Save_(void)
+	{
+		boost::property_tree::ptree root;
+		root.put("version", 1);
+		root.put("input_hash", m_input_hash_);
+		root.put("parameters", m_parameters_);
+		root.put("tile_size", m_tile_size_);
+		root.put("completed_rows", m_completed_rows_);
+
+		// Writes towards a temporary file first, so that an interruption never leaves a partial journal behind.
+		boost::filesystem::path temporary_file(m_journal_file_.string() + ".tmp");
+		{
+			std::ofstream stream(temporary_file.string(), std::ios::trunc);
+			boost::property_tree::write_json(stream, root);
+			stream.flush();
+			if (!stream)
+			{
+				throw std::runtime_error("Unable to write the journal to: " + temporary_file.string());
+			}
+		}
+		boost::filesystem::rename(temporary_file, m_journal_file_);
+	}
+}
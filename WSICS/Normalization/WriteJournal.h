@@ -0,0 +1,93 @@
+#ifndef __WSICS_NORMALIZATION_WRITEJOURNAL__
+#define __WSICS_NORMALIZATION_WRITEJOURNAL__
+
+#include <string>
+
+#include <boost/filesystem.hpp>
+#include <opencv2/core/core.hpp>
+
+namespace WSICS::Normalization
+{
+	/// <summary>
+	/// Tracks the progress of writing a normalized WSI, so that an interrupted write can be continued.
+	///
+	/// The image is written towards a partial file, which only replaces the output file once finished.
+	/// Each completed row of tiles is also stored within a spool directory, because the partial TIFF
+	/// can't be appended to. A restarted write feeds the spooled rows into a new partial file and then
+	/// continues with the first unfinished row. The LUT is persisted alongside, so that it doesn't
+	/// have to be recalculated.
+	/// </summary>
+	class WriteJournal
+	{
+		public:
+			/// <summary>
+			/// Constructs the journal for the output file, without reading or writing anything.
+			/// </summary>
+			/// <param name="output_file">The path towards the normalized WSI.</param>
+			WriteJournal(const boost::filesystem::path& output_file);
+
+			/// <summary>
+			/// Reads the journal from disk.
+			/// </summary>
+			/// <param name="input_hash">The hash of the input file, which has to match the journal.</param>
+			/// <param name="parameters">The parameter description, which has to match the journal.</param>
+			/// <param name="tile_size">The tile size, which has to match the journal.</param>
+			/// <returns>Whether or not the journal describes a write that can be continued.</returns>
+			bool Load(const uint64_t input_hash, const std::string& parameters, const uint32_t tile_size);
+			/// <summary>
+			/// Removes any previous progress and starts a new journal, persisting the LUT.
+			/// </summary>
+			/// <param name="input_hash">The hash of the input file.</param>
+			/// <param name="parameters">The parameter description.</param>
+			/// <param name="tile_size">The tile size the image is written with.</param>
+			/// <param name="normalized_lut">The LUT the image is normalized with.</param>
+			void Start(const uint64_t input_hash, const std::string& parameters, const uint32_t tile_size, const cv::Mat& normalized_lut);
+			/// <summary>
+			/// Marks every row before the passed row as completed, and writes the journal to disk.
+			/// </summary>
+			/// <param name="completed_rows">The amount of completed rows.</param>
+			void SetCompletedRows(const uint64_t completed_rows);
+			/// <summary>
+			/// Removes the journal, spooled rows and persisted LUT. Called once the output has been finalized.
+			/// </summary>
+			void Remove(void);
+
+			/// <summary>
+			/// Returns the amount of rows that have been completed.
+			/// </summary>
+			/// <returns>The amount of completed rows.</returns>
+			uint64_t GetCompletedRows(void) const;
+			/// <summary>
+			/// Reads the persisted LUT.
+			/// </summary>
+			/// <returns>The LUT, or an empty matrix if it's unavailable.</returns>
+			cv::Mat LoadLUT(void) const;
+			/// <summary>
+			/// Returns the path the image is written towards before it's finalized.
+			/// </summary>
+			/// <returns>The path towards the partial image.</returns>
+			boost::filesystem::path GetPartialFile(void) const;
+			/// <summary>
+			/// Returns the path towards the spooled copy of a row of tiles.
+			/// </summary>
+			/// <param name="row">The index of the row.</param>
+			/// <returns>The path towards the row file.</returns>
+			boost::filesystem::path GetRowFile(const uint64_t row) const;
+
+		private:
+			boost::filesystem::path	m_output_file_;
+			boost::filesystem::path	m_journal_file_;
+			boost::filesystem::path	m_lut_file_;
+			boost::filesystem::path	m_spool_directory_;
+			uint64_t				m_input_hash_;
+			std::string				m_parameters_;
+			uint32_t				m_tile_size_;
+			uint64_t				m_completed_rows_;
+
+			/// <summary>
+			/// Writes the journal towards a temporary file, which then replaces the journal file.
+			/// </summary>
+			void Save_(void);
+	};
+}
+#endif // __WSICS_NORMALIZATION_WRITEJOURNAL__